@@ -0,0 +1,3 @@
+-- news_sink_clickhouse tags every INSERT with insert_deduplication_token; a plain
+-- MergeTree only honours it with a non-zero dedup window.
+ALTER TABLE news_scored MODIFY SETTING non_replicated_deduplication_window = 1000;
@@ -0,0 +1,12 @@
+#!/usr/bin/env bash
+set -euo pipefail
+CH_HOST=${CH_HOST:-localhost}
+CH_PORT=${CH_PORT:-8123}
+
+# Switch news_scored ingest from the Kafka engine MV to news_sink_clickhouse
+echo "Switching ClickHouse ingest to news_sink_clickhouse at http://$CH_HOST:$CH_PORT ..."
+curl -sS "http://$CH_HOST:$CH_PORT" --data-binary "DROP VIEW IF EXISTS mv_news_scored"
+curl -sS "http://$CH_HOST:$CH_PORT" --data-binary "DROP TABLE IF EXISTS news_scored_kafka"
+curl -sS "http://$CH_HOST:$CH_PORT" --data-binary @infra/clickhouse/003_news_scored_dedup.sql
+echo
+echo "Done."
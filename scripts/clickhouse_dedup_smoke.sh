@@ -0,0 +1,71 @@
+#!/usr/bin/env bash
+set -euo pipefail
+# Smoke test for news_sink_clickhouse retries against the docker-compose ClickHouse:
+# a block inserted twice with the same insert_deduplication_token must land once.
+# Runs on a scratch copy of news_scored with infra/clickhouse/003_news_scored_dedup.sql
+# applied, so the real table is untouched. The JSONEachRow part checks the server
+# setup; news_clickhouse_check (CHECK_BIN, built by scripts/cpp_build.sh) then sends
+# RowBinary blocks through ClickHouseWriter itself and compares what reads back.
+CH_HOST=${CH_HOST:-localhost}
+CH_PORT=${CH_PORT:-8123}
+CH="http://$CH_HOST:$CH_PORT"
+TABLE=news_scored_dedup_smoke
+CHECK_BIN=${CHECK_BIN:-build/news_clickhouse_check}
+
+docker compose -f infra/docker-compose.yml up -d clickhouse
+
+for _ in $(seq 1 60); do
+  curl -sf "$CH/ping" > /dev/null && break
+  sleep 1
+done
+curl -sf "$CH/ping" > /dev/null || { echo "ClickHouse not reachable at $CH"; exit 1; }
+
+q() { curl -sS --fail-with-body "$CH" --data-binary "$1"; }
+trap 'q "DROP TABLE IF EXISTS $TABLE" > /dev/null || true' EXIT
+
+scratch_table() {
+  q "DROP TABLE IF EXISTS $TABLE"
+  q "CREATE TABLE $TABLE AS news_scored"
+  sed "s/news_scored/$TABLE/" infra/clickhouse/003_news_scored_dedup.sql | curl -sS --fail-with-body "$CH" --data-binary @-
+}
+scratch_table
+
+# Same column list as ClickHouseWriter; JSONEachRow instead of RowBinary keeps this readable
+# (the query goes first in the body, the token in the URL as the writer sends it)
+insert() {
+  local token
+  token=$(python3 -c 'import sys, urllib.parse; print(urllib.parse.quote(sys.argv[1], safe=""))' "$1")
+  { echo "INSERT INTO $TABLE (ts, id, source, url, title, tickers, sentiment, topics) FORMAT JSONEachRow"
+    cat <<'EOF'
+{"ts":"2024-05-01 12:00:00.000","id":"smoke-1","source":"smoke","url":"https://example.com/1","title":"one","tickers":["AAPL"],"sentiment":0.5,"topics":["earnings"]}
+{"ts":"2024-05-01 12:00:01.000","id":"smoke-2","source":"smoke","url":"https://example.com/2","title":"two","tickers":["MSFT"],"sentiment":-0.2,"topics":[]}
+{"ts":"2024-05-01 12:00:02.000","id":"smoke-3","source":"smoke","url":"https://example.com/3","title":"three","tickers":[],"sentiment":0,"topics":["macro"]}
+EOF
+  } | curl -sS --fail-with-body "$CH/?insert_deduplication_token=$token" --data-binary @-
+}
+
+count() { q "SELECT count() FROM $TABLE" | tr -d '[:space:]'; }
+
+fail=0
+check() {
+  local want=$1 what=$2 got
+  got=$(count)
+  if [ "$got" = "$want" ]; then echo "ok   $what: $got rows"; else echo "FAIL $what: $got rows, want $want"; fail=1; fi
+}
+
+insert "news.scored:p0=100-102"
+check 3 "first insert"
+insert "news.scored:p0=100-102"
+check 3 "retry with the same token"
+insert "news.scored:p0=103-105"
+check 6 "same rows under a new token"
+
+if [ -x "$CHECK_BIN" ]; then
+  scratch_table
+  "$CHECK_BIN" --url "$CH" --table "$TABLE" || fail=1
+else
+  echo "FAIL $CHECK_BIN not built (scripts/cpp_build.sh): ClickHouseWriter not checked"
+  fail=1
+fi
+
+exit $fail
@@ -0,0 +1,32 @@
+#!/usr/bin/env bash
+set -euo pipefail
+# Offline load test of the C++ ingest path:
+#   news_loadgen (synthetic feeds/pages) -> news_gw -> news.raw -> news_clean -> news.clean
+# Needs a C++ build (scripts/cpp_build.sh) and docker for Redpanda + Redis.
+BUILD=${BUILD:-build}
+DURATION=${DURATION:-120}
+LOADGEN_CFG=${LOADGEN_CFG:-config/loadgen.yml}
+WORK=$(mktemp -d)
+
+docker compose -f infra/docker-compose.yml up -d kafka redis
+
+# news_gw/news_clean talk to the host-mapped ports and only poll the simulator
+sed -e 's#bootstrap_servers: .*#bootstrap_servers: "localhost:9092"#' \
+    -e 's#enable_rss: true#enable_rss: false#' \
+    -e 's#enable_html: true#enable_html: false#' \
+    -e 's#require_html_content_type: true#require_html_content_type: false#' \
+    config/app.yml > "$WORK/app.yml"
+
+pids=()
+cleanup() { kill "${pids[@]}" 2>/dev/null || true; wait 2>/dev/null || true; echo "Logs in $WORK"; }
+trap cleanup EXIT
+
+"$BUILD/news_loadgen" "$LOADGEN_CFG" --rss-out "$WORK/rss.yml" > "$WORK/loadgen.log" 2>&1 & pids+=($!)
+sleep 1
+"$BUILD/news_clean" "$WORK/app.yml" > "$WORK/clean.log" 2>&1 & pids+=($!)
+"$BUILD/news_gw" "$WORK/app.yml" "$WORK/rss.yml" > "$WORK/gw.log" 2>&1 & pids+=($!)
+
+echo "Running for ${DURATION}s ..."
+sleep "$DURATION"
+grep "\[news_loadgen\]" "$WORK/loadgen.log" | tail -n 6
+grep "cycle:" "$WORK/gw.log" | tail -n 3 || true
@@ -1,4 +1,5 @@
 #pragma once
+#include <atomic>
 #include <string>
 #include <vector>
 #include <optional>
@@ -9,18 +10,85 @@ struct CleanResult {
   std::string body;
   std::string language;        // "en" or "unknown"
   std::vector<std::string> hints; // cashtags, host/path tokens
+  bool fast_path = false;         // true if the DOM budget was exceeded and the scanner was used
+  bool structured = false;        // body came from JSON-LD articleBody; no DOM was used
+  bool templated = false;         // body came from the host's learned selector
+  int64_t published_ts_ms = 0;    // JSON-LD datePublished / article:published_time (0 = unknown)
 };
 
 struct HtmlFetchOptions {
   std::string user_agent = "FinNewsBot/1.0";
   int timeout_secs = 10;
+  size_t max_body_bytes = 4 * 1024 * 1024; // abort the transfer beyond this (0 = unlimited)
+  bool require_html = true;                // abort early on a non-HTML Content-Type
+  size_t stop_after_article_chars = 0;     // streaming: stop once an <article> with this much text closed (0 = off)
 };
 
-// Fetches HTML and returns the raw string (std::nullopt on failure)
-std::optional<std::string> fetch_html(const std::string& url, const HtmlFetchOptions& opt);
+// Why a fetch produced no HTML
+enum class FetchAbort { None, Network, HttpStatus, TooLarge, NotHtml };
 
-// Extracts a main title/body from HTML using heuristics (no network)
-CleanResult clean_html_to_text(const std::string& url, const std::string& html);
+class TemplateStore;
+
+// Work budget for DOM parsing/extraction; pages over budget use the fast scanner
+struct CleanBudget {
+  size_t max_dom_bytes = 1536 * 1024;
+  size_t max_dom_nodes = 30000;
+  size_t min_structured_body_chars = 200;  // JSON-LD articleBody this long skips the DOM (0 = no pre-pass)
+  TemplateStore* templates = nullptr;      // learned per-host selectors (optional, not owned)
+};
+
+// Process-wide counters, one per abort/fallback reason
+struct CleanCounters {
+  std::atomic<uint64_t> abort_network{0};
+  std::atomic<uint64_t> abort_http_status{0};
+  std::atomic<uint64_t> abort_too_large{0};
+  std::atomic<uint64_t> abort_not_html{0};
+  std::atomic<uint64_t> fallback_dom_bytes{0};
+  std::atomic<uint64_t> fallback_dom_nodes{0};
+  std::atomic<uint64_t> structured_hits{0};   // pages served from JSON-LD
+  std::atomic<uint64_t> template_hits{0};     // pages served by a learned host selector
+  std::atomic<uint64_t> template_misses{0};   // learned selector failed validation
+};
+CleanCounters& clean_counters();
+
+// Fetches HTML and returns the raw string (std::nullopt on failure; reason in *abort if given)
+std::optional<std::string> fetch_html(const std::string& url, const HtmlFetchOptions& opt,
+                                      FetchAbort* abort = nullptr);
+
+// Extracts a main title/body from HTML (no network). JSON-LD/OpenGraph metadata is
+// tried first (see structured_data.h); the density heuristic runs only without it.
+CleanResult clean_html_to_text(const std::string& url, const std::string& html,
+                               const CleanBudget& budget = CleanBudget{});
+
+// Incremental HTML parser fed while the page downloads (libxml2 push parser).
+// feed() returns false once the main body has been seen, so the transfer can stop;
+// with structured_min_chars > 0 that includes a JSON-LD articleBody of that length.
+class HtmlPushParser {
+ public:
+  explicit HtmlPushParser(size_t stop_after_article_chars = 0, size_t structured_min_chars = 0);
+  ~HtmlPushParser();
+  HtmlPushParser(const HtmlPushParser&) = delete;
+  HtmlPushParser& operator=(const HtmlPushParser&) = delete;
+
+  bool feed(const char* data, size_t len);
+  CleanResult finish(const std::string& url, const CleanBudget& budget);
+
+ private:
+  struct Impl; Impl* impl_;
+};
+
+// Streaming fetch only: the page is pushed into `parser` as it downloads; extraction
+// (parser.finish()) is left to the caller, possibly on another thread.
+bool fetch_into(const std::string& url, const HtmlFetchOptions& opt, HtmlPushParser& parser,
+                FetchAbort* abort = nullptr);
+
+// Streaming fetch + clean: parsing overlaps the transfer and the body is never buffered
+// as one string. max_dom_bytes does not apply; max_dom_nodes falls back to <p> text.
+std::optional<CleanResult> fetch_and_clean(const std::string& url, const HtmlFetchOptions& opt,
+                                           const CleanBudget& budget, FetchAbort* abort = nullptr);
+
+// Linear tag scanner: <title> + text of <p> blocks, no DOM. Used when over budget.
+CleanResult fast_extract_text(const std::string& url, const std::string& html);
 
 // Heuristic English detector: returns "en" if the body is mostly ASCII alphabetic/space/punct
 std::string detect_language_en_heuristic(const std::string& text);
@@ -2,12 +2,21 @@
 #include <string>
 #include <functional>
 #include <cstddef>
+#include <cstdint>
 
 struct KafkaConsumerCfg {
   std::string bootstrap_servers = "localhost:9092";
   std::string group_id = "news-cleaner";
   std::string topic = "news.raw";
   std::string auto_offset_reset = "latest"; // or "earliest"
+  bool enable_auto_commit = true;           // false: caller commits via commit()
+};
+
+// Where a polled message came from (for manual offset commits)
+struct KafkaMessageMeta {
+  std::string topic;
+  int32_t partition = -1;
+  int64_t offset = -1;
 };
 
 class KafkaConsumer {
@@ -15,7 +24,15 @@ class KafkaConsumer {
   explicit KafkaConsumer(const KafkaConsumerCfg& cfg);
   ~KafkaConsumer();
   // Poll one message: returns (ok, key, payload, len). If no message, ok=false.
+  // payload stays valid until the next poll() on this consumer.
   bool poll(std::string& key_out, const void*& payload_out, size_t& len_out, int timeout_ms = 100);
+  bool poll(std::string& key_out, const void*& payload_out, size_t& len_out, KafkaMessageMeta& meta,
+            int timeout_ms = 100);
+  // Synchronously commits `next_offset` (last processed offset + 1) for one partition.
+  bool commit(const std::string& topic, int32_t partition, int64_t next_offset);
+  // Pauses (or resumes) fetching on every currently assigned partition. Keep calling
+  // poll() while paused: that is what keeps the consumer in its group.
+  void set_paused(bool paused);
  private:
   struct Impl; Impl* impl_;
 };
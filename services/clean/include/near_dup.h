@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct NearDupConfig {
+  bool enable = true;
+  int max_hamming = 3;            // bits; index uses max_hamming+1 bands
+  int shingle_words = 3;
+  int window_secs = 6 * 3600;     // sliding window of remembered articles
+  size_t max_entries = 200000;    // hard cap on remembered articles
+};
+
+// 64-bit SimHash over lowercase word shingles of `text` (no per-token allocation)
+uint64_t simhash64(const std::string& text, int shingle_words = 3);
+
+// Banded LSH over SimHash values. With B = max_hamming+1 bands, any two hashes within
+// max_hamming bits agree exactly on at least one band (pigeonhole), so a lookup only
+// has to verify the few entries sharing a band bucket.
+class NearDupIndex {
+ public:
+  explicit NearDupIndex(const NearDupConfig& cfg);
+
+  // Looks `hash` up, then remembers it under the resulting cluster.
+  // Returns the cluster id of the nearest earlier article within max_hamming,
+  // or `id` itself if this is the first of its kind (is_dup=false).
+  std::string observe(const std::string& id, uint64_t hash, int64_t now_ms, bool& is_dup);
+
+  size_t size() const { return entries_.size(); }
+
+ private:
+  struct Entry {
+    uint64_t hash;
+    int64_t ts_ms;
+    std::string cluster_id;
+  };
+
+  uint64_t band_key(int band, uint64_t hash) const;
+  void evict(int64_t now_ms);
+
+  NearDupConfig cfg_;
+  int bands_;
+  int band_bits_;
+  std::deque<Entry> entries_;      // ordered by insertion time
+  uint64_t base_seq_ = 0;          // sequence number of entries_.front()
+  std::unordered_map<uint64_t, std::deque<uint64_t>> buckets_; // band key -> entry seqs (oldest first)
+};
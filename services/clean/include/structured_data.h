@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Article metadata publishers embed for search engines
+struct StructuredArticle {
+  std::string type;              // schema.org @type, e.g. "NewsArticle"
+  std::string headline;          // JSON-LD headline, else og:title
+  std::string body;              // JSON-LD articleBody (markup stripped)
+  int64_t published_ts_ms = 0;   // datePublished, else article:published_time
+};
+
+// Byte-level pre-pass over raw HTML, fed chunk by chunk: finds
+// <script type="application/ld+json"> blocks and OpenGraph <meta> tags without
+// building a DOM. Each JSON-LD block is parsed with nlohmann's SAX reader when its
+// </script> arrives; the article-typed object (also inside @graph) with the longest
+// articleBody wins. Other scripts and styles are skipped unparsed.
+class StructuredDataScanner {
+public:
+  StructuredDataScanner();
+  ~StructuredDataScanner();
+  StructuredDataScanner(const StructuredDataScanner&) = delete;
+  StructuredDataScanner& operator=(const StructuredDataScanner&) = delete;
+
+  void feed(const char* data, size_t len);
+  // True once an articleBody of at least min_chars has been seen
+  bool has_body(size_t min_chars) const;
+  const StructuredArticle& article() const;
+
+private:
+  struct Impl;
+  Impl* impl_;
+};
+
+// ISO 8601 ("2024-05-01T13:45:00Z", "+02:00" offsets, fractions, date-only) -> epoch ms; 0 if unparsable
+int64_t parse_iso8601_ms(const std::string& s);
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+struct TemplateStoreConfig {
+  bool enable = true;
+  std::string path = "data/clean_templates.json";  // learned selectors survive restarts ("" = memory only)
+  int learn_after = 5;          // consecutive pages picking the same container before it is trusted
+  size_t min_body_chars = 200;  // a targeted extraction shorter than this fails validation
+  int max_failures = 3;         // consecutive validation failures before a host relearns
+  int save_secs = 60;
+};
+
+struct HostTemplateStats {
+  std::string host;
+  std::string selector;         // learned or candidate path
+  bool active = false;          // false while still learning
+  uint64_t hits = 0;            // pages served by the selector
+  uint64_t misses = 0;          // selector failed validation, full heuristic used
+  uint64_t learned = 0;         // pages that ran the full heuristic
+};
+
+// Per-host content selectors learned from the density heuristic. A selector is a
+// tag/class path from <html> to the chosen container ("body>div.page>article.story").
+// Once the heuristic has picked the same path on learn_after consecutive pages of a
+// host, later pages from that host go straight to the path; the heuristic runs again
+// only when the targeted node is missing or too short. Thread-safe.
+class TemplateStore {
+public:
+  explicit TemplateStore(const TemplateStoreConfig& cfg);
+  ~TemplateStore();
+  TemplateStore(const TemplateStore&) = delete;
+  TemplateStore& operator=(const TemplateStore&) = delete;
+
+  const TemplateStoreConfig& config() const;
+
+  // Active selector for `host`, if one has been learned
+  std::optional<std::string> lookup(const std::string& host) const;
+  // The full heuristic picked `selector` on a page from `host`
+  void observe(const std::string& host, const std::string& selector);
+  void record_hit(const std::string& host);
+  void record_miss(const std::string& host);
+
+  // Writes active selectors (and their counters) when save_secs have passed since the
+  // last write and something changed; save() writes unconditionally. Atomic rename.
+  void save_if_due();
+  bool save();
+
+  // Hosts ordered by page count (hits + learned), most first
+  std::vector<HostTemplateStats> stats() const;
+
+private:
+  struct Impl;
+  Impl* impl_;
+};
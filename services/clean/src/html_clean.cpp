@@ -1,34 +1,109 @@
 #include "html_clean.h"
+#include "structured_data.h"
+#include "template_store.h"
 #include <curl/curl.h>
 #include <libxml/HTMLparser.h>
 #include <libxml/HTMLtree.h>
+#include <libxml/SAX2.h>
 #include <libxml/parser.h>
 #include <libxml/tree.h>
 #include <algorithm>
 #include <cctype>
+#include <cstring>
+#include <functional>
 #include <regex>
 #include <set>
+#include <unordered_map>
 #include <sstream>
 #include <string>
 #include <vector>
 
+CleanCounters& clean_counters() {
+  static CleanCounters counters;
+  return counters;
+}
+
+// Write target with a hard size cap and a Content-Type gate checked on the first chunk.
+struct FetchSink {
+  CURL* curl = nullptr;
+  std::string body;
+  size_t max_bytes = 0;
+  bool require_html = true;
+  bool checked_type = false;
+  FetchAbort abort = FetchAbort::None;
+  HtmlPushParser* push = nullptr;  // streaming mode: chunks go to the parser, not `body`
+  size_t received = 0;
+  bool stopped_early = false;
+};
+
+static bool is_html_content_type(const char* ct) {
+  if (!ct || !*ct) return true; // unknown: let the parser decide
+  std::string low(ct);
+  std::transform(low.begin(), low.end(), low.begin(), [](unsigned char c){ return std::tolower(c); });
+  return low.find("html") != std::string::npos || low.find("xml") != std::string::npos;
+}
+
 static size_t write_cb(char* ptr, size_t size, size_t nmemb, void* userdata) {
-  auto* body = reinterpret_cast<std::string*>(userdata);
+  auto* sink = reinterpret_cast<FetchSink*>(userdata);
   size_t total = size * nmemb;
-  body->append(ptr, total);
+  if (!sink->checked_type) {
+    sink->checked_type = true;
+    char* ct = nullptr;
+    curl_easy_getinfo(sink->curl, CURLINFO_CONTENT_TYPE, &ct);
+    if (sink->require_html && !is_html_content_type(ct)) {
+      sink->abort = FetchAbort::NotHtml;
+      return 0; // CURLE_WRITE_ERROR
+    }
+  }
+  if (sink->max_bytes > 0 && sink->received + total > sink->max_bytes) {
+    sink->abort = FetchAbort::TooLarge;
+    return 0;
+  }
+  sink->received += total;
+  if (sink->push) {
+    if (!sink->push->feed(ptr, total)) {
+      sink->stopped_early = true;   // main body already parsed: save the rest of the transfer
+      return 0;
+    }
+    return total;
+  }
+  sink->body.append(ptr, total);
   return total;
 }
 
-std::optional<std::string> fetch_html(const std::string& url, const HtmlFetchOptions& opt) {
+static std::optional<std::string> fetch_html_impl(const std::string& url, const HtmlFetchOptions& opt,
+                                                  FetchAbort* abort, HtmlPushParser* push) {
+  auto fail = [&](FetchAbort why) -> std::optional<std::string> {
+    auto& c = clean_counters();
+    switch (why) {
+      case FetchAbort::Network:    c.abort_network++; break;
+      case FetchAbort::HttpStatus: c.abort_http_status++; break;
+      case FetchAbort::TooLarge:   c.abort_too_large++; break;
+      case FetchAbort::NotHtml:    c.abort_not_html++; break;
+      case FetchAbort::None: break;
+    }
+    if (abort) *abort = why;
+    return std::nullopt;
+  };
+  if (abort) *abort = FetchAbort::None;
+
   CURL* curl = curl_easy_init();
-  if (!curl) return std::nullopt;
+  if (!curl) return fail(FetchAbort::Network);
 
-  std::string body;
+  FetchSink sink;
+  sink.curl = curl;
+  sink.max_bytes = opt.max_body_bytes;
+  sink.require_html = opt.require_html;
+  sink.push = push;
   char errbuf[CURL_ERROR_SIZE]; errbuf[0] = 0;
 
   curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
   curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_cb);
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &body);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &sink);
+  if (opt.max_body_bytes > 0) {
+    // rejects up front when Content-Length is advertised; write_cb covers chunked bodies
+    curl_easy_setopt(curl, CURLOPT_MAXFILESIZE_LARGE, (curl_off_t)opt.max_body_bytes);
+  }
   curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
   curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 5L);
   curl_easy_setopt(curl, CURLOPT_TIMEOUT, opt.timeout_secs);
@@ -37,15 +112,23 @@ std::optional<std::string> fetch_html(const std::string& url, const HtmlFetchOpt
   curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
 
   CURLcode res = curl_easy_perform(curl);
+  if (res == CURLE_WRITE_ERROR && sink.stopped_early) res = CURLE_OK;
   if (res != CURLE_OK) {
     curl_easy_cleanup(curl);
-    return std::nullopt;
+    if (sink.abort != FetchAbort::None) return fail(sink.abort);
+    if (res == CURLE_FILESIZE_EXCEEDED) return fail(FetchAbort::TooLarge);
+    return fail(FetchAbort::Network);
   }
   long status = 0; curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
   curl_easy_cleanup(curl);
 
-  if (status < 200 || status >= 300) return std::nullopt;
-  return body;
+  if (status < 200 || status >= 300) return fail(FetchAbort::HttpStatus);
+  return std::move(sink.body);
+}
+
+std::optional<std::string> fetch_html(const std::string& url, const HtmlFetchOptions& opt,
+                                      FetchAbort* abort) {
+  return fetch_html_impl(url, opt, abort, nullptr);
 }
 
 static std::string node_text(xmlNode* node) {
@@ -56,6 +139,8 @@ static std::string node_text(xmlNode* node) {
   return s;
 }
 
+static std::string host_from_url(const std::string& url);
+
 static void remove_nodes_by_name(xmlNode* root, const char* name) {
   for (xmlNode* cur = root; cur;) {
     xmlNode* next = cur->next;
@@ -92,43 +177,120 @@ static size_t text_len(xmlNode* node) {
   return total;
 }
 
+// Text totals of an element's subtree; `link` is the part inside <a>
+struct TextCounts {
+  size_t text = 0;
+  size_t link = 0;
+  double link_density() const { return text ? (double)link / (double)text : 0.0; }
+  size_t content() const { return text - link; }
+};
+
+static bool is_named(xmlNode* n, const char* name) {
+  return n->type == XML_ELEMENT_NODE && !xmlStrcasecmp(n->name, BAD_CAST name);
+}
+
+// One bottom-up pass filling `out` for every element under `n`
+static TextCounts count_text(xmlNode* n, bool in_link, std::unordered_map<xmlNode*, TextCounts>& out) {
+  TextCounts c;
+  if (n->type == XML_TEXT_NODE && n->content) {
+    c.text = std::strlen((char*)n->content);
+    if (in_link) c.link = c.text;
+    return c;
+  }
+  if (n->type != XML_ELEMENT_NODE) return c;
+  const bool link = in_link || is_named(n, "a");
+  for (xmlNode* k = n->children; k; k = k->next) {
+    TextCounts kc = count_text(k, link, out);
+    c.text += kc.text;
+    c.link += kc.link;
+  }
+  out[n] = c;
+  return c;
+}
+
+static size_t count_commas(xmlNode* n) {
+  size_t commas = 0;
+  for (xmlNode* k = n->children; k; k = k->next) {
+    if (k->type == XML_TEXT_NODE && k->content) {
+      for (const xmlChar* p = k->content; *p; ++p) commas += *p == ',';
+    } else if (k->type == XML_ELEMENT_NODE) {
+      commas += count_commas(k);
+    }
+  }
+  return commas;
+}
+
 static xmlNode* find_main_content(xmlNode* root) {
-  // Prefer <article>, then the <div>/<section>/<main> with max text length,
-  // skipping nav/header/footer/aside
-  std::vector<xmlNode*> candidates;
+  // Candidates are <article>/<main>/<section>/<div> outside nav/header/footer/aside.
+  // An ancestor always holds at least its descendants' text, so raw length would
+  // always pick the outermost wrapper (nav, related links and comments included).
+  // Instead: a mostly-prose <article> wins; otherwise paragraphs vote for the
+  // container that holds them (Readability style) and link-heavy ones are damped.
+  constexpr double kMaxLinkDensity = 0.5;
+  constexpr size_t kMinArticleChars = 200;   // non-link text; smaller <article>s are teasers
+  constexpr size_t kMinParagraphChars = 25;
+
+  std::unordered_map<xmlNode*, TextCounts> counts;
+  count_text(root, false, counts);
+
+  std::vector<xmlNode*> candidates, paragraphs;
   std::function<void(xmlNode*)> walk = [&](xmlNode* n) {
-    if (!n) return;
-    if (n->type == XML_ELEMENT_NODE) {
-      if (!xmlStrcasecmp(n->name, BAD_CAST "article")) {
-        candidates.push_back(n);
-      } else if (!xmlStrcasecmp(n->name, BAD_CAST "div") ||
-                 !xmlStrcasecmp(n->name, BAD_CAST "section") ||
-                 !xmlStrcasecmp(n->name, BAD_CAST "main")) {
-        // skip structural wrappers
-        candidates.push_back(n);
-      }
-      for (xmlNode* c = n->children; c; c = c->next) walk(c);
+    if (n->type != XML_ELEMENT_NODE) return;
+    if (is_named(n, "nav") || is_named(n, "header") || is_named(n, "footer") || is_named(n, "aside")) return;
+    if (is_named(n, "article") || is_named(n, "main") || is_named(n, "section") || is_named(n, "div")) {
+      candidates.push_back(n);
+    } else if (is_named(n, "p") || is_named(n, "pre")) {
+      paragraphs.push_back(n);
     }
+    for (xmlNode* c = n->children; c; c = c->next) walk(c);
   };
-  walk(root);
-
-  // filter out nodes inside nav/header/footer/aside
-  auto is_bad_ancestor = [](xmlNode* n) {
-    for (xmlNode* p = n->parent; p; p = p->parent) {
-      if (p->type == XML_ELEMENT_NODE &&
-          (!xmlStrcasecmp(p->name, BAD_CAST "nav") ||
-           !xmlStrcasecmp(p->name, BAD_CAST "header") ||
-           !xmlStrcasecmp(p->name, BAD_CAST "footer") ||
-           !xmlStrcasecmp(p->name, BAD_CAST "aside"))) return true;
-    }
-    return false;
+  for (xmlNode* n = root; n; n = n->next) walk(n);
+
+  // 1. Prefer <article>: the one with the most non-link text, if it is mostly prose
+  xmlNode* best = nullptr;
+  size_t best_content = 0;
+  for (xmlNode* n : candidates) {
+    if (!is_named(n, "article")) continue;
+    const TextCounts& c = counts[n];
+    if (c.link_density() > kMaxLinkDensity || c.content() < kMinArticleChars) continue;
+    if (c.content() > best_content) { best = n; best_content = c.content(); }
+  }
+  if (best) return best;
+
+  // 2. Paragraph votes: full score to the nearest candidate, half to the next one up
+  std::unordered_map<xmlNode*, double> votes;
+  auto is_candidate = [](xmlNode* n) {
+    return is_named(n, "main") || is_named(n, "section") || is_named(n, "div") || is_named(n, "article");
   };
+  for (xmlNode* p : paragraphs) {
+    const size_t len = counts[p].text;
+    if (len < kMinParagraphChars) continue;
+    const double score = 1.0 + (double)count_commas(p) + std::min(3.0, (double)len / 100.0);
+    double share = 1.0;
+    for (xmlNode* a = p->parent; a && share > 0.25; a = a->parent) {
+      if (!is_candidate(a)) continue;
+      votes[a] += score * share;
+      share /= 2;
+    }
+  }
+  double best_score = 0;
+  for (const auto& [n, v] : votes) {
+    const double s = v * (1.0 - counts[n].link_density());
+    if (s > best_score) { best_score = s; best = n; }
+  }
+  if (best) return best;
 
-  xmlNode* best = nullptr; size_t best_score = 0;
-  for (auto* n : candidates) {
-    if (is_bad_ancestor(n)) continue;
-    size_t score = text_len(n);
-    if (score > best_score) { best_score = score; best = n; }
+  // 3. No paragraphs (text in bare divs): the deepest candidate that still holds
+  // most of the largest non-link text, skipping link lists
+  size_t most = 0;
+  for (xmlNode* n : candidates) most = std::max(most, counts[n].content());
+  size_t best_depth = 0;
+  for (xmlNode* n : candidates) {
+    const TextCounts& c = counts[n];
+    if (c.content() == 0 || c.content() * 10 < most * 8 || c.link_density() > kMaxLinkDensity) continue;
+    size_t depth = 0;
+    for (xmlNode* a = n->parent; a; a = a->parent) ++depth;
+    if (!best || depth > best_depth) { best = n; best_depth = depth; }
   }
   return best;
 }
@@ -207,26 +369,189 @@ static std::string collect_text(xmlNode* n) {
   return trim(oss.str());
 }
 
-CleanResult clean_html_to_text(const std::string& url, const std::string& html) {
-  CleanResult out;
+// Counts element nodes, stopping as soon as `limit` is exceeded
+static size_t count_elements(xmlNode* root, size_t limit) {
+  size_t n = 0;
+  std::vector<xmlNode*> stack{root};
+  while (!stack.empty() && n <= limit) {
+    xmlNode* x = stack.back(); stack.pop_back();
+    if (x->type != XML_ELEMENT_NODE) continue;
+    ++n;
+    for (xmlNode* c = x->children; c; c = c->next) stack.push_back(c);
+  }
+  return n;
+}
 
-  htmlDocPtr doc = htmlReadMemory(html.c_str(), (int)html.size(), "noname.html", nullptr,
-                                  HTML_PARSE_NOERROR | HTML_PARSE_NOWARNING | HTML_PARSE_NONET);
+// Text of <p> elements only: a linear walk used when the DOM is too large for
+// the density heuristic and the raw bytes are not available (streaming mode).
+static std::string collect_paragraphs(xmlNode* root) {
+  std::string out;
+  std::vector<xmlNode*> stack{root};
+  while (!stack.empty()) {
+    xmlNode* x = stack.back(); stack.pop_back();
+    if (x->type != XML_ELEMENT_NODE) continue;
+    if (!xmlStrcasecmp(x->name, BAD_CAST "p")) {
+      std::string t = trim(node_text(x));
+      if (!t.empty()) { if (!out.empty()) out.push_back('\n'); out += t; }
+      continue;
+    }
+    // push in reverse so siblings pop in document order
+    std::vector<xmlNode*> kids;
+    for (xmlNode* c = x->children; c; c = c->next) kids.push_back(c);
+    stack.insert(stack.end(), kids.rbegin(), kids.rend());
+  }
+  return out;
+}
+
+// ---------------- learned host selectors ----------------
+
+// Class tokens that look stable across pages (no digits: drops hashed/generated names)
+static std::vector<std::string> stable_classes(xmlNode* n) {
+  std::vector<std::string> out;
+  xmlChar* cls = xmlGetProp(n, BAD_CAST "class");
+  if (!cls) return out;
+  std::istringstream iss(reinterpret_cast<char*>(cls));
+  std::string tok;
+  while (iss >> tok && out.size() < 3) {
+    if (std::none_of(tok.begin(), tok.end(), [](unsigned char c){ return std::isdigit(c); })) {
+      out.push_back(tok);
+    }
+  }
+  xmlFree(cls);
+  return out;
+}
+
+// "body>div.page>article.story.main" from <html> down to `n`
+static std::string node_path(xmlNode* n) {
+  std::vector<std::string> steps;
+  for (xmlNode* x = n; x && x->type == XML_ELEMENT_NODE; x = x->parent) {
+    if (!xmlStrcasecmp(x->name, BAD_CAST "html")) break;
+    std::string step = reinterpret_cast<const char*>(x->name);
+    std::transform(step.begin(), step.end(), step.begin(), [](unsigned char c){ return std::tolower(c); });
+    for (auto& c : stable_classes(x)) step += "." + c;
+    steps.push_back(std::move(step));
+  }
+  std::string path;
+  for (auto it = steps.rbegin(); it != steps.rend(); ++it) {
+    if (!path.empty()) path += ">";
+    path += *it;
+  }
+  return path;
+}
+
+struct PathStep {
+  std::string tag;
+  std::vector<std::string> classes;
+};
+
+static bool step_matches(xmlNode* n, const PathStep& st) {
+  if (n->type != XML_ELEMENT_NODE || xmlStrcasecmp(n->name, BAD_CAST st.tag.c_str())) return false;
+  if (st.classes.empty()) return true;
+  const auto have = stable_classes(n);
+  for (const auto& c : st.classes) {
+    if (std::find(have.begin(), have.end(), c) == have.end()) return false;
+  }
+  return true;
+}
+
+// Follows a node_path() selector; with several matches the one with the most text wins
+static xmlNode* select_path(xmlNode* root, const std::string& path) {
+  std::vector<PathStep> steps;
+  std::istringstream iss(path);
+  std::string part;
+  while (std::getline(iss, part, '>')) {
+    PathStep st;
+    size_t dot = part.find('.');
+    st.tag = part.substr(0, dot);
+    while (dot != std::string::npos) {
+      size_t next = part.find('.', dot + 1);
+      st.classes.push_back(part.substr(dot + 1, next == std::string::npos ? std::string::npos : next - dot - 1));
+      dot = next;
+    }
+    steps.push_back(std::move(st));
+  }
+  if (steps.empty()) return nullptr;
+
+  xmlNode* html = root;
+  while (html && !(html->type == XML_ELEMENT_NODE && !xmlStrcasecmp(html->name, BAD_CAST "html"))) html = html->next;
+  if (!html) return nullptr;
+
+  std::vector<xmlNode*> level{html};
+  for (const auto& st : steps) {
+    std::vector<xmlNode*> next;
+    for (xmlNode* p : level) {
+      for (xmlNode* c = p->children; c; c = c->next) {
+        if (step_matches(c, st)) next.push_back(c);
+      }
+    }
+    if (next.empty()) return nullptr;
+    level.swap(next);
+  }
+  xmlNode* best = nullptr; size_t best_len = 0;
+  for (xmlNode* n : level) {
+    size_t len = text_len(n->children);
+    if (!best || len > best_len) { best = n; best_len = len; }
+  }
+  return best;
+}
+
+// Shared extraction over a parsed document; takes ownership of `doc`.
+// `html` is the raw page when available, so the over-budget path can use the byte scanner.
+static CleanResult clean_doc(const std::string& url, htmlDocPtr doc, const CleanBudget& budget,
+                             const std::string* html) {
+  CleanResult out;
   if (!doc) { return out; }
 
   xmlNode* root = xmlDocGetRootElement(doc);
   if (!root) { xmlFreeDoc(doc); return out; }
 
-  // Drop scripts/styles/noscript
-  remove_by_names(root, {"script","style","noscript","svg","iframe"});
+  // The density heuristic is superlinear in DOM size; huge trees take the fast path
+  if (budget.max_dom_nodes > 0 && count_elements(root, budget.max_dom_nodes) > budget.max_dom_nodes) {
+    clean_counters().fallback_dom_nodes++;
+    if (html) {
+      xmlFreeDoc(doc);
+      return fast_extract_text(url, *html);
+    }
+    remove_by_names(root, {"script","style","noscript","svg","iframe"});
+    out.fast_path = true;
+    out.title = extract_title(root);
+    out.body = collect_paragraphs(root);
+  } else {
+    // Drop scripts/styles/noscript
+    remove_by_names(root, {"script","style","noscript","svg","iframe"});
 
-  out.title = extract_title(root);
+    out.title = extract_title(root);
 
-  // Find the biggest content node
-  xmlNode* main = find_main_content(root);
-  if (!main) main = root;
+    // A learned selector for this host skips the heuristic when it still finds enough text
+    TemplateStore* templates = budget.templates;
+    const std::string host = templates ? host_from_url(url) : std::string();
+    xmlNode* main = nullptr;
+    if (templates) {
+      if (auto sel = templates->lookup(host)) {
+        if (xmlNode* n = select_path(root, *sel)) {
+          std::string body = collect_text(n);
+          if (body.size() >= templates->config().min_body_chars) {
+            out.body = std::move(body);
+            out.templated = true;
+            templates->record_hit(host);
+            clean_counters().template_hits++;
+          }
+        }
+        if (!out.templated) {
+          templates->record_miss(host);
+          clean_counters().template_misses++;
+        }
+      }
+    }
 
-  out.body = collect_text(main);
+    if (!out.templated) {
+      // Find the biggest content node
+      main = find_main_content(root);
+      if (templates && main) templates->observe(host, node_path(main));
+      if (!main) main = root;
+      out.body = collect_text(main);
+    }
+  }
 
   xmlFreeDoc(doc);
 
@@ -235,6 +560,231 @@ CleanResult clean_html_to_text(const std::string& url, const std::string& html)
   return out;
 }
 
+static CleanResult from_structured(const std::string& url, const StructuredArticle& a) {
+  clean_counters().structured_hits++;
+  CleanResult out;
+  out.structured = true;
+  out.title = a.headline;
+  out.body = a.body;
+  out.published_ts_ms = a.published_ts_ms;
+  out.language = detect_language_en_heuristic(out.body);
+  out.hints = extract_hints(url, out.body);
+  return out;
+}
+
+CleanResult clean_html_to_text(const std::string& url, const std::string& html, const CleanBudget& budget) {
+  int64_t published_ts_ms = 0;
+  if (budget.min_structured_body_chars > 0) {
+    StructuredDataScanner sd;
+    sd.feed(html.data(), html.size());
+    if (sd.has_body(budget.min_structured_body_chars)) return from_structured(url, sd.article());
+    published_ts_ms = sd.article().published_ts_ms;   // a date without a usable body still helps
+  }
+
+  CleanResult out;
+  if (budget.max_dom_bytes > 0 && html.size() > budget.max_dom_bytes) {
+    clean_counters().fallback_dom_bytes++;
+    out = fast_extract_text(url, html);
+  } else {
+    htmlDocPtr doc = htmlReadMemory(html.c_str(), (int)html.size(), "noname.html", nullptr,
+                                    HTML_PARSE_NOERROR | HTML_PARSE_NOWARNING | HTML_PARSE_NONET);
+    out = clean_doc(url, doc, budget, &html);
+  }
+  out.published_ts_ms = published_ts_ms;
+  return out;
+}
+
+// ---------------- streaming (push) parsing ----------------
+
+struct HtmlPushParser::Impl {
+  htmlParserCtxtPtr ctxt = nullptr;
+  htmlSAXHandler sax;
+  size_t stop_after_article_chars = 0;
+  size_t structured_min_chars = 0;
+  StructuredDataScanner structured;  // JSON-LD/OpenGraph pre-pass over the same bytes
+  int article_depth = 0;        // >0 while inside <article>
+  size_t article_chars = 0;
+  bool done = false;            // main body seen; the transfer can stop
+
+  static Impl* self(void* ctx) {
+    return reinterpret_cast<Impl*>(reinterpret_cast<htmlParserCtxtPtr>(ctx)->_private);
+  }
+  static void on_start(void* ctx, const xmlChar* name, const xmlChar** atts) {
+    xmlSAX2StartElement(ctx, name, atts);
+    if (!xmlStrcasecmp(name, BAD_CAST "article")) self(ctx)->article_depth++;
+  }
+  static void on_end(void* ctx, const xmlChar* name) {
+    xmlSAX2EndElement(ctx, name);
+    Impl* im = self(ctx);
+    if (im->article_depth > 0 && !xmlStrcasecmp(name, BAD_CAST "article")) {
+      if (--im->article_depth == 0 && im->stop_after_article_chars > 0 &&
+          im->article_chars >= im->stop_after_article_chars) {
+        im->done = true;
+      }
+    }
+  }
+  static void on_chars(void* ctx, const xmlChar* ch, int len) {
+    xmlSAX2Characters(ctx, ch, len);
+    Impl* im = self(ctx);
+    if (im->article_depth > 0) im->article_chars += (size_t)len;
+  }
+};
+
+HtmlPushParser::HtmlPushParser(size_t stop_after_article_chars, size_t structured_min_chars)
+    : impl_(new Impl()) {
+  impl_->stop_after_article_chars = stop_after_article_chars;
+  impl_->structured_min_chars = structured_min_chars;
+  std::memset(&impl_->sax, 0, sizeof(impl_->sax));
+  xmlSAX2InitHtmlDefaultSAXHandler(&impl_->sax);
+  impl_->sax.startElement = Impl::on_start;
+  impl_->sax.endElement = Impl::on_end;
+  impl_->sax.characters = Impl::on_chars;
+}
+
+HtmlPushParser::~HtmlPushParser() {
+  if (impl_) {
+    if (impl_->ctxt) {
+      if (impl_->ctxt->myDoc) xmlFreeDoc(impl_->ctxt->myDoc);
+      htmlFreeParserCtxt(impl_->ctxt);
+    }
+    delete impl_;
+  }
+}
+
+bool HtmlPushParser::feed(const char* data, size_t len) {
+  if (impl_->done) return false;
+  if (impl_->structured_min_chars > 0) {
+    impl_->structured.feed(data, len);
+    if (impl_->structured.has_body(impl_->structured_min_chars)) {
+      impl_->done = true;   // JSON-LD has the article: no need for the DOM or the rest of the page
+      return false;
+    }
+  }
+  if (!impl_->ctxt) {
+    // nullptr user_data: SAX2 defaults receive the parser context, our state rides in _private
+    impl_->ctxt = htmlCreatePushParserCtxt(&impl_->sax, nullptr, data, (int)len, "noname.html",
+                                           XML_CHAR_ENCODING_NONE);
+    if (!impl_->ctxt) { impl_->done = true; return false; }
+    impl_->ctxt->_private = impl_;
+    htmlCtxtUseOptions(impl_->ctxt, HTML_PARSE_NOERROR | HTML_PARSE_NOWARNING | HTML_PARSE_NONET);
+  } else {
+    htmlParseChunk(impl_->ctxt, data, (int)len, 0);
+  }
+  return !impl_->done;
+}
+
+CleanResult HtmlPushParser::finish(const std::string& url, const CleanBudget& budget) {
+  if (impl_->structured_min_chars > 0 && impl_->structured.has_body(impl_->structured_min_chars)) {
+    return from_structured(url, impl_->structured.article());   // partial DOM is freed with the parser
+  }
+  if (!impl_->ctxt) return CleanResult{};
+  htmlParseChunk(impl_->ctxt, nullptr, 0, 1);
+  htmlDocPtr doc = impl_->ctxt->myDoc;
+  impl_->ctxt->myDoc = nullptr;
+  CleanResult out = clean_doc(url, doc, budget, nullptr);
+  out.published_ts_ms = impl_->structured.article().published_ts_ms;
+  return out;
+}
+
+bool fetch_into(const std::string& url, const HtmlFetchOptions& opt, HtmlPushParser& parser, FetchAbort* abort) {
+  FetchAbort why = FetchAbort::None;
+  fetch_html_impl(url, opt, &why, &parser);
+  if (abort) *abort = why;
+  return why == FetchAbort::None;
+}
+
+std::optional<CleanResult> fetch_and_clean(const std::string& url, const HtmlFetchOptions& opt,
+                                           const CleanBudget& budget, FetchAbort* abort) {
+  HtmlPushParser parser(opt.stop_after_article_chars, budget.min_structured_body_chars);
+  if (!fetch_into(url, opt, parser, abort)) return std::nullopt;
+  return parser.finish(url, budget);
+}
+
+// ASCII case-insensitive match of `tag` at html[i] (just after '<' or "</")
+static bool tag_at(const std::string& html, size_t i, const char* tag) {
+  size_t n = std::strlen(tag);
+  if (i + n > html.size()) return false;
+  for (size_t k = 0; k < n; ++k) {
+    if (std::tolower((unsigned char)html[i + k]) != tag[k]) return false;
+  }
+  // must be followed by a delimiter, not more name characters
+  if (i + n == html.size()) return true;
+  unsigned char d = html[i + n];
+  return d == '>' || d == '/' || std::isspace(d);
+}
+
+// Finds the closing "</tag" at or after `from`; npos if absent
+static size_t find_close(const std::string& html, size_t from, const char* tag) {
+  for (size_t p = html.find("</", from); p != std::string::npos; p = html.find("</", p + 2)) {
+    if (tag_at(html, p + 2, tag)) return p;
+  }
+  return std::string::npos;
+}
+
+// Appends text between tags, collapsing whitespace and decoding the common entities
+static void append_stripped(const std::string& html, size_t a, size_t b, std::string& out) {
+  bool in_tag = false, space = !out.empty() && out.back() != '\n';
+  for (size_t i = a; i < b; ++i) {
+    char c = html[i];
+    if (in_tag) { if (c == '>') in_tag = false; continue; }
+    if (c == '<') { in_tag = true; continue; }
+    if (c == '&') {
+      static const std::pair<const char*, char> ents[] = {
+        {"&amp;", '&'}, {"&lt;", '<'}, {"&gt;", '>'}, {"&quot;", '"'}, {"&#39;", '\''}, {"&nbsp;", ' '}};
+      for (auto& [e, ch] : ents) {
+        size_t n = std::strlen(e);
+        if (html.compare(i, n, e) == 0) { c = ch; i += n - 1; break; }
+      }
+    }
+    if (std::isspace((unsigned char)c)) { space = true; continue; }
+    if (space && !out.empty() && out.back() != '\n') out.push_back(' ');
+    space = false;
+    out.push_back(c);
+  }
+}
+
+CleanResult fast_extract_text(const std::string& url, const std::string& html) {
+  CleanResult out;
+  out.fast_path = true;
+
+  size_t i = 0;
+  while ((i = html.find('<', i)) != std::string::npos) {
+    size_t name = i + 1;
+    if (tag_at(html, name, "script") || tag_at(html, name, "style") || tag_at(html, name, "noscript")) {
+      const char* t = tag_at(html, name, "script") ? "script" : tag_at(html, name, "style") ? "style" : "noscript";
+      size_t end = find_close(html, name, t);
+      if (end == std::string::npos) break;
+      i = end + 2;
+      continue;
+    }
+    if (out.title.empty() && tag_at(html, name, "title")) {
+      size_t gt = html.find('>', name);
+      size_t end = (gt == std::string::npos) ? gt : find_close(html, gt, "title");
+      if (end == std::string::npos) break;
+      append_stripped(html, gt + 1, end, out.title);
+      i = end + 2;
+      continue;
+    }
+    if (tag_at(html, name, "p")) {
+      size_t gt = html.find('>', name);
+      if (gt == std::string::npos) break;
+      size_t end = find_close(html, gt, "p");
+      if (end == std::string::npos) end = html.size();
+      if (!out.body.empty()) out.body.push_back('\n');
+      append_stripped(html, gt + 1, end, out.body);
+      i = end;
+      continue;
+    }
+    ++i;
+  }
+
+  out.title = trim(out.title);
+  out.body = trim(out.body);
+  out.language = detect_language_en_heuristic(out.body);
+  out.hints = extract_hints(url, out.body);
+  return out;
+}
+
 std::string detect_language_en_heuristic(const std::string& text) {
   if (text.empty()) return "unknown";
   size_t ascii_like = 0, total = 0;
@@ -265,7 +815,7 @@ static std::string host_from_url(const std::string& url) {
 std::vector<std::string> extract_hints(const std::string& url, const std::string& text) {
   std::vector<std::string> hints;
   // cashtags
-  std::regex cashtag(R"(?:^|[\s\(\[])[$]([A-Z]{1,5})(?:$|[\s\)\],\.!?;:]))");
+  static const std::regex cashtag(R"((?:^|[\s\(\[])[$]([A-Z]{1,5})(?:$|[\s\)\],\.!?;:]))");
   auto begin = std::sregex_iterator(text.begin(), text.end(), cashtag);
   auto end = std::sregex_iterator();
   std::set<std::string> uniq;
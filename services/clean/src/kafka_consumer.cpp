@@ -7,6 +7,7 @@ struct KafkaConsumer::Impl {
   rd_kafka_conf_t* conf = nullptr;
   rd_kafka_t* rk = nullptr;
   rd_kafka_topic_partition_list_t* topics = nullptr;
+  std::string payload;   // owns the last polled value; the rd_kafka message is freed in poll()
 };
 
 KafkaConsumer::KafkaConsumer(const KafkaConsumerCfg& cfg) : impl_(new Impl()) {
@@ -21,6 +22,8 @@ KafkaConsumer::KafkaConsumer(const KafkaConsumerCfg& cfg) : impl_(new Impl()) {
     throw std::runtime_error(errstr);
   if (rd_kafka_conf_set(impl_->conf, "auto.offset.reset", cfg.auto_offset_reset.c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK)
     throw std::runtime_error(errstr);
+  if (rd_kafka_conf_set(impl_->conf, "enable.auto.commit", cfg.enable_auto_commit ? "true" : "false", errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK)
+    throw std::runtime_error(errstr);
 
   impl_->rk = rd_kafka_new(RD_KAFKA_CONSUMER, impl_->conf, errstr, sizeof(errstr));
   if (!impl_->rk) throw std::runtime_error(std::string("rd_kafka_new consumer failed: ") + errstr);
@@ -45,6 +48,12 @@ KafkaConsumer::~KafkaConsumer() {
 }
 
 bool KafkaConsumer::poll(std::string& key_out, const void*& payload_out, size_t& len_out, int timeout_ms) {
+  KafkaMessageMeta meta;
+  return poll(key_out, payload_out, len_out, meta, timeout_ms);
+}
+
+bool KafkaConsumer::poll(std::string& key_out, const void*& payload_out, size_t& len_out, KafkaMessageMeta& meta,
+                         int timeout_ms) {
   rd_kafka_message_t* rkmessage = rd_kafka_consumer_poll(impl_->rk, timeout_ms);
   if (!rkmessage) return false;
 
@@ -60,10 +69,37 @@ bool KafkaConsumer::poll(std::string& key_out, const void*& payload_out, size_t&
       key_out.assign((const char*)rkmessage->key, rkmessage->key_len);
     else
       key_out.clear();
-    payload_out = rkmessage->payload;
-    len_out = rkmessage->len;
+    impl_->payload.assign((const char*)rkmessage->payload, rkmessage->len);
+    payload_out = impl_->payload.data();
+    len_out = impl_->payload.size();
+    meta.topic = rkmessage->rkt ? rd_kafka_topic_name(rkmessage->rkt) : "";
+    meta.partition = rkmessage->partition;
+    meta.offset = rkmessage->offset;
   }
 
   rd_kafka_message_destroy(rkmessage);
   return ok;
 }
+
+bool KafkaConsumer::commit(const std::string& topic, int32_t partition, int64_t next_offset) {
+  rd_kafka_topic_partition_list_t* offsets = rd_kafka_topic_partition_list_new(1);
+  rd_kafka_topic_partition_list_add(offsets, topic.c_str(), partition)->offset = next_offset;
+  rd_kafka_resp_err_t err = rd_kafka_commit(impl_->rk, offsets, 0 /* sync */);
+  rd_kafka_topic_partition_list_destroy(offsets);
+  if (err) {
+    std::cerr << "[kafka] commit failed " << topic << "[" << partition << "]@" << next_offset
+              << ": " << rd_kafka_err2str(err) << "\n";
+    return false;
+  }
+  return true;
+}
+
+void KafkaConsumer::set_paused(bool paused) {
+  rd_kafka_topic_partition_list_t* parts = nullptr;
+  rd_kafka_resp_err_t err = rd_kafka_assignment(impl_->rk, &parts);
+  if (!err && parts && parts->cnt > 0) {
+    err = paused ? rd_kafka_pause_partitions(impl_->rk, parts) : rd_kafka_resume_partitions(impl_->rk, parts);
+  }
+  if (parts) rd_kafka_topic_partition_list_destroy(parts);
+  if (err) std::cerr << "[kafka] " << (paused ? "pause" : "resume") << " failed: " << rd_kafka_err2str(err) << "\n";
+}
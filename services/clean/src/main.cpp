@@ -1,18 +1,75 @@
 #include <fmt/core.h>
 #include <xxhash.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <csignal>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include "html_clean.h"
+#include "near_dup.h"
+#include "template_store.h"
 #include "kafka_consumer.h"
 #include "kafka_pub.h"
 #include "config.h"
+#include "url_merge.h"
+#include "config_watch.h"
+#include "task_sched.h"
 #include "news.pb.h"
 
+#include <libxml/parser.h>
+
 static volatile std::sig_atomic_t g_stop = 0;
 static void handle_sigint(int) { g_stop = 1; }
 
+static long long NowMs() {
+  using namespace std::chrono;
+  return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+// Cleaner settings that may change on reload; swapped as one immutable snapshot
+struct CleanSettings {
+  AppCleaner cleaner;
+  HtmlFetchOptions fopt;
+  CleanBudget budget;
+};
+
+static std::shared_ptr<const CleanSettings> make_settings(const AppCleaner& cl, TemplateStore* templates) {
+  auto st = std::make_shared<CleanSettings>();
+  st->cleaner = cl;
+  st->fopt.user_agent = cl.user_agent;
+  st->fopt.timeout_secs = cl.http_timeout_secs;
+  st->fopt.max_body_bytes = (size_t)std::max(0, cl.max_body_bytes);
+  st->fopt.require_html = cl.require_html_content_type;
+  st->fopt.stop_after_article_chars = (size_t)std::max(0, cl.stop_after_article_chars);
+  st->budget.max_dom_bytes = (size_t)std::max(0, cl.max_dom_bytes);
+  st->budget.max_dom_nodes = (size_t)std::max(0, cl.max_dom_nodes);
+  st->budget.min_structured_body_chars = (size_t)std::max(0, cl.structured_min_body_chars);
+  st->budget.templates = templates;
+  return st;
+}
+
+// One message in flight: downloaded on a fetch thread, extracted on a scheduler worker,
+// then finished (near-dup, produce) on the main thread. Jobs are recycled so ArticleRaw keeps its capacity.
+struct CleanJob {
+  finnews::ArticleRaw raw;
+  std::shared_ptr<const CleanSettings> cfg;
+  CleanResult r;
+  bool ok = false;
+};
+
+// Jobs handed back by the workers
+struct Completions {
+  std::mutex mu;
+  std::condition_variable cv;
+  std::vector<CleanJob*> done;
+};
+
 int main(int argc, char** argv) {
   std::signal(SIGINT, handle_sigint);
   std::signal(SIGTERM, handle_sigint);
@@ -37,65 +94,246 @@ int main(int argc, char** argv) {
   pcfg.acks = app.kafka.acks;
   pcfg.linger_ms = app.kafka.linger_ms;
   pcfg.batch_num_messages = app.kafka.batch_num_messages;
+  pcfg.profile = app.kafka.producer_profile;
+  pcfg.compression = app.kafka.compression;
+  pcfg.idempotence = app.kafka.idempotence;
+  pcfg.queue_full_max_wait_ms = app.kafka.queue_full_max_wait_ms;
+  if (app.kafka.spool_enable) {
+    pcfg.spool_dir = app.kafka.spool_dir + "/" + pcfg.topic;
+    pcfg.spool_segment_bytes = (size_t)app.kafka.spool_segment_mb << 20;
+    pcfg.spool_max_bytes = (size_t)app.kafka.spool_max_mb << 20;
+    pcfg.spool_sync_ms = app.kafka.spool_sync_ms;
+  }
 
   KafkaProducer producer(pcfg);
 
-  HtmlFetchOptions fopt;
-  fopt.user_agent = app.cleaner.user_agent;
-  fopt.timeout_secs = app.cleaner.http_timeout_secs;
+  std::unique_ptr<TemplateStore> templates;
+  if (app.cleaner.templates_enable) {
+    TemplateStoreConfig tcfg;
+    tcfg.path = app.cleaner.templates_path;
+    tcfg.learn_after = app.cleaner.templates_learn_after;
+    tcfg.max_failures = app.cleaner.templates_max_failures;
+    tcfg.min_body_chars = (size_t)std::max(0, app.cleaner.min_body_chars);
+    templates = std::make_unique<TemplateStore>(tcfg);
+  }
+
+  std::atomic<std::shared_ptr<const CleanSettings>> settings{make_settings(app.cleaner, templates.get())};
+
+  NearDupConfig ndcfg;
+  ndcfg.enable = app.cleaner.near_dup_enable;
+  ndcfg.max_hamming = app.cleaner.near_dup_max_hamming;
+  ndcfg.window_secs = app.cleaner.near_dup_window_secs;
+  ndcfg.max_entries = (size_t)app.cleaner.near_dup_max_entries;
+  NearDupIndex near_dups(ndcfg);
+  size_t near_dup_hits = 0;
 
   fmt::print("[news_clean] Ready. Consuming '{}' -> producing '{}'\n", app.kafka.topic_raw, app.kafka.topic_clean);
 
+  // Hot reload (SIGHUP or app.yml change) of the cleaner section. The near-dup index
+  // itself (enable/window/size), the template store, the worker pool and Kafka settings
+  // need a restart.
+  ConfigWatcher watcher({app_cfg_path});
+  auto last_reload_check = std::chrono::steady_clock::now();
+  auto maybe_reload = [&]() {
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_reload_check < std::chrono::seconds(1)) return;
+    last_reload_check = now;
+    if (!watcher.poll()) return;
+    try {
+      AppConfig next = load_app_config(app_cfg_path);
+      auto errs = validate_app_config(next);
+      if (!errs.empty()) {
+        for (const auto& e : errs) fmt::print("[news_clean] Reload rejected: {}\n", e);
+        return;
+      }
+      settings.store(make_settings(next.cleaner, templates.get()));
+      fmt::print("[news_clean] Reloaded cleaner config\n");
+    } catch (const std::exception& e) {
+      fmt::print("[news_clean] Reload failed, keeping current config: {}\n", e.what());
+    }
+  };
+
+  // Downloads block on the network, so they get their own unpinned pool and never
+  // occupy an extraction worker; only the CPU-bound extraction goes to the scheduler,
+  // where a few giant pages no longer hold up the small ones. In streaming mode the
+  // tree is still built as bytes arrive (on the fetch thread); the extraction runs
+  // on the finished tree. Near-dup and produce stay on this thread.
+  xmlInitParser();   // once, before libxml2 is used from the workers
+  TaskSchedConfig scfg;
+  scfg.workers = (size_t)app.cleaner.workers;
+  scfg.pinning = app.cleaner.cpu_pinning;
+  TaskScheduler sched(scfg);
+  TaskSchedConfig fcfg;
+  fcfg.workers = (size_t)app.cleaner.fetch_threads;
+  TaskScheduler fetch_pool(fcfg);   // declared after sched: destroyed (joined) first
+  const size_t max_in_flight = (size_t)std::max(1, app.cleaner.max_in_flight);
+
+  std::vector<std::unique_ptr<CleanJob>> jobs;   // owns every job; idle ones sit in free_jobs
+  std::vector<CleanJob*> free_jobs;
+  size_t in_flight = 0;
+  Completions completions;
+
   std::string key;
   const void* payload = nullptr; size_t len = 0;
   int processed = 0;
+  finnews::ArticleClean c;   // reused per message; Clear() keeps string/repeated capacity
 
-  while (!g_stop) {
-    if (!consumer.poll(key, payload, len, 200)) continue;
-    if (!payload || len == 0) continue;
-
-    finnews::ArticleRaw raw;
-    if (!raw.ParseFromArray(payload, (int)len)) {
-      fmt::print("[news_clean] WARN: failed to parse ArticleRaw\n");
-      continue;
-    }
-
-    auto html_opt = fetch_html(raw.url(), fopt);
-    if (!html_opt) {
+  auto finish = [&](CleanJob& job) {
+    const auto& cfg = job.cfg;
+    const auto& raw = job.raw;
+    CleanResult& r = job.r;
+    if (!job.ok) {
       fmt::print("[news_clean] WARN: failed HTML fetch url={}\n", raw.url());
-      continue;
+      return;
     }
 
-    auto r = clean_html_to_text(raw.url(), *html_opt);
-
-    if (app.cleaner.require_english && r.language != "en") {
+    if (cfg->cleaner.require_english && r.language != "en") {
       // Skip if not English
-      continue;
+      return;
     }
-    if ((int)r.body.size() < app.cleaner.min_body_chars) {
-      continue;
+    if ((int)r.body.size() < cfg->cleaner.min_body_chars) {
+      return;
     }
 
-    finnews::ArticleClean c;
+    std::string cluster_id = raw.id();
+    if (ndcfg.enable) {
+      bool is_dup = false;
+      cluster_id = near_dups.observe(raw.id(), simhash64(r.body, ndcfg.shingle_words), NowMs(), is_dup);
+      if (is_dup) {
+        ++near_dup_hits;
+        if (cfg->cleaner.near_dup_action == "drop") return;   // per job: the action hot-reloads
+      }
+    }
+
+    c.Clear();
     c.set_id(raw.id());
     c.set_source(raw.source());
     c.set_url(raw.url());
     c.set_title(!r.title.empty() ? r.title : raw.title());
     c.set_body(r.body);
-    c.set_published_ts(raw.published_ts());
+    // the page's own publish time beats feed timestamps (and the ingest-time fallback)
+    c.set_published_ts(r.published_ts_ms > 0 ? r.published_ts_ms : raw.published_ts());
     c.set_language(r.language);
+    c.set_cluster_id(cluster_id);
     for (auto& h : r.hints) c.add_hints(h);
+    // Tickers from merged feed sources ("YahooFinanceRSS:AAPL") become ticker hints
+    for (auto& s : raw.sources()) {
+      c.add_sources(s);
+      if (auto t = source_ticker(s); !t.empty()) c.add_hints("ticker:" + t);
+    }
 
-    std::string bytes;
-    if (!c.SerializeToString(&bytes)) {
-      fmt::print("[news_clean] ERROR: failed to serialize ArticleClean id={}\n", raw.id());
+    if (!producer.produce_message(raw.id(), c)) {
+      fmt::print("[news_clean] ERROR: failed to produce ArticleClean id={}\n", raw.id());
+      return;
+    }
+
+    producer.poll(0);   // serve delivery reports; linger still batches the sends
+    if (++processed % 1000 == 0) {
+      const auto& cc = clean_counters();
+      const auto ks = producer.stats();
+      fmt::print("[news_clean] processed={} near_dups={} index_size={} "
+                 "abort[network={} http={} too_large={} not_html={}] fallback[bytes={} nodes={}] structured={} "
+                 "template[hit={} miss={}] kafka[delivered={} failed={} queue_full={} avg={:.1f}ms p99<={:.1f}ms] "
+                 "spool[depth={} spooled={} replayed={} dropped={}]\n",
+                 processed, near_dup_hits, near_dups.size(),
+                 cc.abort_network.load(), cc.abort_http_status.load(), cc.abort_too_large.load(),
+                 cc.abort_not_html.load(), cc.fallback_dom_bytes.load(), cc.fallback_dom_nodes.load(),
+                 cc.structured_hits.load(), cc.template_hits.load(), cc.template_misses.load(), ks.delivered, ks.failed, ks.queue_full_waits, ks.avg_latency_ms, ks.p99_latency_ms,
+                 ks.spool_depth, ks.spooled, ks.replayed, ks.spool_rejected);
+      for (const TaskScheduler* pool : {&fetch_pool, &sched}) {
+        for (const auto& t : pool->timings()) {
+          fmt::print("[news_clean] task {}: n={} avg={:.1f}ms p99<={:.1f}ms max={:.1f}ms wait={:.1f}ms\n",
+                     t.kind, t.count, t.avg_ms, t.p99_ms, t.max_ms, t.avg_wait_ms);
+        }
+      }
+      if (templates) {
+        const auto hosts = templates->stats();
+        for (size_t i = 0; i < hosts.size() && i < 10; ++i) {
+          const auto& h = hosts[i];
+          const uint64_t tried = h.hits + h.misses;
+          fmt::print("[news_clean] template {}: {} hits={} misses={} hit_rate={:.1f}% heuristic={}\n",
+                     h.host, h.active ? "active" : "learning", h.hits, h.misses,
+                     tried ? 100.0 * h.hits / tried : 0.0, h.learned);
+        }
+      }
+    }
+  };
+
+  // Finishes whatever the workers completed, waiting up to wait_ms for the first one
+  auto drain = [&](int wait_ms) {
+    std::vector<CleanJob*> batch;
+    {
+      std::unique_lock<std::mutex> lk(completions.mu);
+      if (wait_ms > 0) {
+        completions.cv.wait_for(lk, std::chrono::milliseconds(wait_ms),
+                                [&]{ return !completions.done.empty(); });
+      }
+      batch.swap(completions.done);
+    }
+    for (CleanJob* job : batch) {
+      finish(*job);
+      job->cfg.reset();
+      free_jobs.push_back(job);
+      --in_flight;
+    }
+  };
+
+  while (!g_stop) {
+    maybe_reload();
+    if (templates) templates->save_if_due();
+    drain(0);
+    if (in_flight >= max_in_flight) { drain(200); continue; }
+
+    if (!consumer.poll(key, payload, len, in_flight > 0 ? 20 : 200)) continue;
+    if (!payload || len == 0) continue;
+
+    if (free_jobs.empty()) {
+      jobs.push_back(std::make_unique<CleanJob>());
+      free_jobs.push_back(jobs.back().get());
+    }
+    CleanJob* job = free_jobs.back();
+    if (!job->raw.ParseFromArray(payload, (int)len)) {
+      fmt::print("[news_clean] WARN: failed to parse ArticleRaw\n");
       continue;
     }
-    producer.produce(raw.id(), bytes.data(), bytes.size());
+    free_jobs.pop_back();
+    job->cfg = settings.load();   // snapshot for this message
+    job->ok = false;
+    ++in_flight;
 
-    if (++processed % 10 == 0) producer.flush(10);
+    auto complete = [&completions](CleanJob* j) {
+      std::lock_guard<std::mutex> lk(completions.mu);
+      completions.done.push_back(j);
+      completions.cv.notify_one();
+    };
+    if (job->cfg->cleaner.streaming) {
+      fetch_pool.submit("fetch", [job, complete, &sched] {
+        auto parser = std::make_shared<HtmlPushParser>(job->cfg->fopt.stop_after_article_chars,
+                                                       job->cfg->budget.min_structured_body_chars);
+        if (!fetch_into(job->raw.url(), job->cfg->fopt, *parser)) { complete(job); return; }
+        sched.submit("extract", [job, complete, parser] {
+          job->r = parser->finish(job->raw.url(), job->cfg->budget);
+          job->ok = true;
+          complete(job);
+        });
+      });
+    } else {
+      fetch_pool.submit("fetch", [job, complete, &sched] {
+        auto html = std::make_shared<std::optional<std::string>>(fetch_html(job->raw.url(), job->cfg->fopt));
+        if (!*html) { complete(job); return; }
+        sched.submit("extract", [job, complete, html] {
+          job->r = clean_html_to_text(job->raw.url(), **html, job->cfg->budget);
+          job->ok = true;
+          complete(job);
+        });
+      });
+    }
   }
 
+  fetch_pool.wait_idle();
+  sched.wait_idle();
+  drain(0);
+  if (templates) templates->save();
   fmt::print("[news_clean] Stopping.\n");
   return 0;
 }
@@ -0,0 +1,104 @@
+#include "near_dup.h"
+#include <xxhash.h>
+#include <algorithm>
+#include <bit>
+#include <cctype>
+
+uint64_t simhash64(const std::string& text, int shingle_words) {
+  if (shingle_words < 1) shingle_words = 1;
+  int weights[64] = {0};
+  std::vector<uint64_t> window((size_t)shingle_words, 0);
+  size_t nwords = 0;
+
+  char buf[64];
+  size_t blen = 0;
+  auto flush_word = [&]() {
+    if (blen == 0) return;
+    window[nwords % window.size()] = XXH64(buf, blen, 0);
+    ++nwords;
+    blen = 0;
+    if (nwords < window.size()) return;
+    // order-sensitive combination of the last `shingle_words` token hashes
+    uint64_t sh = 0;
+    for (size_t i = 0; i < window.size(); ++i) {
+      uint64_t h = window[(nwords + i) % window.size()];
+      sh = XXH64(&h, sizeof(h), sh);
+    }
+    for (int b = 0; b < 64; ++b) weights[b] += ((sh >> b) & 1) ? 1 : -1;
+  };
+
+  for (unsigned char c : text) {
+    if (std::isalnum(c)) {
+      if (blen < sizeof(buf)) buf[blen++] = (char)std::tolower(c);
+    } else {
+      flush_word();
+    }
+  }
+  flush_word();
+
+  // texts shorter than one shingle: hash what we have as a single shingle
+  if (nwords > 0 && nwords < window.size()) {
+    uint64_t sh = 0;
+    for (size_t i = 0; i < nwords; ++i) sh = XXH64(&window[i], sizeof(uint64_t), sh);
+    for (int b = 0; b < 64; ++b) weights[b] += ((sh >> b) & 1) ? 1 : -1;
+  }
+
+  uint64_t out = 0;
+  for (int b = 0; b < 64; ++b) if (weights[b] > 0) out |= (1ULL << b);
+  return out;
+}
+
+NearDupIndex::NearDupIndex(const NearDupConfig& cfg) : cfg_(cfg) {
+  bands_ = std::clamp(cfg_.max_hamming + 1, 1, 16);
+  band_bits_ = 64 / bands_;
+}
+
+uint64_t NearDupIndex::band_key(int band, uint64_t hash) const {
+  uint64_t mask = (band_bits_ >= 64) ? ~0ULL : ((1ULL << band_bits_) - 1);
+  uint64_t v = (hash >> (band * band_bits_)) & mask;
+  return ((uint64_t)band << 56) ^ v;
+}
+
+void NearDupIndex::evict(int64_t now_ms) {
+  const int64_t horizon = now_ms - (int64_t)cfg_.window_secs * 1000LL;
+  while (!entries_.empty() &&
+         (entries_.front().ts_ms < horizon || entries_.size() >= cfg_.max_entries)) {
+    const uint64_t seq = base_seq_;
+    const uint64_t hash = entries_.front().hash;
+    for (int b = 0; b < bands_; ++b) {
+      auto it = buckets_.find(band_key(b, hash));
+      if (it == buckets_.end()) continue;
+      auto& v = it->second;
+      // oldest entry is always at the front of its buckets
+      if (!v.empty() && v.front() == seq) v.pop_front();
+      if (v.empty()) buckets_.erase(it);
+    }
+    entries_.pop_front();
+    ++base_seq_;
+  }
+}
+
+std::string NearDupIndex::observe(const std::string& id, uint64_t hash, int64_t now_ms, bool& is_dup) {
+  evict(now_ms);
+
+  is_dup = false;
+  int best_dist = cfg_.max_hamming + 1;
+  const Entry* best = nullptr;
+  for (int b = 0; b < bands_; ++b) {
+    auto it = buckets_.find(band_key(b, hash));
+    if (it == buckets_.end()) continue;
+    for (uint64_t seq : it->second) {
+      const Entry& e = entries_[seq - base_seq_];
+      int d = std::popcount(e.hash ^ hash);
+      if (d < best_dist) { best_dist = d; best = &e; }
+    }
+  }
+
+  std::string cluster = best ? best->cluster_id : id;
+  is_dup = (best != nullptr);
+
+  const uint64_t seq = base_seq_ + entries_.size();
+  entries_.push_back(Entry{hash, now_ms, cluster});
+  for (int b = 0; b < bands_; ++b) buckets_[band_key(b, hash)].push_back(seq);
+  return cluster;
+}
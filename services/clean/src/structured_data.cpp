@@ -0,0 +1,408 @@
+#include "structured_data.h"
+#include <nlohmann/json.hpp>
+#include <strings.h>
+#include <cctype>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+constexpr size_t kMaxTagBytes = 8192;          // longer tags are skipped, not parsed
+constexpr size_t kMaxJsonLdBytes = 4u << 20;   // per block
+
+bool is_article_type(const std::string& t) {
+  // NewsArticle, ReportageNewsArticle, AnalysisNewsArticle, ... and plain Article
+  if (t.size() >= 7 && t.compare(t.size() - 7, 7, "Article") == 0) return true;
+  return t == "BlogPosting" || t == "LiveBlogPosting" || t == "Report";
+}
+
+void append_utf8(std::string& out, unsigned long cp) {
+  if (cp < 0x80) out.push_back((char)cp);
+  else if (cp < 0x800) { out.push_back((char)(0xC0 | (cp >> 6))); out.push_back((char)(0x80 | (cp & 0x3F))); }
+  else if (cp < 0x10000) {
+    out.push_back((char)(0xE0 | (cp >> 12)));
+    out.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+    out.push_back((char)(0x80 | (cp & 0x3F)));
+  } else if (cp < 0x110000) {
+    out.push_back((char)(0xF0 | (cp >> 18)));
+    out.push_back((char)(0x80 | ((cp >> 12) & 0x3F)));
+    out.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+    out.push_back((char)(0x80 | (cp & 0x3F)));
+  }
+}
+
+// articleBody is sometimes HTML or entity-escaped: drop tags (block ends become
+// newlines), decode entities, collapse runs of whitespace.
+std::string strip_markup(const std::string& s) {
+  std::string out;
+  out.reserve(s.size());
+  bool space = false, newline = false;
+  auto emit = [&](char c) {
+    if (newline) { if (!out.empty()) out.push_back('\n'); }
+    else if (space && !out.empty() && out.back() != '\n') out.push_back(' ');
+    space = newline = false;
+    out.push_back(c);
+  };
+  for (size_t i = 0; i < s.size(); ++i) {
+    char c = s[i];
+    if (c == '<') {
+      size_t gt = s.find('>', i);
+      if (gt == std::string::npos) break;
+      size_t a = i + 1;
+      if (a < gt && s[a] == '/') ++a;
+      std::string name;
+      while (a < gt && std::isalnum((unsigned char)s[a])) name.push_back((char)std::tolower((unsigned char)s[a++]));
+      static const char* const kBlock[] = {"p", "br", "div", "li", "ul", "ol", "blockquote", "tr",
+                                           "h1", "h2", "h3", "h4", "h5", "h6"};
+      bool block = false;
+      for (const char* b : kBlock) block = block || name == b;
+      if (block) newline = true; else space = true;
+      i = gt;
+      continue;
+    }
+    if (c == '&') {
+      size_t semi = s.find(';', i);
+      if (semi != std::string::npos && semi - i <= 10) {
+        std::string ent = s.substr(i + 1, semi - i - 1);
+        unsigned long cp = 0;
+        if (!ent.empty() && ent[0] == '#') {
+          cp = (ent.size() > 1 && (ent[1] == 'x' || ent[1] == 'X')) ? std::strtoul(ent.c_str() + 2, nullptr, 16)
+                                                                   : std::strtoul(ent.c_str() + 1, nullptr, 10);
+        } else if (ent == "amp") cp = '&';
+        else if (ent == "lt") cp = '<';
+        else if (ent == "gt") cp = '>';
+        else if (ent == "quot") cp = '"';
+        else if (ent == "apos") cp = '\'';
+        else if (ent == "nbsp") cp = ' ';
+        if (cp == ' ') { space = true; i = semi; continue; }
+        if (cp > 0) {
+          std::string enc;
+          append_utf8(enc, cp);
+          for (char e : enc) emit(e);
+          i = semi;
+          continue;
+        }
+      }
+    }
+    if (c == '\n') { newline = true; continue; }
+    if (std::isspace((unsigned char)c)) { space = true; continue; }
+    emit(c);
+  }
+  return out;
+}
+
+// SAX consumer for one JSON-LD block. Tracks a frame per open object/array so
+// fields are attributed to the object that holds them, whatever the nesting
+// (@graph arrays, author/publisher sub-objects).
+class JsonLdSax : public nlohmann::json_sax<nlohmann::json> {
+public:
+  struct Found { std::string type, headline, body, date; };
+  std::vector<Found> articles;
+
+  bool null() override { return true; }
+  bool boolean(bool) override { return true; }
+  bool number_integer(number_integer_t) override { return true; }
+  bool number_unsigned(number_unsigned_t) override { return true; }
+  bool number_float(number_float_t, const string_t&) override { return true; }
+  bool binary(binary_t&) override { return true; }
+
+  bool string(string_t& v) override {
+    if (stack_.empty()) return true;
+    Frame& f = stack_.back();
+    if (!f.is_object) {
+      // "@type": ["NewsArticle", ...]
+      if (f.key == "@type" && stack_.size() >= 2 && is_article_type(v)) {
+        Frame& owner = stack_[stack_.size() - 2];
+        owner.article = true;
+        if (owner.found.type.empty()) owner.found.type = v;
+      }
+      return true;
+    }
+    if (f.key == "@type") {
+      if (is_article_type(v)) { f.article = true; f.found.type = v; }
+    } else if (f.key == "articleBody") {
+      f.found.body = std::move(v);
+    } else if (f.key == "headline") {
+      f.found.headline = std::move(v);
+    } else if (f.key == "datePublished" || (f.key == "dateCreated" && f.found.date.empty())) {
+      f.found.date = std::move(v);
+    }
+    return true;
+  }
+
+  bool start_object(std::size_t) override {
+    stack_.push_back(Frame{true, false, {}, {}});
+    return true;
+  }
+  bool key(string_t& k) override {
+    stack_.back().key = std::move(k);
+    return true;
+  }
+  bool end_object() override {
+    Frame f = std::move(stack_.back());
+    stack_.pop_back();
+    if (f.article) articles.push_back(std::move(f.found));
+    return true;
+  }
+  bool start_array(std::size_t) override {
+    // an array inherits the key it is the value of, so "@type": [...] can be recognized
+    std::string k = (!stack_.empty() && stack_.back().is_object) ? stack_.back().key : std::string();
+    stack_.push_back(Frame{false, false, std::move(k), {}});
+    return true;
+  }
+  bool end_array() override {
+    stack_.pop_back();
+    return true;
+  }
+  bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override {
+    return false;   // malformed block: keep whatever closed cleanly before the error
+  }
+
+private:
+  struct Frame {
+    bool is_object = true;
+    bool article = false;
+    std::string key;    // current key (objects) / key the array belongs to (arrays)
+    Found found;
+  };
+  std::vector<Frame> stack_;
+};
+
+// Returns the value of attribute `name` in a raw tag ("meta property=... content=...")
+std::string tag_attr(const std::string& tag, const char* name) {
+  const size_t n = std::strlen(name);
+  size_t i = 0;
+  while (i < tag.size()) {
+    while (i < tag.size() && (std::isspace((unsigned char)tag[i]) || tag[i] == '/')) ++i;
+    size_t a = i;
+    while (i < tag.size() && tag[i] != '=' && !std::isspace((unsigned char)tag[i]) && tag[i] != '/') ++i;
+    const bool match = (i - a == n) && !strncasecmp(tag.c_str() + a, name, n);
+    while (i < tag.size() && std::isspace((unsigned char)tag[i])) ++i;
+    if (i >= tag.size() || tag[i] != '=') { if (i == a) ++i; continue; }
+    ++i;
+    while (i < tag.size() && std::isspace((unsigned char)tag[i])) ++i;
+    std::string val;
+    if (i < tag.size() && (tag[i] == '"' || tag[i] == '\'')) {
+      const char q = tag[i++];
+      size_t e = tag.find(q, i);
+      if (e == std::string::npos) e = tag.size();
+      val = tag.substr(i, e - i);
+      i = e + 1;
+    } else {
+      size_t e = i;
+      while (e < tag.size() && !std::isspace((unsigned char)tag[e])) ++e;
+      val = tag.substr(i, e - i);
+      i = e;
+    }
+    if (match) return val;
+  }
+  return {};
+}
+
+} // namespace
+
+struct StructuredDataScanner::Impl {
+  enum class State { Text, Tag, Comment, RawSkip, JsonLd };
+  State state = State::Text;
+  std::string tag;            // bytes between '<' and '>'
+  char quote = 0;
+  const char* close = nullptr;   // terminator searched for in Comment/RawSkip/JsonLd
+  size_t matched = 0;
+  std::string json;
+  bool json_overflow = false;
+
+  std::string ld_headline, ld_date;
+  std::string og_title, og_published;
+  StructuredArticle art;
+
+  void refresh() {
+    art.headline = strip_markup(!ld_headline.empty() ? ld_headline : og_title);
+    const std::string& date = !ld_date.empty() ? ld_date : og_published;
+    art.published_ts_ms = date.empty() ? 0 : parse_iso8601_ms(date);
+  }
+
+  void on_tag() {
+    size_t e = 0;
+    while (e < tag.size() && !std::isspace((unsigned char)tag[e]) && tag[e] != '/') ++e;
+    const std::string_view name(tag.data(), e);
+    auto is = [&](const char* n) { return name.size() == std::strlen(n) && !strncasecmp(name.data(), n, name.size()); };
+    if (is("script")) {
+      std::string type = tag_attr(tag.substr(e), "type");
+      for (auto& c : type) c = (char)std::tolower((unsigned char)c);
+      const bool ld = type.find("application/ld+json") != std::string::npos;
+      state = ld ? State::JsonLd : State::RawSkip;
+      close = "</script";
+      matched = 0;
+      json.clear();
+      json_overflow = false;
+    } else if (is("style")) {
+      state = State::RawSkip;
+      close = "</style";
+      matched = 0;
+    } else if (is("meta")) {
+      const std::string rest = tag.substr(e);
+      std::string prop = tag_attr(rest, "property");
+      if (prop.empty()) prop = tag_attr(rest, "name");
+      if (prop == "og:title" && og_title.empty()) { og_title = tag_attr(rest, "content"); refresh(); }
+      else if (prop == "article:published_time" && og_published.empty()) {
+        og_published = tag_attr(rest, "content");
+        refresh();
+      }
+    }
+  }
+
+  void on_jsonld() {
+    if (json_overflow || json.empty()) return;
+    JsonLdSax sax;
+    nlohmann::json::sax_parse(json.begin(), json.end(), &sax);
+    for (auto& a : sax.articles) {
+      if (!a.headline.empty() && ld_headline.empty()) ld_headline = a.headline;
+      if (!a.date.empty() && ld_date.empty()) ld_date = a.date;
+      if (a.body.empty()) continue;
+      std::string body = strip_markup(a.body);
+      if (body.size() > art.body.size()) {
+        art.body = std::move(body);
+        art.type = a.type;
+        if (!a.headline.empty()) ld_headline = a.headline;   // keep headline/date from the same object
+        if (!a.date.empty()) ld_date = a.date;
+      }
+    }
+    refresh();
+  }
+
+  // Case-insensitive streaming match of `close`; true when it completes
+  bool match_close(char c) {
+    const char lc = (char)std::tolower((unsigned char)c);
+    if (lc == close[matched]) {
+      if (close[++matched] == 0) { matched = 0; return true; }
+    } else if (!(matched >= 2 && close[0] == close[1] && lc == close[0])) {   // "--->" still ends a comment
+      matched = (lc == close[0]) ? 1 : 0;
+    }
+    return false;
+  }
+
+  void feed(const char* p, size_t n) {
+    size_t i = 0;
+    while (i < n) {
+      switch (state) {
+        case State::Text: {
+          const void* lt = std::memchr(p + i, '<', n - i);
+          if (!lt) return;
+          i = (size_t)((const char*)lt - p) + 1;
+          state = State::Tag;
+          tag.clear();
+          quote = 0;
+          break;
+        }
+        case State::Tag: {
+          const char c = p[i++];
+          if (quote) {
+            if (c == quote) quote = 0;
+          } else if (c == '"' || c == '\'') {
+            quote = c;
+          } else if (c == '>') {
+            state = State::Text;
+            on_tag();
+            break;
+          }
+          tag.push_back(c);
+          if (tag.size() == 3 && tag == "!--") { state = State::Comment; close = "-->"; matched = 0; }
+          else if (tag.size() > kMaxTagBytes) state = State::Text;
+          break;
+        }
+        case State::Comment:
+        case State::RawSkip:
+        case State::JsonLd: {
+          const bool keep = state == State::JsonLd;
+          if (matched == 0) {
+            // skip (or copy) straight to the next byte that can start the terminator
+            const void* q = std::memchr(p + i, close[0], n - i);
+            const size_t stop = q ? (size_t)((const char*)q - p) : n;
+            if (keep) append_json(p + i, stop - i);
+            i = stop;
+            if (!q) return;
+          }
+          const char c = p[i++];
+          if (keep) append_json(&c, 1);
+          if (match_close(c)) {
+            if (keep) {
+              const size_t cl = std::strlen(close);
+              if (json.size() >= cl) json.resize(json.size() - cl);
+              on_jsonld();
+              json.clear();
+            }
+            state = State::Text;
+          }
+          break;
+        }
+      }
+    }
+  }
+
+  void append_json(const char* d, size_t len) {
+    if (json.size() + len > kMaxJsonLdBytes) { json_overflow = true; return; }
+    json.append(d, len);
+  }
+};
+
+StructuredDataScanner::StructuredDataScanner() : impl_(new Impl()) {}
+StructuredDataScanner::~StructuredDataScanner() { delete impl_; }
+
+void StructuredDataScanner::feed(const char* data, size_t len) { impl_->feed(data, len); }
+
+bool StructuredDataScanner::has_body(size_t min_chars) const {
+  return !impl_->art.body.empty() && impl_->art.body.size() >= min_chars;
+}
+
+const StructuredArticle& StructuredDataScanner::article() const { return impl_->art; }
+
+int64_t parse_iso8601_ms(const std::string& s) {
+  auto num = [&](size_t pos, size_t len, int& out) {
+    if (pos + len > s.size()) return false;
+    out = 0;
+    for (size_t k = pos; k < pos + len; ++k) {
+      if (!std::isdigit((unsigned char)s[k])) return false;
+      out = out * 10 + (s[k] - '0');
+    }
+    return true;
+  };
+  std::tm tm{};
+  int y, mo, d;
+  if (!num(0, 4, y) || s.size() < 10 || s[4] != '-' || !num(5, 2, mo) || s[7] != '-' || !num(8, 2, d)) return 0;
+  tm.tm_year = y - 1900;
+  tm.tm_mon = mo - 1;
+  tm.tm_mday = d;
+  int64_t offset_secs = 0;
+  int ms = 0;
+  size_t i = 10;
+  if (i < s.size() && (s[i] == 'T' || s[i] == ' ')) {
+    int h, mi, sec = 0;
+    if (!num(i + 1, 2, h) || i + 3 >= s.size() || s[i + 3] != ':' || !num(i + 4, 2, mi)) return 0;
+    tm.tm_hour = h;
+    tm.tm_min = mi;
+    i += 6;
+    if (i < s.size() && s[i] == ':' && num(i + 1, 2, sec)) { tm.tm_sec = sec; i += 3; }
+    if (i < s.size() && (s[i] == '.' || s[i] == ',')) {
+      int scale = 100;
+      for (++i; i < s.size() && std::isdigit((unsigned char)s[i]); ++i) {
+        ms += (s[i] - '0') * scale;
+        scale /= 10;
+      }
+    }
+    if (i < s.size() && (s[i] == '+' || s[i] == '-')) {
+      int oh = 0, om = 0;
+      const int sign = s[i] == '-' ? -1 : 1;
+      if (!num(i + 1, 2, oh)) return 0;
+      size_t m = i + 3;
+      if (m < s.size() && s[m] == ':') ++m;
+      num(m, 2, om);
+      offset_secs = sign * (oh * 3600 + om * 60);
+    }
+  }
+  const time_t t = timegm(&tm);
+  if (t == (time_t)-1) return 0;
+  return ((int64_t)t - offset_secs) * 1000 + ms;
+}
@@ -0,0 +1,181 @@
+#include "template_store.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+
+constexpr size_t kMaxHosts = 50000;   // learning state is tiny, but keep it bounded
+
+struct HostEntry {
+  std::string selector;
+  bool active = false;
+  int streak = 0;       // consecutive heuristic picks of `selector`
+  int failures = 0;     // consecutive validation failures while active
+  uint64_t hits = 0, misses = 0, learned = 0;
+};
+
+} // namespace
+
+struct TemplateStore::Impl {
+  TemplateStoreConfig cfg;
+  mutable std::mutex mu;
+  std::unordered_map<std::string, HostEntry> hosts;
+  bool dirty = false;
+  std::chrono::steady_clock::time_point last_save = std::chrono::steady_clock::now();
+
+  void load() {
+    if (cfg.path.empty()) return;
+    std::ifstream in(cfg.path);
+    if (!in) return;
+    try {
+      nlohmann::json j = nlohmann::json::parse(in);
+      for (auto& [host, v] : j.at("hosts").items()) {
+        HostEntry e;
+        e.selector = v.at("selector").get<std::string>();
+        e.hits = v.value("hits", (uint64_t)0);
+        e.misses = v.value("misses", (uint64_t)0);
+        e.learned = v.value("learned", (uint64_t)0);
+        e.active = !e.selector.empty();
+        e.streak = cfg.learn_after;
+        hosts[host] = std::move(e);
+      }
+      std::cerr << "[templates] loaded " << hosts.size() << " host selectors from " << cfg.path << "\n";
+    } catch (const std::exception& ex) {
+      std::cerr << "[templates] ignoring unreadable " << cfg.path << ": " << ex.what() << "\n";
+      hosts.clear();
+    }
+  }
+
+  bool save_locked() {
+    if (cfg.path.empty()) return true;
+    nlohmann::json j;
+    j["version"] = 1;
+    j["hosts"] = nlohmann::json::object();
+    for (const auto& [host, e] : hosts) {
+      if (!e.active) continue;
+      j["hosts"][host] = {{"selector", e.selector}, {"hits", e.hits}, {"misses", e.misses}, {"learned", e.learned}};
+    }
+    const std::string tmp = cfg.path + ".tmp";
+    try {
+      const auto parent = std::filesystem::path(cfg.path).parent_path();
+      if (!parent.empty()) std::filesystem::create_directories(parent);
+      {
+        std::ofstream out(tmp, std::ios::trunc);
+        out << j.dump(1) << "\n";
+        if (!out) throw std::runtime_error("write failed");
+      }
+      std::filesystem::rename(tmp, cfg.path);
+    } catch (const std::exception& ex) {
+      std::cerr << "[templates] save to " << cfg.path << " failed: " << ex.what() << "\n";
+      return false;
+    }
+    dirty = false;
+    last_save = std::chrono::steady_clock::now();
+    return true;
+  }
+};
+
+TemplateStore::TemplateStore(const TemplateStoreConfig& cfg) : impl_(new Impl()) {
+  impl_->cfg = cfg;
+  if (impl_->cfg.learn_after < 1) impl_->cfg.learn_after = 1;
+  if (impl_->cfg.max_failures < 1) impl_->cfg.max_failures = 1;
+  impl_->load();
+}
+
+TemplateStore::~TemplateStore() {
+  if (!impl_) return;
+  if (impl_->dirty) save();
+  delete impl_;
+}
+
+const TemplateStoreConfig& TemplateStore::config() const { return impl_->cfg; }
+
+std::optional<std::string> TemplateStore::lookup(const std::string& host) const {
+  std::lock_guard<std::mutex> lk(impl_->mu);
+  auto it = impl_->hosts.find(host);
+  if (it == impl_->hosts.end() || !it->second.active) return std::nullopt;
+  return it->second.selector;
+}
+
+void TemplateStore::observe(const std::string& host, const std::string& selector) {
+  if (host.empty() || selector.empty()) return;
+  std::lock_guard<std::mutex> lk(impl_->mu);
+  auto it = impl_->hosts.find(host);
+  if (it == impl_->hosts.end()) {
+    if (impl_->hosts.size() >= kMaxHosts) return;
+    it = impl_->hosts.emplace(host, HostEntry{}).first;
+  }
+  HostEntry& e = it->second;
+  e.learned++;
+  if (e.active) return;   // a single validation miss doesn't retrain; record_miss decides
+  if (e.selector == selector) {
+    e.streak++;
+  } else {
+    e.selector = selector;
+    e.streak = 1;
+  }
+  if (e.streak >= impl_->cfg.learn_after) {
+    e.active = true;
+    e.failures = 0;
+    impl_->dirty = true;
+    std::cerr << "[templates] learned " << host << " -> " << selector << "\n";
+  }
+}
+
+void TemplateStore::record_hit(const std::string& host) {
+  std::lock_guard<std::mutex> lk(impl_->mu);
+  auto it = impl_->hosts.find(host);
+  if (it == impl_->hosts.end()) return;
+  it->second.hits++;
+  it->second.failures = 0;
+  impl_->dirty = true;
+}
+
+void TemplateStore::record_miss(const std::string& host) {
+  std::lock_guard<std::mutex> lk(impl_->mu);
+  auto it = impl_->hosts.find(host);
+  if (it == impl_->hosts.end()) return;
+  HostEntry& e = it->second;
+  e.misses++;
+  impl_->dirty = true;
+  if (e.active && ++e.failures >= impl_->cfg.max_failures) {
+    std::cerr << "[templates] " << host << ": selector failed " << e.failures
+              << " pages in a row, relearning\n";
+    e.active = false;
+    e.streak = 0;
+    e.failures = 0;
+  }
+}
+
+void TemplateStore::save_if_due() {
+  std::lock_guard<std::mutex> lk(impl_->mu);
+  if (!impl_->dirty) return;
+  if (std::chrono::steady_clock::now() - impl_->last_save < std::chrono::seconds(impl_->cfg.save_secs)) return;
+  impl_->save_locked();
+}
+
+bool TemplateStore::save() {
+  std::lock_guard<std::mutex> lk(impl_->mu);
+  return impl_->save_locked();
+}
+
+std::vector<HostTemplateStats> TemplateStore::stats() const {
+  std::vector<HostTemplateStats> out;
+  {
+    std::lock_guard<std::mutex> lk(impl_->mu);
+    out.reserve(impl_->hosts.size());
+    for (const auto& [host, e] : impl_->hosts) {
+      out.push_back(HostTemplateStats{host, e.selector, e.active, e.hits, e.misses, e.learned});
+    }
+  }
+  std::sort(out.begin(), out.end(), [](const HostTemplateStats& a, const HostTemplateStats& b) {
+    return a.hits + a.learned > b.hits + b.learned;
+  });
+  return out;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+
+// AIMD batch sizing against a latency SLO: grow the batch additively while the
+// scorer answers comfortably under the SLO, shrink multiplicatively when a batch
+// overshoots. Latency is smoothed with an EWMA so one slow batch does not collapse
+// the size. Not thread-safe; the owner serializes calls.
+class BatchController {
+ public:
+  BatchController(size_t min_items, size_t max_items, double slo_ms)
+      : min_(std::max<size_t>(1, min_items)), max_(std::max(min_, max_items)),
+        slo_ms_(slo_ms), target_(min_) {}
+
+  size_t target() const { return target_; }
+  double latency_ewma_ms() const { return ewma_ms_; }
+
+  void observe(size_t batch_items, double latency_ms) {
+    ewma_ms_ = (ewma_ms_ <= 0.0) ? latency_ms : (0.8 * ewma_ms_ + 0.2 * latency_ms);
+    if (ewma_ms_ > slo_ms_) {
+      target_ = std::max(min_, (size_t)((double)target_ * 0.7));
+    } else if (ewma_ms_ < 0.8 * slo_ms_ && batch_items >= target_) {
+      // only grow when the batch was actually full, i.e. traffic can use a bigger one
+      target_ = std::min(max_, target_ + std::max<size_t>(1, target_ / 8));
+    }
+  }
+
+ private:
+  size_t min_, max_;
+  double slo_ms_;
+  size_t target_;
+  double ewma_ms_ = 0.0;
+};
@@ -0,0 +1,10 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Leading sentences of `body` that fit in `max_bytes`, split on sentence-final
+// punctuation (skipping decimals and common abbreviations such as "Inc." or "U.S.").
+// If the first sentence alone is too long it is cut at the last space within budget.
+// The scorer truncates to 256 tokens anyway, so sending more bytes is pure overhead.
+std::string scoring_excerpt(std::string_view body, size_t max_bytes);
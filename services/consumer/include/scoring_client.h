@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "news.pb.h"
+
+struct ScoringClientCfg {
+  std::string target = "localhost:50051";
+  size_t min_items = 8;
+  size_t max_items = 64;
+  int max_inflight = 4;          // concurrent BatchScore calls
+  double latency_slo_ms = 250;   // per-batch inference latency target
+  int rpc_timeout_ms = 10000;
+  int max_retries = 2;
+  size_t excerpt_max_bytes = 1200;  // send a bounded excerpt instead of the body (0 = full body)
+};
+
+// One scored item: called from the completion thread, in batch order
+using ScoredSink = std::function<void(const finnews::ArticleEnriched& item, float sentiment,
+                                      float confidence, const std::string& topics_pipe)>;
+
+// Async gRPC client for Scorer.BatchScore. Keeps up to max_inflight batches
+// outstanding on one CompletionQueue, so consumption, inference and production
+// overlap; batch size follows a BatchController fed by observed latency.
+class ScoringClient {
+ public:
+  ScoringClient(const ScoringClientCfg& cfg, ScoredSink sink);
+  ~ScoringClient();
+  ScoringClient(const ScoringClient&) = delete;
+  ScoringClient& operator=(const ScoringClient&) = delete;
+
+  // Sends a batch; blocks while max_inflight calls are outstanding (backpressure).
+  void submit(std::vector<finnews::ArticleEnriched> items);
+  // Blocks until all outstanding calls have completed.
+  void drain();
+
+  size_t target_batch() const;
+  uint64_t batches_ok() const;
+  uint64_t batches_failed() const;
+  double latency_ewma_ms() const;
+
+ private:
+  struct Impl; Impl* impl_;
+};
@@ -0,0 +1,59 @@
+#include "excerpt.h"
+#include <array>
+#include <cctype>
+
+static bool is_abbreviation(std::string_view text, size_t dot) {
+  static const std::array<std::string_view, 16> kAbbrev = {
+    "inc", "corp", "co", "ltd", "llc", "plc", "mr", "mrs", "ms", "dr",
+    "st", "jr", "sr", "vs", "no", "u.s"};
+  size_t b = dot;
+  while (b > 0 && (std::isalpha((unsigned char)text[b - 1]) || text[b - 1] == '.')) --b;
+  std::string_view word = text.substr(b, dot - b);
+  if (word.size() == 1) return true;  // initials: "J. Powell"
+  for (auto a : kAbbrev) {
+    if (word.size() != a.size()) continue;
+    bool eq = true;
+    for (size_t i = 0; i < a.size() && eq; ++i) eq = (std::tolower((unsigned char)word[i]) == a[i]);
+    if (eq) return true;
+  }
+  return false;
+}
+
+// Returns the index just past the sentence starting at `from` (or text.size())
+static size_t next_sentence_end(std::string_view text, size_t from) {
+  for (size_t i = from; i < text.size(); ++i) {
+    char c = text[i];
+    if (c == '\n' && i + 1 < text.size() && text[i + 1] == '\n') return i + 1;  // paragraph break
+    if (c != '.' && c != '!' && c != '?') continue;
+    size_t j = i + 1;
+    while (j < text.size() && (text[j] == '"' || text[j] == '\'' || text[j] == ')')) ++j;
+    if (j >= text.size()) return text.size();
+    if (!std::isspace((unsigned char)text[j])) continue;            // "3.5", "finance.yahoo.com"
+    if (c == '.' && is_abbreviation(text, i)) continue;
+    return j;
+  }
+  return text.size();
+}
+
+std::string scoring_excerpt(std::string_view body, size_t max_bytes) {
+  size_t a = 0;
+  while (a < body.size() && std::isspace((unsigned char)body[a])) ++a;
+  if (body.size() - a <= max_bytes) return std::string(body.substr(a));
+
+  size_t end = a;
+  for (size_t e = next_sentence_end(body, a); e - a <= max_bytes; e = next_sentence_end(body, e)) {
+    end = e;
+    if (e >= body.size()) break;
+  }
+  if (end == a) {
+    // first sentence over budget: cut on a space so UTF-8 sequences stay whole
+    end = a + max_bytes;
+    while (end > a && body[end] != ' ') --end;
+    if (end == a) {
+      end = a + max_bytes;
+      while (end > a && ((unsigned char)body[end] & 0xC0) == 0x80) --end;  // continuation byte
+    }
+  }
+  while (end > a && std::isspace((unsigned char)body[end - 1])) --end;
+  return std::string(body.substr(a, end - a));
+}
@@ -0,0 +1,148 @@
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "scoring_client.h"
+#include "kafka_consumer.h"
+#include "kafka_pub.h"
+#include "config.h"
+#include "news.pb.h"
+
+// news_score: native replacement for services/consumer/main.py.
+// news.enriched -> Scorer.BatchScore (async, several batches in flight) -> news.scored
+// (JSON rows, or finnews.ArticleScored with kafka.output_format: protobuf).
+
+static volatile std::sig_atomic_t g_stop = 0;
+static void handle_sigint(int) { g_stop = 1; }
+
+static long long NowMs() {
+  using namespace std::chrono;
+  return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+int main(int argc, char** argv) {
+  std::signal(SIGINT, handle_sigint);
+  std::signal(SIGTERM, handle_sigint);
+
+  std::string cfg_path = "config/scoring.yml";
+  if (argc >= 2) cfg_path = argv[1];
+
+  fmt::print("[news_score] Loading config: '{}'\n", cfg_path);
+  ScoringConfig cfg = load_scoring_config(cfg_path);
+
+  KafkaConsumerCfg ccfg;
+  ccfg.bootstrap_servers = cfg.kafka.bootstrap_servers;
+  ccfg.group_id = cfg.kafka.group_id;
+  ccfg.topic = cfg.kafka.topic_in;
+  ccfg.auto_offset_reset = "latest";
+  KafkaConsumer consumer(ccfg);
+
+  KafkaConfig pcfg;
+  pcfg.bootstrap_servers = cfg.kafka.bootstrap_servers;
+  pcfg.topic = cfg.kafka.topic_out;
+  KafkaProducer producer(pcfg);
+
+  // JSON rows keep the shape main.py produced (ClickHouse MV + sinks parse it)
+  const bool protobuf_out = cfg.kafka.output_format == "protobuf";
+  auto sink = [&](const finnews::ArticleEnriched& x, float sentiment, float confidence, const std::string& tpipe) {
+    std::set<std::string> topics(x.topics().begin(), x.topics().end());
+    size_t start = 0;
+    while (start < tpipe.size()) {
+      size_t bar = tpipe.find('|', start);
+      std::string t = tpipe.substr(start, bar == std::string::npos ? std::string::npos : bar - start);
+      if (!t.empty()) topics.insert(std::move(t));
+      if (bar == std::string::npos) break;
+      start = bar + 1;
+    }
+    if (protobuf_out) {
+      finnews::ArticleScored out;
+      out.set_id(x.id());
+      for (const auto& t : x.tickers()) out.add_tickers(t);
+      out.set_sentiment(sentiment);
+      for (const auto& t : topics) out.add_topics(t);
+      out.set_confidence(confidence);
+      out.set_scored_ts(NowMs());
+      out.set_source(x.source());
+      out.set_url(x.url());
+      out.set_title(x.title());
+      producer.produce_message(x.id(), out);
+    } else {
+      nlohmann::json out = {
+        {"id", x.id()},
+        {"source", x.source()},
+        {"url", x.url()},
+        {"title", x.title()},
+        {"tickers", std::vector<std::string>(x.tickers().begin(), x.tickers().end())},
+        {"sentiment", sentiment},
+        {"topics", std::vector<std::string>(topics.begin(), topics.end())},
+        {"scored_ts", NowMs()},
+      };
+      std::string bytes = out.dump();
+      producer.produce(x.id(), bytes.data(), bytes.size());
+    }
+  };
+
+  ScoringClientCfg scfg;
+  scfg.target = fmt::format("{}:{}", cfg.grpc.host, cfg.grpc.port);
+  scfg.min_items = (size_t)std::max(1, cfg.batch.min_items);
+  scfg.max_items = (size_t)std::max(1, cfg.batch.max_items);
+  scfg.max_inflight = cfg.batch.max_inflight;
+  scfg.latency_slo_ms = cfg.batch.latency_slo_ms;
+  scfg.rpc_timeout_ms = cfg.grpc.timeout_ms;
+  scfg.excerpt_max_bytes = (size_t)std::max(0, cfg.batch.excerpt_max_bytes);
+  ScoringClient client(scfg, sink);
+
+  fmt::print("[news_score] Ready. Consuming '{}' -> producing '{}' via gRPC {} (inflight={}, slo={}ms)\n",
+             cfg.kafka.topic_in, cfg.kafka.topic_out, scfg.target, scfg.max_inflight, scfg.latency_slo_ms);
+
+  std::vector<finnews::ArticleEnriched> pending;
+  auto first_ts = std::chrono::steady_clock::now();
+  std::string key;
+  const void* payload = nullptr; size_t len = 0;
+  uint64_t consumed = 0, last_report = 0;
+
+  auto flush_pending = [&]() {
+    if (pending.empty()) return;
+    client.submit(std::move(pending));   // blocks only when max_inflight is reached
+    pending.clear();
+    producer.flush(0);                   // serve delivery callbacks
+  };
+
+  while (!g_stop) {
+    if (consumer.poll(key, payload, len, 5) && payload && len > 0) {
+      finnews::ArticleEnriched e;
+      if (!e.ParseFromArray(payload, (int)len)) {
+        fmt::print("[news_score] WARN: failed to parse ArticleEnriched\n");
+      } else {
+        if (pending.empty()) first_ts = std::chrono::steady_clock::now();
+        pending.push_back(std::move(e));
+        ++consumed;
+      }
+    }
+
+    const auto age_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - first_ts).count();
+    if (pending.size() >= client.target_batch() ||
+        (!pending.empty() && age_ms >= cfg.batch.max_wait_ms)) {
+      flush_pending();
+    }
+
+    if (consumed - last_report >= 1000) {
+      last_report = consumed;
+      fmt::print("[news_score] consumed={} batches_ok={} failed={} target_batch={} latency_ewma={:.1f}ms\n",
+                 consumed, client.batches_ok(), client.batches_failed(), client.target_batch(),
+                 client.latency_ewma_ms());
+    }
+  }
+
+  flush_pending();
+  client.drain();
+  producer.flush(2000);
+  fmt::print("[news_score] Stopping.\n");
+  return 0;
+}
@@ -0,0 +1,162 @@
+#include "scoring_client.h"
+#include "batch_controller.h"
+#include "excerpt.h"
+#include "scorer.grpc.pb.h"
+#include <grpcpp/grpcpp.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+struct Call {
+  grpc::ClientContext ctx;
+  finnews::ScoreRequest req;
+  finnews::ScoreResponse resp;
+  grpc::Status status;
+  std::vector<finnews::ArticleEnriched> items;
+  std::chrono::steady_clock::time_point sent;
+  int attempt = 0;
+  std::unique_ptr<grpc::ClientAsyncResponseReader<finnews::ScoreResponse>> rpc;
+};
+
+}  // namespace
+
+struct ScoringClient::Impl {
+  ScoringClientCfg cfg;
+  ScoredSink sink;
+  std::shared_ptr<grpc::Channel> channel;
+  std::unique_ptr<finnews::Scorer::Stub> stub;
+  grpc::CompletionQueue cq;
+  std::thread completer;
+
+  std::mutex mu;
+  std::condition_variable cv;
+  int inflight = 0;
+  BatchController ctl;
+
+  std::atomic<size_t> target{1};
+  std::atomic<uint64_t> ok{0}, failed{0};
+  std::atomic<double> ewma{0.0};
+
+  Impl(const ScoringClientCfg& c, ScoredSink s)
+      : cfg(c), sink(std::move(s)), ctl(c.min_items, c.max_items, c.latency_slo_ms) {
+    target = ctl.target();
+  }
+
+  void start(Call* call) {
+    call->sent = std::chrono::steady_clock::now();
+    call->ctx.set_deadline(std::chrono::system_clock::now() + std::chrono::milliseconds(cfg.rpc_timeout_ms));
+    call->rpc = stub->AsyncBatchScore(&call->ctx, call->req, &cq);
+    call->rpc->Finish(&call->resp, &call->status, call);
+  }
+
+  void finish_one() {
+    std::lock_guard<std::mutex> lk(mu);
+    --inflight;
+    cv.notify_all();
+  }
+
+  void handle(Call* call) {
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - call->sent).count();
+
+    if (!call->status.ok()) {
+      if (call->attempt < cfg.max_retries) {
+        // ClientContext is single-use: move the payload into a fresh call
+        auto* retry = new Call();
+        retry->req = std::move(call->req);
+        retry->items = std::move(call->items);
+        retry->attempt = call->attempt + 1;
+        delete call;
+        start(retry);
+        return;  // still in flight
+      }
+      std::cerr << "[scoring] BatchScore failed (" << call->items.size() << " items): "
+                << call->status.error_message() << "\n";
+      failed++;
+      delete call;
+      finish_one();
+      return;
+    }
+
+    const auto& r = call->resp;
+    const int n = (int)call->items.size();
+    for (int i = 0; i < n; ++i) {
+      float s = i < r.sentiment_size() ? r.sentiment(i) : 0.0f;
+      float c = i < r.confidence_size() ? r.confidence(i) : 0.0f;
+      static const std::string empty;
+      const std::string& t = i < r.topics_size() ? r.topics(i) : empty;
+      sink(call->items[(size_t)i], s, c, t);
+    }
+    ok++;
+
+    {
+      std::lock_guard<std::mutex> lk(mu);
+      ctl.observe((size_t)n, ms);
+      target = ctl.target();
+      ewma = ctl.latency_ewma_ms();
+    }
+    delete call;
+    finish_one();
+  }
+
+  void run_completions() {
+    void* tag = nullptr;
+    bool got = false;
+    while (cq.Next(&tag, &got)) {
+      handle(static_cast<Call*>(tag));
+    }
+  }
+};
+
+ScoringClient::ScoringClient(const ScoringClientCfg& cfg, ScoredSink sink)
+    : impl_(new Impl(cfg, std::move(sink))) {
+  impl_->channel = grpc::CreateChannel(cfg.target, grpc::InsecureChannelCredentials());
+  impl_->stub = finnews::Scorer::NewStub(impl_->channel);
+  impl_->completer = std::thread([this] { impl_->run_completions(); });
+}
+
+ScoringClient::~ScoringClient() {
+  if (impl_) {
+    drain();
+    impl_->cq.Shutdown();
+    if (impl_->completer.joinable()) impl_->completer.join();
+    delete impl_;
+  }
+}
+
+void ScoringClient::submit(std::vector<finnews::ArticleEnriched> items) {
+  if (items.empty()) return;
+  {
+    std::unique_lock<std::mutex> lk(impl_->mu);
+    impl_->cv.wait(lk, [&] { return impl_->inflight < std::max(1, impl_->cfg.max_inflight); });
+    ++impl_->inflight;
+  }
+  auto* call = new Call();
+  call->req.mutable_id()->Reserve((int)items.size());
+  for (const auto& it : items) {
+    call->req.add_id(it.id());
+    call->req.add_title(it.title());
+    if (impl_->cfg.excerpt_max_bytes > 0) {
+      call->req.add_body(std::string());
+      call->req.add_excerpt(scoring_excerpt(it.body(), impl_->cfg.excerpt_max_bytes));
+    } else {
+      call->req.add_body(it.body());
+    }
+  }
+  call->items = std::move(items);
+  impl_->start(call);
+}
+
+void ScoringClient::drain() {
+  std::unique_lock<std::mutex> lk(impl_->mu);
+  impl_->cv.wait(lk, [&] { return impl_->inflight == 0; });
+}
+
+size_t ScoringClient::target_batch() const { return impl_->target.load(); }
+uint64_t ScoringClient::batches_ok() const { return impl_->ok.load(); }
+uint64_t ScoringClient::batches_failed() const { return impl_->failed.load(); }
+double ScoringClient::latency_ewma_ms() const { return impl_->ewma.load(); }
@@ -0,0 +1,50 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "aho_corasick.h"
+#include "topic_tagger.h"
+
+struct TickerInfo {
+  std::string symbol;                // "AAPL"
+  std::string name;                  // "Apple Inc"
+  std::vector<std::string> aliases;  // name first, then csv aliases (deduped)
+};
+
+// Loads data/tickers.csv (symbol,name,aliases with ';'-separated aliases)
+std::vector<TickerInfo> load_tickers_csv(const std::string& path);
+
+struct ResolveResult {
+  std::vector<std::string> tickers;   // kept symbols, best score first
+  std::vector<std::string> entities;  // alias mentions as they appear in the text
+  std::vector<std::string> topics;    // rule-based topic tags (sorted)
+};
+
+// Native port of services/entity/main.py scoring. Symbols, aliases and the
+// config/topics.yml keywords are compiled into a single automaton and title/body
+// are each scanned once.
+// Immutable after construction, so one instance is shared by all worker threads.
+class TickerResolver {
+ public:
+  TickerResolver(std::vector<TickerInfo> tickers, const std::vector<TopicRule>& topic_rules,
+                 double min_score, int max_tickers);
+
+  ResolveResult resolve(const std::string& title, const std::string& body,
+                        const std::vector<std::string>& hints) const;
+
+  size_t ticker_count() const { return tickers_.size(); }
+
+ private:
+  enum class Kind : uint8_t { Symbol, Alias, Topic };
+  struct PatternRef {
+    Kind kind;
+    int index;   // ticker index (Symbol/Alias) or topic index (Topic)
+  };
+
+  std::vector<TickerInfo> tickers_;
+  std::vector<std::string> topic_names_;
+  std::vector<uint8_t> topic_whole_word_;
+  std::vector<PatternRef> refs_;        // by pattern id
+  AhoCorasick ac_;
+  double min_score_;
+  int max_tickers_;
+};
@@ -12,6 +12,15 @@ import news_pb2
 
 CASHTAG_RE = re.compile(r'\$([A-Z]{1,5})\b')
 
+# Compiled topic tagger shared with news_entity/scorer (built as finnews_topics by CMake).
+# Falls back to the inline keyword rules below when the extension is not built.
+sys.path.append(os.environ.get("FINNEWS_NATIVE_DIR", "build"))
+try:
+    import finnews_topics
+    TOPIC_TAGGER = finnews_topics.TopicTagger(os.path.join("config", "topics.yml"))
+except Exception:
+    TOPIC_TAGGER = None
+
 def load_config(path: str) -> dict:
     with open(path, "r") as f:
         return yaml.safe_load(f)
@@ -78,10 +87,17 @@ def score_ticker(symbol: str, title: str, body: str, hints: List[str], detected_
                 domain_boost = 1.0
     s += domain_boost
 
+    # source context: the item was listed by this symbol's feed ("ticker:" hints
+    # from news_clean, one per merged source)
+    if hints and ("ticker:" + symbol) in hints:
+        s += 1.0
+
     # NER match added separately by resolver()
     return s
 
 def topic_rules(title: str, body: str) -> List[str]:
+    if TOPIC_TAGGER is not None:
+        return TOPIC_TAGGER.tag(title or "", body or "")
     t = (title or "").lower()
     b = (body or "").lower()
     topics = set()
@@ -0,0 +1,120 @@
+#include <fmt/core.h>
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ticker_resolver.h"
+#include "work_queue.h"
+#include "kafka_consumer.h"
+#include "kafka_pub.h"
+#include "config.h"
+#include "news.pb.h"
+
+// news_entity: native replacement for the hot path of services/entity/main.py.
+// news.clean -> ticker/alias/topic matching (one automaton pass) -> news.enriched.
+// spaCy NER stays available through the Python service as an optional slow path.
+
+static volatile std::sig_atomic_t g_stop = 0;
+static void handle_sigint(int) { g_stop = 1; }
+
+int main(int argc, char** argv) {
+  std::signal(SIGINT, handle_sigint);
+  std::signal(SIGTERM, handle_sigint);
+
+  std::string cfg_path = "config/entity.yml";
+  if (argc >= 2) cfg_path = argv[1];
+
+  fmt::print("[news_entity] Loading config: '{}'\n", cfg_path);
+  EntityConfig cfg = load_entity_config(cfg_path);
+
+  auto topic_rules = load_topic_rules(cfg.resolver.topics_yml);
+  TickerResolver resolver(load_tickers_csv(cfg.resolver.tickers_csv), topic_rules,
+                          cfg.resolver.min_score, cfg.resolver.max_tickers);
+  fmt::print("[news_entity] Compiled {} tickers from {} and {} topic rules from {}\n",
+             resolver.ticker_count(), cfg.resolver.tickers_csv, topic_rules.size(), cfg.resolver.topics_yml);
+
+  KafkaConsumerCfg ccfg;
+  ccfg.bootstrap_servers = cfg.kafka.bootstrap_servers;
+  ccfg.group_id = cfg.kafka.group_id;
+  ccfg.topic = cfg.kafka.topic_in;
+  ccfg.auto_offset_reset = "latest";
+  KafkaConsumer consumer(ccfg);
+
+  KafkaConfig pcfg;
+  pcfg.bootstrap_servers = cfg.kafka.bootstrap_servers;
+  pcfg.topic = cfg.kafka.topic_out;
+  pcfg.acks = cfg.kafka.acks;
+  pcfg.linger_ms = cfg.kafka.linger_ms;
+  pcfg.batch_num_messages = cfg.kafka.batch_num_messages;
+  pcfg.profile = cfg.kafka.producer_profile;
+  pcfg.compression = cfg.kafka.compression;
+  KafkaProducer producer(pcfg);
+
+  WorkQueue<std::string> queue((size_t)std::max(1, cfg.resolver.queue_capacity));
+  std::atomic<uint64_t> processed{0}, parse_errors{0};
+
+  auto worker = [&]() {
+    std::string bytes;
+    finnews::ArticleClean clean;
+    finnews::ArticleEnriched enriched;
+    std::vector<std::string> hints;
+    while (queue.pop(bytes)) {
+      if (!clean.ParseFromString(bytes)) { parse_errors++; continue; }
+
+      hints.assign(clean.hints().begin(), clean.hints().end());
+      ResolveResult r = resolver.resolve(clean.title(), clean.body(), hints);
+
+      enriched.Clear();
+      enriched.set_id(clean.id());
+      enriched.set_title(clean.title());
+      enriched.set_body(clean.body());
+      enriched.set_published_ts(clean.published_ts());
+      for (auto& t : r.tickers) enriched.add_tickers(t);
+      for (auto& e : r.entities) enriched.add_entities(e);
+      for (auto& t : r.topics) enriched.add_topics(t);
+      enriched.set_source(clean.source());
+      enriched.set_url(clean.url());
+
+      if (!producer.produce_message(clean.id(), enriched)) {
+        fmt::print("[news_entity] ERROR: failed to produce ArticleEnriched id={}\n", clean.id());
+        continue;
+      }
+      processed++;
+    }
+  };
+
+  const int nworkers = std::max(1, cfg.resolver.workers);
+  std::vector<std::thread> workers;
+  for (int i = 0; i < nworkers; ++i) workers.emplace_back(worker);
+
+  fmt::print("[news_entity] Ready. Consuming '{}' -> producing '{}' with {} workers\n",
+             cfg.kafka.topic_in, cfg.kafka.topic_out, nworkers);
+
+  std::string key;
+  const void* payload = nullptr; size_t len = 0;
+  uint64_t last_report = 0;
+
+  while (!g_stop) {
+    if (!consumer.poll(key, payload, len, 200)) { producer.flush(0); continue; }
+    if (!payload || len == 0) continue;
+    queue.push(std::string((const char*)payload, len));
+    producer.poll(0);   // delivery reports recycle payload buffers
+
+    uint64_t done = processed.load();
+    if (done - last_report >= 1000) {
+      last_report = done;
+      const auto ks = producer.stats();
+      fmt::print("[news_entity] processed={} parse_errors={} kafka[delivered={} failed={} avg={:.1f}ms p99<={:.1f}ms]\n",
+                 done, parse_errors.load(), ks.delivered, ks.failed, ks.avg_latency_ms, ks.p99_latency_ms);
+    }
+  }
+
+  queue.close();
+  for (auto& t : workers) t.join();
+  producer.flush(2000);
+  fmt::print("[news_entity] Stopping.\n");
+  return 0;
+}
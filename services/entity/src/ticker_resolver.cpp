@@ -0,0 +1,186 @@
+#include "ticker_resolver.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_set>
+
+static std::string trim(const std::string& s) {
+  size_t a = 0, b = s.size();
+  while (a < b && std::isspace((unsigned char)s[a])) ++a;
+  while (b > a && std::isspace((unsigned char)s[b-1])) --b;
+  return s.substr(a, b-a);
+}
+
+// Minimal RFC4180 field splitter (quoted fields, "" escapes)
+static std::vector<std::string> split_csv_line(const std::string& line) {
+  std::vector<std::string> out;
+  std::string cur;
+  bool quoted = false;
+  for (size_t i = 0; i < line.size(); ++i) {
+    char c = line[i];
+    if (quoted) {
+      if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') { cur.push_back('"'); ++i; }
+      else if (c == '"') quoted = false;
+      else cur.push_back(c);
+    } else if (c == '"') {
+      quoted = true;
+    } else if (c == ',') {
+      out.push_back(std::move(cur)); cur.clear();
+    } else if (c != '\r') {
+      cur.push_back(c);
+    }
+  }
+  out.push_back(std::move(cur));
+  return out;
+}
+
+std::vector<TickerInfo> load_tickers_csv(const std::string& path) {
+  std::ifstream in(path);
+  if (!in) throw std::runtime_error("tickers csv not found: " + path);
+
+  std::string line;
+  if (!std::getline(in, line)) return {};
+  auto header = split_csv_line(line);
+  auto col = [&](const char* name) -> int {
+    for (size_t i = 0; i < header.size(); ++i) if (trim(header[i]) == name) return (int)i;
+    return -1;
+  };
+  const int c_sym = col("symbol"), c_name = col("name"), c_alias = col("aliases");
+  if (c_sym < 0) throw std::runtime_error("tickers csv missing 'symbol' column: " + path);
+
+  std::vector<TickerInfo> out;
+  while (std::getline(in, line)) {
+    if (trim(line).empty()) continue;
+    auto f = split_csv_line(line);
+    auto field = [&](int c) { return (c >= 0 && c < (int)f.size()) ? trim(f[(size_t)c]) : std::string(); };
+
+    TickerInfo t;
+    t.symbol = field(c_sym);
+    std::transform(t.symbol.begin(), t.symbol.end(), t.symbol.begin(), [](unsigned char c){ return std::toupper(c); });
+    if (t.symbol.empty()) continue;
+    t.name = field(c_name);
+    if (!t.name.empty()) t.aliases.push_back(t.name);
+    std::string aliases = field(c_alias);
+    size_t start = 0;
+    while (start <= aliases.size()) {
+      size_t semi = aliases.find(';', start);
+      std::string a = trim(aliases.substr(start, semi == std::string::npos ? std::string::npos : semi - start));
+      if (!a.empty() && std::find(t.aliases.begin(), t.aliases.end(), a) == t.aliases.end()) t.aliases.push_back(a);
+      if (semi == std::string::npos) break;
+      start = semi + 1;
+    }
+    out.push_back(std::move(t));
+  }
+  return out;
+}
+
+TickerResolver::TickerResolver(std::vector<TickerInfo> tickers, const std::vector<TopicRule>& topic_rules,
+                               double min_score, int max_tickers)
+    : tickers_(std::move(tickers)), min_score_(min_score), max_tickers_(max_tickers) {
+  for (size_t i = 0; i < tickers_.size(); ++i) {
+    ac_.add(tickers_[i].symbol);
+    refs_.push_back({Kind::Symbol, (int)i});
+    for (const auto& a : tickers_[i].aliases) {
+      ac_.add(a);
+      refs_.push_back({Kind::Alias, (int)i});
+    }
+  }
+  // topic keywords share the automaton so title/body are still scanned once
+  for (size_t t = 0; t < topic_rules.size(); ++t) {
+    topic_names_.push_back(topic_rules[t].name);
+    topic_whole_word_.push_back(topic_rules[t].whole_word ? 1 : 0);
+    for (const auto& kw : topic_rules[t].keywords) {
+      if (kw.empty()) continue;
+      ac_.add(kw);
+      refs_.push_back({Kind::Topic, (int)t});
+    }
+  }
+  ac_.build();
+}
+
+// "$AAPL" style cashtags, same as CASHTAG_RE = r'\$([A-Z]{1,5})\b'
+static void scan_cashtags(const std::string& text, std::unordered_set<std::string>& out) {
+  auto word = [](unsigned char c) { return std::isalnum(c) || c == '_'; };
+  for (size_t i = text.find('$'); i != std::string::npos; i = text.find('$', i + 1)) {
+    size_t j = i + 1;
+    while (j < text.size() && j - i <= 5 && std::isupper((unsigned char)text[j])) ++j;
+    size_t n = j - i - 1;
+    if (n < 1 || n > 5) continue;
+    if (j < text.size() && word((unsigned char)text[j])) continue;
+    out.insert(text.substr(i + 1, n));
+  }
+}
+
+ResolveResult TickerResolver::resolve(const std::string& title, const std::string& body,
+                                      const std::vector<std::string>& hints) const {
+  const size_t n = tickers_.size();
+  std::vector<uint8_t> in_title(n, 0), alias_seen(n, 0);
+  std::vector<uint8_t> topic_hit(topic_names_.size(), 0);
+  std::vector<std::string> entities;
+  std::unordered_set<std::string> entity_seen;
+
+  auto on_match = [&](const std::string& text, bool is_title) {
+    return [&, is_title](int id, size_t b, size_t e) {
+      const PatternRef& r = refs_[(size_t)id];
+      if (r.kind == Kind::Topic) {
+        if (!topic_whole_word_[(size_t)r.index] || is_word_match(text, b, e)) topic_hit[(size_t)r.index] = 1;
+        return;
+      }
+      if (!is_word_match(text, b, e)) return;
+      if (is_title) in_title[(size_t)r.index] = 1;
+      if (r.kind == Kind::Alias) {
+        alias_seen[(size_t)r.index] = 1;
+        std::string surface = text.substr(b, e - b);
+        if (entity_seen.insert(surface).second) entities.push_back(std::move(surface));
+      }
+    };
+  };
+  ac_.scan(title, on_match(title, true));
+  ac_.scan(body, on_match(body, false));
+
+  std::unordered_set<std::string> cashtags;
+  scan_cashtags(title, cashtags);
+  scan_cashtags(body, cashtags);
+
+  // domain prior, as in score_ticker(): investor-relations hosts boost every symbol.
+  // Source prior: "ticker:" hints name the symbols whose feeds listed the item.
+  std::vector<std::string> hosts;
+  std::unordered_set<std::string> sources;
+  for (const auto& h : hints) {
+    if (h.rfind("host:", 0) == 0) hosts.push_back(h.substr(5));
+    else if (h.rfind("ticker:", 0) == 0) sources.insert(h.substr(7));
+  }
+
+  std::vector<std::pair<std::string, double>> scored;
+  for (size_t i = 0; i < n; ++i) {
+    const TickerInfo& t = tickers_[i];
+    double s = 0.0;
+    if (cashtags.count(t.symbol)) s += 2.0 + 2.0;  // pre-seed + score_ticker cashtag term, as in main.py
+    if (in_title[i]) s += 1.5;
+    if (alias_seen[i]) s += 1.0;                   // alias mention stands in for the spaCy ORG match
+    if (sources.count(t.symbol)) s += 1.0;
+    if (!hosts.empty()) {
+      std::string low_sym = t.symbol;
+      std::transform(low_sym.begin(), low_sym.end(), low_sym.begin(), [](unsigned char c){ return std::tolower(c); });
+      for (const auto& host : hosts) {
+        bool com = host.size() >= 4 && host.compare(host.size() - 4, 4, ".com") == 0;
+        if (host.find("ir.") != std::string::npos || host.find("investor") != std::string::npos ||
+            (com && host.find(low_sym) != std::string::npos)) { s += 1.0; break; }
+      }
+    }
+    if (s >= min_score_) scored.emplace_back(t.symbol, s);
+  }
+  std::stable_sort(scored.begin(), scored.end(), [](auto& a, auto& b){ return a.second > b.second; });
+
+  ResolveResult out;
+  for (auto& [sym, s] : scored) {
+    if ((int)out.tickers.size() >= max_tickers_) break;
+    out.tickers.push_back(sym);
+  }
+  out.entities = std::move(entities);
+  for (size_t t = 0; t < topic_names_.size(); ++t) if (topic_hit[t]) out.topics.push_back(topic_names_[t]);
+  std::sort(out.topics.begin(), out.topics.end());
+  out.topics.erase(std::unique(out.topics.begin(), out.topics.end()), out.topics.end());
+  return out;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "dedup.h"
+#include "event_loop.h"
+
+// dedup_setnx() without the blocking round trip: SET NX EX over one hiredis async
+// connection driven by the EventLoop. Commands issued in the same loop iteration go
+// out as one pipelined write. Fails open (reports "new") when Redis is unreachable,
+// like dedup_setnx; a dropped connection is re-established on the next call. So is
+// one that leaves a command unanswered for cfg.command_timeout_ms.
+//
+// Two-phase use (cfg.reserve_seconds > 0): setnx() only reserves the key for
+// reserve_seconds; confirm() extends it to ttl_seconds once the item is safely
+// published, release() drops it so the item can be retried. An item lost before
+// confirmation (failed produce, crash) reappears when its reservation lapses.
+class AsyncDedup {
+public:
+  using DoneFn = std::function<void(bool is_new)>;
+
+  AsyncDedup(EventLoop& loop, const DedupConfig& cfg);
+  ~AsyncDedup();
+  AsyncDedup(const AsyncDedup&) = delete;
+  AsyncDedup& operator=(const AsyncDedup&) = delete;
+
+  void setnx(const std::string& key, DoneFn done);
+  // Batched: one command per key, all in the same pipelined write. Best effort; a
+  // key that isn't confirmed simply expires with its reservation.
+  void confirm(const std::vector<std::string>& keys);
+  void release(const std::vector<std::string>& keys);
+  size_t pending() const;
+
+private:
+  struct Impl;
+  Impl* impl_;
+};
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+
+#include "event_loop.h"
+#include "http_fetch.h"
+
+// Non-blocking GETs on an EventLoop (curl multi socket-action API). Connections are
+// kept alive across requests; transfers beyond the connection limits queue inside
+// curl. Callbacks run on the loop thread.
+class AsyncHttp {
+public:
+  using DoneFn = std::function<void(std::optional<HttpResponse>)>;
+  using ChunkFn = std::function<bool(const char*, size_t)>;
+
+  AsyncHttp(EventLoop& loop, long max_connections, long max_host_connections);
+  ~AsyncHttp();
+  AsyncHttp(const AsyncHttp&) = delete;
+  AsyncHttp& operator=(const AsyncHttp&) = delete;
+
+  // Buffers the body, like http_get(). nullopt on transport errors.
+  void get(const std::string& url, const HttpOptions& opt, DoneFn done);
+  // Streams a 2xx body to on_chunk, like http_get_stream(); returning false stops the
+  // transfer (not an error) and the response body is empty.
+  void get_stream(const std::string& url, const HttpOptions& opt, ChunkFn on_chunk, DoneFn done);
+
+  size_t in_flight() const;
+
+private:
+  struct Impl;
+  Impl* impl_;
+};
@@ -6,9 +6,21 @@
 struct AppKafka {
   std::string bootstrap_servers;
   std::string topic_raw;
+  std::string topic_clean;
   std::string acks;
   int linger_ms;
   int batch_num_messages;
+  std::string producer_profile;      // "throughput" | "latency" | "" (see KafkaConfig)
+  std::string compression;           // overrides the profile's codec
+  bool idempotence = false;
+  int queue_full_max_wait_ms = 5000;
+
+  // on-disk spool for messages the broker can't take (one subdirectory per topic)
+  bool spool_enable = true;
+  std::string spool_dir = "data/spool";
+  int spool_segment_mb = 64;
+  int spool_max_mb = 1024;
+  int spool_sync_ms = 1000;
 };
 
 struct AppRedis {
@@ -16,12 +28,72 @@ struct AppRedis {
   int port;
   int db;
   int dedup_ttl_seconds;
+  // news_gw reserves a URL for this long before publishing and extends it to
+  // dedup_ttl_seconds once Kafka confirms delivery (0 = mark seen up front)
+  int dedup_reserve_seconds = 600;
+  int command_timeout_ms = 2000;   // news_gw: a reply later than this fails open
 };
 
 struct AppIngest {
   int interval_secs;
   std::string user_agent;
   int http_timeout_secs;
+  bool streaming_parse = true;   // push-parse feeds and scan Yahoo pages while downloading
+  int max_items_per_feed = 0;    // stop a feed transfer after N items (0 = all)
+  int max_concurrent_fetches = 64; // open connections across all feeds (event loop)
+  int max_host_connections = 6;    // per host; the rest queue in curl
+  int parse_threads = 2;           // workers for buffered feed / Yahoo HTML parsing
+  std::string parse_pinning = "none"; // none|cores|numa (see task_sched.h)
+  // per-feed state (see feed_state.h), snapshotted so a restart resumes where it left off
+  std::string state_path = "data/gw_state.bin"; // "" = no snapshot (cold start every time)
+  int state_snapshot_secs = 30;
+  int max_interval_factor = 8;     // a feed with nothing new slows to interval_secs * this
+  int max_backoff_secs = 1800;     // cap for the per-feed error backoff
+  int high_water_slack_secs = 3600; // items older than a feed's newest-seen minus this are skipped
+};
+
+// news_gw scale-out: feeds split across instances via Redis leases (see feed_shard.h)
+struct AppShard {
+  bool enable = false;
+  std::string instance_id;        // empty = <hostname>-<pid>
+  std::string members_key = "gw:members";
+  int lease_ttl_secs = 15;
+  int vnodes = 64;
+};
+
+struct AppCleaner {
+  bool require_english = true;
+  int min_body_chars = 200;
+  int http_timeout_secs = 10;
+  std::string user_agent = "FinNewsBot/1.0";
+
+  // work budget for pathological pages
+  int max_body_bytes = 4194304;        // download cap enforced while streaming
+  bool require_html_content_type = true;
+  int max_dom_bytes = 1572864;         // larger pages skip the DOM and use the fast scanner
+  int max_dom_nodes = 30000;
+  int structured_min_body_chars = 200; // JSON-LD articleBody this long skips the DOM (0 = off)
+  bool streaming = true;               // push-parse pages while downloading
+  int stop_after_article_chars = 0;    // stop transfer after first <article> with this much text (0 = off)
+
+  // fetch + extract run on a work-stealing scheduler; near-dup and produce stay on the main thread
+  int workers = 4;                     // extraction (CPU) workers
+  int fetch_threads = 32;              // blocking page downloads, kept off the extraction workers
+  int max_in_flight = 32;              // messages being fetched/extracted at once
+  std::string cpu_pinning = "none";    // none|cores|numa
+
+  // near-duplicate detection (SimHash + banded LSH)
+  bool near_dup_enable = true;
+  std::string near_dup_action = "tag";   // "tag" (set cluster_id) or "drop"
+  int near_dup_max_hamming = 3;
+  int near_dup_window_secs = 21600;
+  int near_dup_max_entries = 200000;
+
+  // per-host content selectors learned from the extraction heuristic
+  bool templates_enable = true;
+  std::string templates_path = "data/clean_templates.json";
+  int templates_learn_after = 5;         // same container on this many pages in a row
+  int templates_max_failures = 3;        // validation failures in a row before relearning
 };
 
 struct Feed {
@@ -45,14 +117,179 @@ struct YahooConfig {
   std::string robots_url;
   int min_seconds_between_requests = 10;
   int max_links_per_page = 30;
+  std::string html_mode = "json";   // json (embedded news stream, anchors as fallback) | anchors
+};
+
+// news_gw fetch health: host circuit breakers and adaptive timeouts (see feed_health.h)
+struct AppHealth {
+  int breaker_failures = 3;        // consecutive failures before a feed backs off / a host's breaker opens
+  int breaker_base_secs = 30;      // first open period; doubles per failed probe
+  int breaker_max_secs = 1800;
+  double jitter = 0.2;             // open periods and feed backoffs are randomized by +-20%
+  double timeout_p99_factor = 2.0; // adaptive timeout = host p99 * this, capped at ingest.http_timeout_secs
+  int timeout_min_ms = 2000;
+  int timeout_min_samples = 20;
+};
+
+// news_gw /metrics (Prometheus) and /health (JSON) endpoint
+struct AppMetrics {
+  bool enable = true;
+  std::string bind = "127.0.0.1";
+  int port = 9108;
 };
 
 struct AppConfig {
   AppKafka kafka;
   AppRedis redis;
   AppIngest ingest;
+  AppCleaner cleaner;
   YahooConfig yahoo;
+  AppShard shard;
+  AppHealth health;
+  AppMetrics metrics;
+};
+
+// config/entity.yml (news_entity)
+struct EntityKafka {
+  std::string bootstrap_servers;
+  std::string group_id = "news-entity";
+  std::string topic_in = "news.clean";
+  std::string topic_out = "news.enriched";
+  std::string acks = "all";
+  int linger_ms = 5;
+  int batch_num_messages = 10000;
+  std::string producer_profile;
+  std::string compression;
+};
+
+struct EntityResolver {
+  std::string tickers_csv = "data/tickers.csv";
+  std::string topics_yml = "config/topics.yml";
+  double min_score = 2.0;
+  int max_tickers = 5;
+  int workers = 4;             // resolver threads
+  int queue_capacity = 1024;   // messages buffered between consumer and workers
+};
+
+struct EntityConfig {
+  EntityKafka kafka;
+  EntityResolver resolver;
+};
+
+// config/scoring.yml (news_score)
+struct ScoringKafka {
+  std::string bootstrap_servers;
+  std::string topic_in = "news.enriched";
+  std::string topic_out = "news.scored";
+  std::string group_id = "scoring-consumer";
+  std::string output_format = "json";   // or "protobuf" (finnews.ArticleScored)
+};
+
+struct ScoringGrpc {
+  std::string host = "localhost";
+  int port = 50051;
+  int timeout_ms = 10000;
+};
+
+struct ScoringBatch {
+  int max_items = 64;          // upper bound for the adaptive batch size
+  int min_items = 8;
+  int max_wait_ms = 30;        // flush a partial batch after this long
+  int max_inflight = 4;        // concurrent BatchScore calls
+  double latency_slo_ms = 250; // adaptive sizing target per batch
+  int excerpt_max_bytes = 1200; // title + leading sentences sent to the scorer (0 = full body)
+};
+
+struct ScoringConfig {
+  ScoringKafka kafka;
+  ScoringGrpc grpc;
+  ScoringBatch batch;
+};
+
+// config/sinks.yml (news_sink_parquet)
+struct SinksKafka {
+  std::string bootstrap_servers;
+  std::string topic_scored = "news.scored";
+  std::string group_id_parquet = "sink-parquet";
+};
+
+struct SinksParquet {
+  std::string root_dir = "archive/news";
+  std::string topic;                    // empty = kafka.topic_scored
+  std::string input_format = "scored_json"; // or "enriched_pb" (news.enriched)
+  int row_group_rows = 8192;            // rows buffered in Arrow builders per row group
+  int max_file_mb = 128;                // roll when the open file reaches this size
+  int roll_secs = 300;                  // ... or has been open this long
+  std::string compression = "zstd";     // zstd | snappy | lz4 | gzip | none
+};
+
+struct SinksClickHouse {
+  std::string url = "http://localhost:8123";
+  std::string database = "default";
+  std::string table = "news_scored";
+  std::string user;
+  std::string password;
+  std::string group_id = "sink-clickhouse";
+  std::string topic;                    // empty = kafka.topic_scored
+  std::string input_format = "scored_json"; // or "scored_pb"
+  int max_rows = 50000;                 // insert when the block has this many rows ...
+  int max_wait_ms = 1000;               // ... or is this old
+  int timeout_secs = 30;
+  int max_retries = 5;                  // per attempt round; the block is kept and retried after
+  int retry_backoff_ms = 200;           // doubled per retry
+};
+
+struct SinksConfig {
+  SinksKafka kafka;
+  SinksParquet parquet;
+  SinksClickHouse clickhouse;
+};
+
+// config/loadgen.yml (news_loadgen)
+struct LoadgenServer {
+  std::string bind = "127.0.0.1";
+  int port = 8088;
+  int threads = 16;                  // concurrent connections served
+};
+
+struct LoadgenContent {
+  int feeds = 100;                   // /feed/<n>.xml for n in [0, feeds)
+  std::string feed_format = "rss";   // rss | atom | mixed
+  int items_per_feed = 20;           // newest items listed per feed response
+  double items_per_sec = 50;         // new articles across all feeds
+  double duplicate_ratio = 0.1;      // new items that re-list another feed's article URL
+  int page_bytes = 20000;            // article HTML size
+  double page_bytes_jitter = 0.5;    // +/- fraction
+};
+
+struct LoadgenFaults {
+  double latency_median_ms = 40;     // lognormal response delay
+  double latency_sigma = 0.6;
+  double error_429_ratio = 0.01;
+  double error_5xx_ratio = 0.01;
+};
+
+struct LoadgenMeasure {
+  bool enable = true;                // consume topic and report end-to-end latency
+  std::string bootstrap_servers = "localhost:9092";
+  std::string topic = "news.clean";
+  int report_secs = 10;
+};
+
+struct LoadgenConfig {
+  LoadgenServer server;
+  LoadgenContent content;
+  LoadgenFaults faults;
+  LoadgenMeasure measure;
 };
 
 AppConfig load_app_config(const std::string& path);
 RssConfig load_rss_config(const std::string& path);
+EntityConfig load_entity_config(const std::string& path);
+ScoringConfig load_scoring_config(const std::string& path);
+SinksConfig load_sinks_config(const std::string& path);
+LoadgenConfig load_loadgen_config(const std::string& path);
+
+// Sanity checks for configs loaded at runtime (hot reload); empty = valid.
+std::vector<std::string> validate_app_config(const AppConfig& c);
+std::vector<std::string> validate_rss_config(const RssConfig& c);
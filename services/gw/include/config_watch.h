@@ -0,0 +1,19 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Reload trigger for long-running services: SIGHUP, or an inotify event on any of
+// the watched files. The parent directories are watched (editors and config
+// management usually replace files by rename), filtered by file name.
+class ConfigWatcher {
+public:
+  explicit ConfigWatcher(const std::vector<std::string>& paths);
+  ~ConfigWatcher();
+
+  // Non-blocking; true once per SIGHUP or batch of file changes since the last call.
+  bool poll();
+
+private:
+  struct Impl;
+  Impl* impl_;
+};
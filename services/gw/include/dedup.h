@@ -6,6 +6,8 @@ struct DedupConfig {
   int port = 6379;
   int db = 0;
   int ttl_seconds = 172800;
+  int reserve_seconds = 0;   // AsyncDedup: setnx only reserves for this long (0 = ttl_seconds)
+  int command_timeout_ms = 2000;   // AsyncDedup: no reply by then drops the connection (0 = wait)
 };
 
 // returns true if key was newly set (i.e., NOT a duplicate)
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+
+// Single-threaded epoll reactor for news_gw. Fd readiness, one-shot timers and
+// post()ed work all run on the thread that calls run_once(); only post() may be
+// called from other threads (parse workers hand results back through it).
+class EventLoop {
+public:
+  using FdFn = std::function<void(uint32_t events)>;   // EPOLLIN/EPOLLOUT/EPOLLERR/EPOLLHUP
+  using TimerId = uint64_t;
+
+  EventLoop();
+  ~EventLoop();
+  EventLoop(const EventLoop&) = delete;
+  EventLoop& operator=(const EventLoop&) = delete;
+
+  // Registers or re-arms `fd` for `events` (level-triggered). Replaces any previous callback.
+  void watch(int fd, uint32_t events, FdFn fn);
+  void unwatch(int fd);
+
+  // One-shot timer on the steady clock; ids are never reused, cancel is a no-op once fired.
+  TimerId add_timer(int64_t delay_ms, std::function<void()> fn);
+  void cancel_timer(TimerId id);
+
+  // Thread-safe: runs `fn` on the loop thread at the next iteration.
+  void post(std::function<void()> fn);
+
+  // Waits up to max_wait_ms (less if a timer is due) and dispatches what is ready.
+  // Returns early on a signal, so callers can check their stop flag.
+  void run_once(int max_wait_ms);
+
+  static int64_t now_ms();   // steady clock
+
+private:
+  struct Impl;
+  Impl* impl_;
+};
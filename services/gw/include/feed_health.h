@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct HealthConfig {
+  int breaker_failures = 3;          // consecutive failures that open a host's breaker
+  int64_t breaker_base_ms = 30000;   // first open period; doubles with every failed probe
+  int64_t breaker_max_ms = 1800000;
+  double jitter = 0.2;               // open periods are scaled by a random factor in [1-j, 1+j]
+  double ewma_alpha = 0.2;           // weight of the newest latency sample
+  // Adaptive timeout: once a host has timeout_min_samples successful fetches, its
+  // requests time out after p99 * timeout_p99_factor, within [timeout_min_ms, the
+  // configured http timeout]
+  double timeout_p99_factor = 2.0;
+  int64_t timeout_min_ms = 2000;
+  int timeout_min_samples = 20;
+};
+
+enum class BreakerState { Closed, Open, HalfOpen };
+
+struct HealthRow {
+  std::string key;                   // feed URL or host
+  std::string host;                  // feeds: their host
+  uint64_t successes = 0;
+  uint64_t failures = 0;
+  int consecutive_failures = 0;
+  double ewma_ms = 0;                // latency of completed fetches (success or not)
+  double p99_ms = 0;                 // hosts: over the last successful fetches
+  std::vector<int> history;          // newest last: HTTP status, 0 = transport error/timeout
+  // hosts only
+  BreakerState breaker = BreakerState::Closed;
+  int64_t open_for_ms = 0;           // remaining open time
+  int64_t timeout_ms = 0;            // adaptive timeout (0 = configured default)
+};
+
+// Fetch health per feed and per host for news_gw. Failures (transport errors,
+// timeouts, 429 and 5xx) on a host count towards its circuit breaker: after
+// breaker_failures in a row it opens and that host's feeds are skipped; when the
+// (jittered, exponentially growing) open period ends one fetch is let through as a
+// probe, which closes the breaker on success or reopens it for twice as long.
+// Successful fetches feed the host's latency window, from which its timeout adapts,
+// so a slow or dead host stops costing the full http timeout every cycle.
+// In-memory only; not thread-safe (the gw event loop owns it).
+class HealthTable {
+public:
+  explicit HealthTable(const HealthConfig& cfg);
+  ~HealthTable();
+  HealthTable(const HealthTable&) = delete;
+  HealthTable& operator=(const HealthTable&) = delete;
+
+  // Whether a fetch to `host` may start now. While half-open this hands out the single
+  // probe; the caller must report its outcome through record().
+  bool allow(const std::string& host, int64_t now_ms);
+  // Timeout for the next request to `host`, given the configured default
+  int64_t timeout_ms(const std::string& host, int64_t default_ms) const;
+
+  // One finished fetch. status is the HTTP status, 0 if there was no response.
+  void record(const std::string& feed, const std::string& host, int status, double latency_ms, int64_t now_ms);
+
+  // Forgets feeds not in `feeds` (after a reload), and hosts left without any
+  void prune(const std::vector<std::string>& feeds);
+
+  size_t open_breakers() const;
+  std::vector<HealthRow> feeds() const;   // worst first
+  std::vector<HealthRow> hosts(int64_t now_ms) const;
+
+  // Both tables for the metrics endpoint: Prometheus text, and JSON with the
+  // status histories
+  std::string render_prometheus(int64_t now_ms) const;
+  std::string render_json(int64_t now_ms) const;
+
+private:
+  struct Impl;
+  Impl* impl_;
+};
+
+const char* breaker_state_name(BreakerState s);
@@ -0,0 +1,40 @@
+#pragma once
+#include <string>
+#include <vector>
+
+struct ShardConfig {
+  bool enable = false;
+  std::string redis_host = "localhost";
+  int redis_port = 6379;
+  int redis_db = 0;
+  std::string instance_id;              // empty = <hostname>-<pid>
+  std::string members_key = "gw:members";
+  int lease_ttl_secs = 15;              // a member that stops renewing drops out after this
+  int vnodes = 64;                      // ring points per member
+};
+
+// Splits feed polling across news_gw instances. Every instance renews a lease in
+// a Redis sorted set (member -> lease expiry); the live members form a consistent
+// hash ring and each feed URL is owned by exactly one of them. When a member joins
+// or its lease expires only ~1/N of the feeds move. Per-feed politeness (e.g. the
+// Yahoo per-ticker interval) stays global because a URL has one owner at a time.
+// With Redis unreachable the last known ring is kept (or, before the first
+// successful renew, this instance owns everything); dedup still catches overlap.
+class FeedSharder {
+public:
+  explicit FeedSharder(const ShardConfig& cfg);
+  ~FeedSharder();
+
+  // Renews this instance's lease and reloads the live member set when due
+  // (every lease_ttl_secs / 3). Returns true if membership changed.
+  bool heartbeat();
+  bool owns(const std::string& feed_url) const;
+  const std::string& instance_id() const;
+  std::vector<std::string> members() const;
+  // Drops the lease so the remaining instances take over right away.
+  void leave();
+
+private:
+  struct Impl;
+  Impl* impl_;
+};
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+// What news_gw remembers about one polled URL (RSS feed or Yahoo page) between
+// cycles and across restarts.
+struct FeedState {
+  std::string etag;                 // validators from the last 200, sent back as
+  std::string last_modified;        // If-None-Match / If-Modified-Since
+  int64_t high_water_ms = 0;        // newest item publish time seen
+  int64_t last_fetch_ms = 0;        // wall clock, when the last fetch was issued
+  int64_t interval_ms = 0;          // adaptive poll interval (0 = the configured one)
+  int64_t retry_at_ms = 0;          // error backoff: no fetch before this
+  int32_t errors = 0;               // consecutive failed fetches
+};
+
+struct FeedPolicy {
+  int64_t base_interval_ms = 20000;
+  int64_t max_interval_ms = 160000;   // a feed with nothing new slows down to this
+  int64_t max_backoff_ms = 1800000;   // cap for the doubling error backoff
+  int breaker_failures = 1;           // failures in a row before the feed backs off
+  double jitter = 0;                  // backoffs are scaled by a random factor in [1-j, 1+j]
+  int64_t max_future_ms = 300000;     // publish times further ahead are not trusted (skew,
+                                      // misparsed zones, scheduled posts): no high-water
+};
+
+// Per-URL fetch state plus its on-disk snapshot. Not thread-safe (the gw event
+// loop owns it).
+//
+// The snapshot is one flat little-endian file that is mmap'd and validated on load:
+//   header  {magic "NGWFEED\0", version, entry_size, count, strings_len, written_ms, checksum}
+//   entries count x entry_size bytes, fixed layout, string fields as (offset, length)
+//   strings the URLs and validators, unterminated
+// A reader skips bytes past the entry layout it knows, so fields can be appended
+// to an entry without a version bump; anything else bumps the version and older
+// snapshots are ignored (cold start). Written to "<path>.tmp" and renamed.
+class FeedStateTable {
+public:
+  FeedState& at(const std::string& url) { dirty_ = true; return states_[url]; }
+  const FeedState* find(const std::string& url) const;
+  size_t size() const { return states_.size(); }
+
+  // Whether `url` should be fetched at now_ms: its interval has passed and it is
+  // not backing off. Cycles run every base interval, so this allows 1s of slack.
+  bool due(const std::string& url, int64_t now_ms, const FeedPolicy& p) const;
+
+  // Fetch outcomes. new_items counts items above the previous high-water mark;
+  // none (or a 304) stretches the interval by half, any resets it to the base. The
+  // mark never moves past now_ms + max_future_ms, so one future-dated item cannot
+  // put every real one below it.
+  void on_fetched(const std::string& url, const std::string& etag, const std::string& last_modified,
+                  int64_t newest_item_ms, size_t new_items, int64_t now_ms, const FeedPolicy& p);
+  void on_not_modified(const std::string& url, const FeedPolicy& p);
+  void on_error(const std::string& url, int64_t now_ms, const FeedPolicy& p);
+  // An item this URL listed was not published after all (its dedup key was released):
+  // drops the validators, so the next fetch is not answered 304, and lowers the
+  // high-water mark to the item's time, so it is not skipped as already seen
+  void rewind(const std::string& url, int64_t item_ts_ms);
+
+  // Drops entries whose URL is no longer polled
+  template <typename Keep> size_t prune(Keep keep) {
+    size_t n = 0;
+    for (auto it = states_.begin(); it != states_.end();) {
+      if (keep(it->first)) { ++it; continue; }
+      it = states_.erase(it);
+      ++n;
+    }
+    if (n) dirty_ = true;
+    return n;
+  }
+
+  bool dirty() const { return dirty_; }
+  // Clears dirty on success. `pending` maps URLs to the publish time of their oldest
+  // item not yet confirmed by Kafka (0 = undated); those entries are written rewound
+  // (see rewind()), so after a crash the item is still offered again.
+  bool save(const std::string& path, const std::unordered_map<std::string, int64_t>& pending = {});
+  // Replaces the table with the snapshot at `path`; false (table untouched) if it is
+  // missing, from another version or fails validation
+  bool load(const std::string& path);
+
+private:
+  std::unordered_map<std::string, FeedState> states_;
+  bool dirty_ = false;
+};
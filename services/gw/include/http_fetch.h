@@ -1,4 +1,5 @@
 #pragma once
+#include <functional>
 #include <string>
 #include <optional>
 #include <vector>
@@ -7,12 +8,24 @@ struct HttpResponse {
   long status = 0;
   std::string body;
   std::string effective_url;
+  std::string etag;            // validators of the final response (AsyncHttp only)
+  std::string last_modified;
 };
 
 struct HttpOptions {
   std::string user_agent = "FinNewsBot/1.0";
   long timeout_secs = 10;
+  long timeout_ms = 0;         // overrides timeout_secs when > 0 (AsyncHttp only)
   bool accept_gzip = true;
+  // Conditional GET (AsyncHttp only): a 304 then comes back with an empty body
+  std::string if_none_match;
+  std::string if_modified_since;
 };
 
 std::optional<HttpResponse> http_get(const std::string& url, const HttpOptions& opt);
+
+// Streams a 2xx body to `on_chunk` as it arrives instead of buffering it. Returning false
+// from on_chunk stops the transfer early (not an error). The returned body is empty;
+// non-2xx responses are not streamed.
+std::optional<HttpResponse> http_get_stream(const std::string& url, const HttpOptions& opt,
+                                            const std::function<bool(const char*, size_t)>& on_chunk);
@@ -1,22 +1,73 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <optional>
 
+namespace google::protobuf { class MessageLite; }
+
 struct KafkaConfig {
   std::string bootstrap_servers = "localhost:9092";
   std::string topic = "news.raw";
   std::string acks = "all";
   int linger_ms = 5;
   int batch_num_messages = 10000;
+  // "throughput": compression (zstd unless set), linger >= 50ms, large batches, idempotence
+  // "latency": linger 1ms, no compression unless set. Empty = only the fields above.
+  std::string profile;
+  std::string compression;          // none|gzip|snappy|lz4|zstd; overrides the profile
+  bool idempotence = false;         // forced on by the throughput profile
+  int queue_full_max_wait_ms = 5000; // block (serving delivery reports) this long when the local queue is full
+
+  // Durable fallback (see Spool): messages that can't be queued, or whose delivery
+  // fails with a retriable error, go to an on-disk spool that a background thread
+  // replays in order once the broker answers again. Empty dir = no spool.
+  std::string spool_dir;
+  size_t spool_segment_bytes = 64u << 20;
+  size_t spool_max_bytes = 1024u << 20;
+  int spool_sync_ms = 1000;
+  int spool_replay_batch = 500;     // records in flight per replay round
+
+  bool track_outcomes = false;      // remember settled keys for take_outcomes()
+};
+
+// Delivery accounting (enqueue -> broker ack, per message)
+struct KafkaProducerStats {
+  uint64_t delivered = 0;
+  uint64_t failed = 0;
+  uint64_t queue_full_waits = 0;   // produce() calls that had to wait for queue space
+  double avg_latency_ms = 0;
+  double p99_latency_ms = 0;       // log2-bucket upper bound
+  // spool (all zero without one)
+  uint64_t spooled = 0;            // messages written to the spool
+  uint64_t replayed = 0;           // spooled messages delivered by the replayer
+  uint64_t spool_rejected = 0;     // spool full: the message was dropped
+  uint64_t spool_alloc_failed = 0; // segments the disk had no room for (counted in spool_rejected)
+  uint64_t spool_depth = 0;        // records waiting for replay
+  uint64_t spool_bytes = 0;
 };
 
 class KafkaProducer {
  public:
   explicit KafkaProducer(const KafkaConfig& cfg);
   ~KafkaProducer();
+  // True once the message is queued for delivery, or written to the spool (which,
+  // while it holds a backlog, takes every new message so replay order is kept)
   bool produce(const std::string& key, const void* payload, size_t len);
+  // Serializes `msg` straight into a pooled buffer that librdkafka holds until the
+  // delivery report, then returns to the pool: no per-message allocation or copy.
+  bool produce_message(const std::string& key, const google::protobuf::MessageLite& msg);
   void flush(int timeout_ms);
+  // Serves delivery reports without forcing lingering batches out (unlike flush)
+  void poll(int timeout_ms);
+  // For event loops: a descriptor that turns readable when delivery reports are
+  // waiting. Drain it, then poll(0). Created on first use; -1 if unavailable.
+  int event_fd();
+  KafkaProducerStats stats() const;
+  // With track_outcomes: keys of messages settled since the last call. A message is
+  // settled once the broker acks it or it is written to the spool (delivered), or its
+  // delivery fails for good (failed). A produce() that returns false is not reported.
+  void take_outcomes(std::vector<std::string>& delivered, std::vector<std::string>& failed);
 
  private:
   struct Impl;
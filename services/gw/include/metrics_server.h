@@ -0,0 +1,30 @@
+#pragma once
+#include <functional>
+#include <string>
+
+#include "event_loop.h"
+
+struct MetricsResponse {
+  int status = 200;
+  std::string content_type = "text/plain; version=0.0.4";   // Prometheus text format
+  std::string body;
+};
+
+// Tiny HTTP/1.0 endpoint on the gw EventLoop for scrapes and health checks: each
+// connection sends one GET, gets one response and is closed, or is dropped after a
+// fixed deadline. The handler runs on the loop thread, so it can read loop-owned
+// state without locking.
+class MetricsServer {
+public:
+  using Handler = std::function<MetricsResponse(const std::string& path)>;
+
+  // Throws std::runtime_error if bind:port can't be listened on
+  MetricsServer(EventLoop& loop, const std::string& bind, int port, Handler handler);
+  ~MetricsServer();
+  MetricsServer(const MetricsServer&) = delete;
+  MetricsServer& operator=(const MetricsServer&) = delete;
+
+private:
+  struct Impl;
+  Impl* impl_;
+};
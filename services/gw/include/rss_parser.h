@@ -11,3 +11,20 @@ struct FeedItem {
 };
 
 std::vector<FeedItem> parse_feed_xml(const std::string& xml);
+
+// Incremental RSS/Atom parser fed chunk-by-chunk while the feed downloads.
+// feed() returns false once `max_items` items are complete (0 = no limit), so the
+// transfer can stop early; feeds list newest items first.
+class FeedPushParser {
+ public:
+  explicit FeedPushParser(size_t max_items = 0);
+  ~FeedPushParser();
+  FeedPushParser(const FeedPushParser&) = delete;
+  FeedPushParser& operator=(const FeedPushParser&) = delete;
+
+  bool feed(const char* data, size_t len);
+  std::vector<FeedItem> finish();
+
+ private:
+  struct Impl; Impl* impl_;
+};
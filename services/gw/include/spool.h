@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+struct SpoolConfig {
+  std::string dir;                          // one spool per directory
+  size_t segment_bytes = 64u << 20;         // segment file size (preallocated, mmap'd)
+  size_t max_bytes = 1024u << 20;           // appends are rejected beyond this many segment bytes
+  int sync_ms = 1000;                       // msync written ranges at most this often (0 = only on rotate)
+};
+
+struct SpoolStats {
+  uint64_t depth_records = 0;   // appended, not yet consumed
+  uint64_t depth_bytes = 0;
+  uint64_t segments = 0;
+  uint64_t appended = 0;
+  uint64_t consumed = 0;
+  uint64_t rejected = 0;        // appends refused by max_bytes or a failed segment allocation
+  uint64_t corrupt = 0;         // records skipped on a CRC/length mismatch
+  uint64_t alloc_failed = 0;    // segments whose disk blocks could not be reserved (disk full)
+};
+
+// Append-only on-disk queue of (key, value) records for messages that could not be
+// handed to Kafka. Segment files ("<seq>.seg", segment_bytes each) are mmap'd; each
+// record is [magic, key_len, val_len, crc32c(lengths, key, value)] + key + value,
+// 8-byte aligned, and is published by writing its header last, so a crash leaves
+// either a whole record or zeros/garbage that fails the CRC. The read position is kept
+// in a small "cursor" file; fully consumed segments are deleted. Replay is in append
+// order and at-least-once: records after the last commit() are read again after a
+// restart. Thread-safe.
+class Spool {
+public:
+  explicit Spool(const SpoolConfig& cfg);   // throws std::runtime_error if dir is unusable
+  ~Spool();
+  Spool(const Spool&) = delete;
+  Spool& operator=(const Spool&) = delete;
+
+  // False when the record doesn't fit under max_bytes (or is larger than a segment)
+  bool append(const void* key, size_t key_len, const void* val, size_t val_len);
+
+  bool empty() const;
+
+  // Reads the next record after the read position without consuming it; successive
+  // peeks walk forward. rewind() goes back to the committed position, commit()
+  // consumes everything peeked so far.
+  bool peek(std::string& key, std::string& val);
+  void rewind();
+  void commit();
+
+  // Flushes written ranges to disk if sync_ms has passed (always when force)
+  void sync(bool force = false);
+
+  SpoolStats stats() const;
+
+private:
+  struct Impl;
+  Impl* impl_;
+};
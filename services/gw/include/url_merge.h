@@ -0,0 +1,39 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+// One article as seen across every feed that listed it during a poll cycle.
+struct MergedArticle {
+  std::string url;                  // normalized URL (merge key)
+  std::string title;                // first non-empty title seen
+  int64_t published_ts_ms = 0;      // earliest timestamp reported
+  std::vector<std::string> sources; // e.g. {"YahooFinanceRSS:AAPL", "YahooFinanceHTML:MSFT"}
+  std::vector<std::string> feeds;   // polled URLs that listed it (feed state keys)
+};
+
+// Collects feed items for one cycle and folds duplicates by normalized URL,
+// so the same story listed under several tickers/feeds is published once.
+class UrlMerger {
+ public:
+  void add(const std::string& source, const std::string& feed_url, const std::string& normalized_url,
+           const std::string& title, int64_t published_ts_ms);
+
+  size_t size() const { return order_.size(); }
+  size_t merged_count() const { return merged_; }
+
+  // Returns articles in first-seen order and resets the merger.
+  std::vector<MergedArticle> take();
+
+ private:
+  std::unordered_map<std::string, size_t> index_; // url -> position in order_
+  std::vector<MergedArticle> order_;
+  size_t merged_ = 0;
+};
+
+// Stable id keyed on the normalized URL alone (source-independent)
+std::string url_id(const std::string& normalized_url);
+
+// "YahooFinanceRSS:AAPL" -> "AAPL"; empty if the source carries no ticker suffix
+std::string source_ticker(const std::string& source);
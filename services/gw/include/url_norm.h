@@ -2,3 +2,6 @@
 #include <string>
 
 std::string normalize_url(const std::string& url);
+
+// Lowercased host[:port] of an absolute URL ("" if there is none)
+std::string url_host(const std::string& url);
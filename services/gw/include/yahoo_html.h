@@ -7,7 +7,12 @@
 struct YahooHtmlItem {
   std::string title;
   std::string url;
-  int64_t published_ts_ms = 0; // may be approx if not found on page
+  int64_t published_ts_ms = 0; // exact from the embedded news stream; 0 when scraped from anchors
+};
+
+enum class YahooHtmlMode {
+  Anchors,        // <a href=".../news/..."> links and their text
+  EmbeddedJson,   // the page's embedded news-stream JSON; anchors when it is absent
 };
 
 struct YahooHtmlConfig {
@@ -17,6 +22,7 @@ struct YahooHtmlConfig {
   int http_timeout_secs = 10;
   int min_seconds_between_requests = 10;
   int max_links_per_page = 30;
+  YahooHtmlMode mode = YahooHtmlMode::EmbeddedJson;
 };
 
 // Returns false if robots.txt indicates the path should not be crawled (basic check)
@@ -25,8 +31,40 @@ bool yahoo_html_robots_allows(const YahooHtmlConfig& cfg);
 // Expand {TICKER} into actual URL
 std::string yahoo_html_url_for(const std::string& ticker, const YahooHtmlConfig& cfg);
 
-// Parse an HTML page and extract candidate news links/titles
-std::vector<YahooHtmlItem> yahoo_html_extract_items(const std::string& html, int max_links);
+// Parse an HTML page and extract candidate news links/titles (YahooPageScanner)
+std::vector<YahooHtmlItem> yahoo_html_extract_items(const std::string& html, int max_links,
+                                                    YahooHtmlMode mode = YahooHtmlMode::EmbeddedJson);
+
+// Previous DOM-based extractor (libxml2 tree walk); kept as the reference for news_yahoo_bench
+std::vector<YahooHtmlItem> yahoo_html_extract_items_dom(const std::string& html, int max_links);
+
+// Streaming extractor for quote pages, fed chunk by chunk; no DOM is built.
+// Anchors: tokenizes only <a> tags and the text inside them, skipping scripts, styles
+// and comments. Anchors whose href is on finance.yahoo.com and contains /news/ become
+// items, in page order, deduplicated by href.
+// EmbeddedJson: also captures the page's state island (<script type="application/json">
+// or the root.App.main assignment) and SAX-parses it, keeping only the objects of the
+// news stream arrays ("stream_items" / "stream") with their publish times. When no
+// island yields items, finish() returns the anchors instead.
+// max_links <= 0 means no limit.
+class YahooPageScanner {
+public:
+  YahooPageScanner(int max_links, YahooHtmlMode mode);
+  ~YahooPageScanner();
+  YahooPageScanner(const YahooPageScanner&) = delete;
+  YahooPageScanner& operator=(const YahooPageScanner&) = delete;
+
+  // False once max_links items are collected; later input is ignored
+  bool feed(const char* data, size_t len);
+  // Closes a trailing unterminated anchor and hands over the items
+  std::vector<YahooHtmlItem> finish();
+  // True if finish() returned items from the embedded news stream
+  bool used_json() const;
+
+private:
+  struct Impl;
+  Impl* impl_;
+};
 
 // A simple clock helper
 long long now_ms();
@@ -0,0 +1,211 @@
+#include "async_dedup.h"
+#include <hiredis/async.h>
+#include <hiredis/hiredis.h>
+#include <sys/epoll.h>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iostream>
+
+namespace {
+
+int64_t steady_ms() {
+  using namespace std::chrono;
+  return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+struct AsyncDedup::Impl {
+  EventLoop& loop;
+  DedupConfig cfg;
+  redisAsyncContext* ac = nullptr;
+  uint32_t events = 0;        // what the loop currently watches on ac's fd
+  int fd = -1;
+  size_t pending = 0;
+  bool closing = false;
+  bool dropping = false;       // inside drop(): the old context is being freed
+
+  // Deadlines of the commands in flight, oldest first. Redis answers in order, so
+  // every reply retires the front one, and only the front needs a timer.
+  std::deque<int64_t> deadlines;
+  EventLoop::TimerId watchdog = 0;
+  bool watchdog_armed = false;
+
+  Impl(EventLoop& l, const DedupConfig& c) : loop(l), cfg(c) {}
+
+  // --- hiredis event-library adapter on top of EventLoop ---
+  void rearm() {
+    if (!ac || fd < 0) return;
+    if (events == 0) { loop.unwatch(fd); return; }
+    redisAsyncContext* ctx = ac;
+    loop.watch(fd, events, [this, ctx](uint32_t ev) {
+      if (ev & (EPOLLIN | EPOLLERR | EPOLLHUP)) redisAsyncHandleRead(ctx);
+      if (ac == ctx && (ev & EPOLLOUT)) redisAsyncHandleWrite(ctx);   // read may have freed ctx
+    });
+  }
+  static void add_read(void* p)  { auto* s = static_cast<Impl*>(p); s->events |= EPOLLIN;  s->rearm(); }
+  static void del_read(void* p)  { auto* s = static_cast<Impl*>(p); s->events &= ~EPOLLIN; s->rearm(); }
+  static void add_write(void* p) { auto* s = static_cast<Impl*>(p); s->events |= EPOLLOUT; s->rearm(); }
+  static void del_write(void* p) { auto* s = static_cast<Impl*>(p); s->events &= ~EPOLLOUT; s->rearm(); }
+  static void cleanup(void* p) {
+    auto* s = static_cast<Impl*>(p);
+    if (s->fd >= 0) s->loop.unwatch(s->fd);
+    s->events = 0;
+    s->fd = -1;
+  }
+
+  static void on_connect(const redisAsyncContext* c, int status) {
+    auto* s = static_cast<Impl*>(c->data);
+    if (status != REDIS_OK) {
+      std::cerr << "[redis] async connect error: " << (c->errstr ? c->errstr : "?") << "\n";
+      s->ac = nullptr;   // hiredis frees the context after this callback
+    }
+  }
+  static void on_disconnect(const redisAsyncContext* c, int status) {
+    auto* s = static_cast<Impl*>(c->data);
+    if (status != REDIS_OK && !s->closing) {
+      std::cerr << "[redis] async connection lost: " << (c->errstr ? c->errstr : "?") << "\n";
+    }
+    s->ac = nullptr;
+  }
+
+  // Per-command deadline. A Redis that accepts the connection but stops answering
+  // would otherwise hold every setnx (and with it the gw cycle) forever; instead the
+  // connection is freed like a lost one: pending callbacks run with a null reply
+  // (fail open) and the next command reconnects.
+  void track() {
+    if (cfg.command_timeout_ms <= 0) return;
+    deadlines.push_back(steady_ms() + cfg.command_timeout_ms);
+    arm_watchdog();
+  }
+  void retire() {
+    if (!deadlines.empty()) deadlines.pop_front();
+  }
+  void arm_watchdog() {
+    if (watchdog_armed || deadlines.empty()) return;
+    watchdog_armed = true;
+    watchdog = loop.add_timer(std::max<int64_t>(0, deadlines.front() - steady_ms()), [this]() {
+      watchdog_armed = false;
+      if (!deadlines.empty() && steady_ms() >= deadlines.front()) {
+        std::cerr << "[redis] no reply within " << cfg.command_timeout_ms << "ms, dropping connection ("
+                  << deadlines.size() << " commands fail open)\n";
+        drop();
+      }
+      arm_watchdog();
+    });
+  }
+  void drop() {
+    redisAsyncContext* c = ac;
+    if (c) {
+      dropping = true;
+      redisAsyncFree(c);   // runs the pending callbacks, then on_disconnect and cleanup
+      dropping = false;
+    }
+    ac = nullptr;
+    deadlines.clear();
+  }
+
+  bool connect() {
+    redisAsyncContext* c = redisAsyncConnect(cfg.host.c_str(), cfg.port);
+    if (!c) { std::cerr << "[redis] async connect error (null context)\n"; return false; }
+    if (c->err) {
+      std::cerr << "[redis] async connect error: " << (c->errstr ? c->errstr : "?") << "\n";
+      redisAsyncFree(c);
+      return false;
+    }
+    c->data = this;
+    c->ev.data = this;
+    c->ev.addRead = add_read;
+    c->ev.delRead = del_read;
+    c->ev.addWrite = add_write;
+    c->ev.delWrite = del_write;
+    c->ev.cleanup = cleanup;
+    ac = c;
+    fd = c->c.fd;
+    events = 0;
+    redisAsyncSetConnectCallback(c, on_connect);
+    redisAsyncSetDisconnectCallback(c, on_disconnect);
+    if (cfg.db != 0) redisAsyncCommand(c, nullptr, nullptr, "SELECT %d", cfg.db);
+    return true;
+  }
+
+  static void on_reply(redisAsyncContext* c, void* r, void* privdata) {
+    auto* s = static_cast<Impl*>(c->data);
+    auto* done = static_cast<DoneFn*>(privdata);
+    auto* reply = static_cast<redisReply*>(r);
+    s->pending--;
+    s->retire();
+    bool is_new = true;   // fail-open on errors/disconnects
+    if (reply) {
+      if (reply->type == REDIS_REPLY_NIL) is_new = false;   // key existed -> duplicate
+      else if (reply->type == REDIS_REPLY_ERROR) std::cerr << "[redis] SET NX error: " << reply->str << "\n";
+    }
+    if (!s->closing) (*done)(is_new);
+    delete done;
+  }
+
+  static void on_update(redisAsyncContext* c, void* r, void*) {
+    auto* s = static_cast<Impl*>(c->data);
+    auto* reply = static_cast<redisReply*>(r);
+    s->pending--;
+    s->retire();
+    if (reply && reply->type == REDIS_REPLY_ERROR) std::cerr << "[redis] dedup update error: " << reply->str << "\n";
+  }
+
+  // confirm: SET key EX ttl_seconds (creates the key if the reservation already lapsed);
+  // release: DEL key
+  void update(const std::vector<std::string>& keys, bool confirm) {
+    if (keys.empty()) return;
+    if (dropping || (!ac && !connect())) {
+      std::cerr << "[redis] dedup update skipped for " << keys.size() << " keys (no connection)\n";
+      return;
+    }
+    for (const auto& key : keys) {
+      const int rc = confirm
+          ? redisAsyncCommand(ac, &Impl::on_update, nullptr, "SET %b 1 EX %d", key.data(), key.size(), cfg.ttl_seconds)
+          : redisAsyncCommand(ac, &Impl::on_update, nullptr, "DEL %b", key.data(), key.size());
+      if (rc != REDIS_OK) return;
+      pending++;
+      track();
+    }
+  }
+};
+
+AsyncDedup::AsyncDedup(EventLoop& loop, const DedupConfig& cfg) : impl_(new Impl(loop, cfg)) {}
+
+AsyncDedup::~AsyncDedup() {
+  if (!impl_) return;
+  impl_->closing = true;
+  if (impl_->watchdog_armed) impl_->loop.cancel_timer(impl_->watchdog);
+  if (impl_->ac) redisAsyncFree(impl_->ac);   // pending callbacks run with a null reply
+  delete impl_;
+}
+
+void AsyncDedup::setnx(const std::string& key, DoneFn done) {
+  // fail open while a timed-out connection is being torn down (a callback may land here)
+  if (impl_->dropping || (!impl_->ac && !impl_->connect())) { done(true); return; }
+  auto* d = new DoneFn(std::move(done));
+  impl_->pending++;
+  const int ttl = impl_->cfg.reserve_seconds > 0 ? impl_->cfg.reserve_seconds : impl_->cfg.ttl_seconds;
+  if (redisAsyncCommand(impl_->ac, &Impl::on_reply, d, "SET %b 1 NX EX %d",
+                        key.data(), key.size(), ttl) != REDIS_OK) {
+    impl_->pending--;
+    (*d)(true);
+    delete d;
+    return;
+  }
+  impl_->track();
+}
+
+void AsyncDedup::confirm(const std::vector<std::string>& keys) {
+  impl_->update(keys, true);
+}
+
+void AsyncDedup::release(const std::vector<std::string>& keys) {
+  impl_->update(keys, false);
+}
+
+size_t AsyncDedup::pending() const {
+  return impl_->pending;
+}
@@ -0,0 +1,229 @@
+#include "async_http.h"
+#include <curl/curl.h>
+#include <sys/epoll.h>
+#include <strings.h>
+#include <iostream>
+#include <string_view>
+#include <unordered_set>
+
+namespace {
+
+struct Request {
+  CURL* curl = nullptr;
+  std::string url;
+  std::string body;
+  AsyncHttp::ChunkFn on_chunk;   // empty = buffer the body
+  AsyncHttp::DoneFn done;
+  curl_slist* headers = nullptr;   // conditional request headers
+  std::string etag, last_modified;
+  bool checked_status = false;
+  bool stopped = false;
+  char errbuf[CURL_ERROR_SIZE] = {0};
+};
+
+size_t write_cb(char* ptr, size_t size, size_t nmemb, void* userdata) {
+  auto* r = static_cast<Request*>(userdata);
+  const size_t total = size * nmemb;
+  if (!r->on_chunk) {
+    r->body.append(ptr, total);
+    return total;
+  }
+  if (!r->checked_status) {
+    r->checked_status = true;
+    long status = 0;
+    curl_easy_getinfo(r->curl, CURLINFO_RESPONSE_CODE, &status);
+    if (status < 200 || status >= 300) { r->stopped = true; return 0; }  // error page: don't parse it
+  }
+  if (!r->on_chunk(ptr, total)) { r->stopped = true; return 0; }
+  return total;
+}
+
+// Keeps ETag / Last-Modified of the final response (headers of redirects are dropped)
+size_t header_cb(char* ptr, size_t size, size_t nmemb, void* userdata) {
+  auto* r = static_cast<Request*>(userdata);
+  const size_t total = size * nmemb;
+  std::string_view line(ptr, total);
+  if (line.substr(0, 5) == "HTTP/") {
+    r->etag.clear();
+    r->last_modified.clear();
+    return total;
+  }
+  const size_t colon = line.find(':');
+  if (colon == std::string_view::npos) return total;
+  std::string_view name = line.substr(0, colon), value = line.substr(colon + 1);
+  while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+  while (!value.empty() && (value.back() == '\r' || value.back() == '\n' || value.back() == ' ')) value.remove_suffix(1);
+  if (name.size() == 4 && strncasecmp(name.data(), "etag", 4) == 0) r->etag.assign(value);
+  else if (name.size() == 13 && strncasecmp(name.data(), "last-modified", 13) == 0) r->last_modified.assign(value);
+  return total;
+}
+
+void free_request(Request* r) {
+  curl_easy_cleanup(r->curl);
+  if (r->headers) curl_slist_free_all(r->headers);
+  delete r;
+}
+
+} // namespace
+
+struct AsyncHttp::Impl {
+  EventLoop& loop;
+  CURLM* multi = nullptr;
+  EventLoop::TimerId timer = 0;
+  std::unordered_set<Request*> active;
+  std::unordered_set<curl_socket_t> sockets;
+  bool closing = false;
+
+  explicit Impl(EventLoop& l) : loop(l) {}
+
+  void socket_action(curl_socket_t s, int flags) {
+    int running = 0;
+    curl_multi_socket_action(multi, s, flags, &running);
+    drain_done();
+  }
+
+  // curl tells us which sockets to watch and for what
+  static int socket_cb(CURL*, curl_socket_t s, int what, void* userp, void*) {
+    auto* self = static_cast<Impl*>(userp);
+    if (what == CURL_POLL_REMOVE || self->closing) {
+      self->loop.unwatch(s);
+      self->sockets.erase(s);
+      return 0;
+    }
+    uint32_t events = 0;
+    if (what & CURL_POLL_IN) events |= EPOLLIN;
+    if (what & CURL_POLL_OUT) events |= EPOLLOUT;
+    self->sockets.insert(s);
+    self->loop.watch(s, events, [self, s](uint32_t ev) {
+      int flags = 0;
+      if (ev & EPOLLIN) flags |= CURL_CSELECT_IN;
+      if (ev & EPOLLOUT) flags |= CURL_CSELECT_OUT;
+      if (ev & (EPOLLERR | EPOLLHUP)) flags |= CURL_CSELECT_ERR;
+      self->socket_action(s, flags);
+    });
+    return 0;
+  }
+
+  // curl's single timeout; socket_action may not be called from inside this callback
+  static int timer_cb(CURLM*, long timeout_ms, void* userp) {
+    auto* self = static_cast<Impl*>(userp);
+    if (self->timer) { self->loop.cancel_timer(self->timer); self->timer = 0; }
+    if (timeout_ms >= 0 && !self->closing) {
+      self->timer = self->loop.add_timer(timeout_ms, [self] {
+        self->timer = 0;
+        self->socket_action(CURL_SOCKET_TIMEOUT, 0);
+      });
+    }
+    return 0;
+  }
+
+  void drain_done() {
+    int left = 0;
+    while (CURLMsg* msg = curl_multi_info_read(multi, &left)) {
+      if (msg->msg != CURLMSG_DONE) continue;
+      CURL* curl = msg->easy_handle;
+      const CURLcode res = msg->data.result;
+      Request* r = nullptr;
+      curl_easy_getinfo(curl, CURLINFO_PRIVATE, reinterpret_cast<char**>(&r));
+
+      std::optional<HttpResponse> resp;
+      if (res == CURLE_OK || (res == CURLE_WRITE_ERROR && r->stopped)) {
+        long status = 0;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+        char* eff = nullptr;
+        curl_easy_getinfo(curl, CURLINFO_EFFECTIVE_URL, &eff);
+        resp = HttpResponse{status, std::move(r->body), eff ? std::string(eff) : r->url,
+                            std::move(r->etag), std::move(r->last_modified)};
+      } else {
+        std::cerr << "[http] curl error: " << (r->errbuf[0] ? r->errbuf : curl_easy_strerror(res))
+                  << " url=" << r->url << "\n";
+      }
+
+      curl_multi_remove_handle(multi, curl);
+      active.erase(r);
+      auto done = std::move(r->done);
+      free_request(r);
+      if (done) done(std::move(resp));   // may start new transfers
+    }
+  }
+
+  void start(const std::string& url, const HttpOptions& opt, ChunkFn on_chunk, DoneFn done) {
+    CURL* curl = curl_easy_init();
+    if (!curl) { done(std::nullopt); return; }
+    auto* r = new Request();
+    r->curl = curl;
+    r->url = url;
+    r->on_chunk = std::move(on_chunk);
+    r->done = std::move(done);
+
+    curl_easy_setopt(curl, CURLOPT_URL, r->url.c_str());
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, r);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_cb);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, r);
+    curl_easy_setopt(curl, CURLOPT_USERAGENT, opt.user_agent.c_str());
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 5L);
+    if (opt.timeout_ms > 0) curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, opt.timeout_ms);
+    else curl_easy_setopt(curl, CURLOPT_TIMEOUT, opt.timeout_secs);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, r->errbuf);
+    if (opt.accept_gzip) {
+      curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+    }
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, header_cb);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, r);
+    if (!opt.if_none_match.empty()) {
+      r->headers = curl_slist_append(r->headers, ("If-None-Match: " + opt.if_none_match).c_str());
+    }
+    if (!opt.if_modified_since.empty()) {
+      r->headers = curl_slist_append(r->headers, ("If-Modified-Since: " + opt.if_modified_since).c_str());
+    }
+    if (r->headers) curl_easy_setopt(curl, CURLOPT_HTTPHEADER, r->headers);
+
+    active.insert(r);
+    if (curl_multi_add_handle(multi, curl) != CURLM_OK) {
+      active.erase(r);
+      auto d = std::move(r->done);
+      free_request(r);
+      d(std::nullopt);
+    }
+  }
+};
+
+AsyncHttp::AsyncHttp(EventLoop& loop, long max_connections, long max_host_connections)
+    : impl_(new Impl(loop)) {
+  impl_->multi = curl_multi_init();
+  curl_multi_setopt(impl_->multi, CURLMOPT_SOCKETFUNCTION, &Impl::socket_cb);
+  curl_multi_setopt(impl_->multi, CURLMOPT_SOCKETDATA, impl_);
+  curl_multi_setopt(impl_->multi, CURLMOPT_TIMERFUNCTION, &Impl::timer_cb);
+  curl_multi_setopt(impl_->multi, CURLMOPT_TIMERDATA, impl_);
+  // transfers over these limits wait inside curl instead of opening more sockets
+  curl_multi_setopt(impl_->multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, max_connections);
+  curl_multi_setopt(impl_->multi, CURLMOPT_MAX_HOST_CONNECTIONS, max_host_connections);
+  curl_multi_setopt(impl_->multi, CURLMOPT_MAXCONNECTS, max_connections);
+}
+
+AsyncHttp::~AsyncHttp() {
+  if (!impl_) return;
+  impl_->closing = true;
+  if (impl_->timer) impl_->loop.cancel_timer(impl_->timer);
+  for (Request* r : impl_->active) {   // abandoned transfers: callbacks are not run
+    curl_multi_remove_handle(impl_->multi, r->curl);
+    free_request(r);
+  }
+  curl_multi_cleanup(impl_->multi);
+  for (curl_socket_t s : impl_->sockets) impl_->loop.unwatch(s);
+  delete impl_;
+}
+
+void AsyncHttp::get(const std::string& url, const HttpOptions& opt, DoneFn done) {
+  impl_->start(url, opt, ChunkFn(), std::move(done));
+}
+
+void AsyncHttp::get_stream(const std::string& url, const HttpOptions& opt, ChunkFn on_chunk, DoneFn done) {
+  impl_->start(url, opt, std::move(on_chunk), std::move(done));
+}
+
+size_t AsyncHttp::in_flight() const {
+  return impl_->active.size();
+}
@@ -1,6 +1,7 @@
 #include "config.h"
 #include <yaml-cpp/yaml.h>
 #include <stdexcept>
+#include <unordered_set>
 
 AppConfig load_app_config(const std::string& path) {
   YAML::Node root = YAML::LoadFile(path);
@@ -10,24 +11,108 @@ AppConfig load_app_config(const std::string& path) {
   auto r = root["redis"];
   auto i = root["ingest"];
   auto y = root["yahoo"];
+  auto cl = root["cleaner"];
+  auto sh = root["shard"];
 
   // kafka
   c.kafka.bootstrap_servers   = k["bootstrap_servers"].as<std::string>();
   c.kafka.topic_raw           = k["topic_raw"].as<std::string>();
+  if (k["topic_clean"]) c.kafka.topic_clean = k["topic_clean"].as<std::string>();
   c.kafka.acks                = k["acks"].as<std::string>();
   c.kafka.linger_ms           = k["linger_ms"].as<int>();
   c.kafka.batch_num_messages  = k["batch_num_messages"].as<int>();
+  if (k["producer_profile"])       c.kafka.producer_profile = k["producer_profile"].as<std::string>();
+  if (k["compression"])            c.kafka.compression = k["compression"].as<std::string>();
+  if (k["idempotence"])            c.kafka.idempotence = k["idempotence"].as<bool>();
+  if (k["queue_full_max_wait_ms"]) c.kafka.queue_full_max_wait_ms = k["queue_full_max_wait_ms"].as<int>();
+  if (auto sp = k["spool"]) {
+    if (sp["enable"])     c.kafka.spool_enable = sp["enable"].as<bool>();
+    if (sp["dir"])        c.kafka.spool_dir = sp["dir"].as<std::string>();
+    if (sp["segment_mb"]) c.kafka.spool_segment_mb = sp["segment_mb"].as<int>();
+    if (sp["max_mb"])     c.kafka.spool_max_mb = sp["max_mb"].as<int>();
+    if (sp["sync_ms"])    c.kafka.spool_sync_ms = sp["sync_ms"].as<int>();
+  }
 
   // redis
   c.redis.host               = r["host"].as<std::string>();
   c.redis.port               = r["port"].as<int>();
   c.redis.db                 = r["db"].as<int>();
   c.redis.dedup_ttl_seconds  = r["dedup_ttl_seconds"].as<int>();
+  if (r["dedup_reserve_seconds"]) c.redis.dedup_reserve_seconds = r["dedup_reserve_seconds"].as<int>();
+  if (r["command_timeout_ms"]) c.redis.command_timeout_ms = r["command_timeout_ms"].as<int>();
 
   // ingest
   c.ingest.interval_secs     = i["interval_secs"].as<int>();
   c.ingest.user_agent        = i["user_agent"].as<std::string>();
   c.ingest.http_timeout_secs = i["http_timeout_secs"].as<int>();
+  if (i["streaming_parse"])    c.ingest.streaming_parse = i["streaming_parse"].as<bool>();
+  if (i["max_items_per_feed"]) c.ingest.max_items_per_feed = i["max_items_per_feed"].as<int>();
+  if (i["max_concurrent_fetches"]) c.ingest.max_concurrent_fetches = i["max_concurrent_fetches"].as<int>();
+  if (i["max_host_connections"])   c.ingest.max_host_connections = i["max_host_connections"].as<int>();
+  if (i["parse_threads"])          c.ingest.parse_threads = i["parse_threads"].as<int>();
+  if (i["state_path"])             c.ingest.state_path = i["state_path"].as<std::string>();
+  if (i["state_snapshot_secs"])    c.ingest.state_snapshot_secs = i["state_snapshot_secs"].as<int>();
+  if (i["max_interval_factor"])    c.ingest.max_interval_factor = i["max_interval_factor"].as<int>();
+  if (i["max_backoff_secs"])       c.ingest.max_backoff_secs = i["max_backoff_secs"].as<int>();
+  if (i["high_water_slack_secs"])  c.ingest.high_water_slack_secs = i["high_water_slack_secs"].as<int>();
+  if (i["parse_pinning"])          c.ingest.parse_pinning = i["parse_pinning"].as<std::string>();
+
+  // shard (optional; news_gw scale-out)
+  if (sh) {
+    if (sh["enable"])         c.shard.enable = sh["enable"].as<bool>();
+    if (sh["instance_id"])    c.shard.instance_id = sh["instance_id"].as<std::string>();
+    if (sh["members_key"])    c.shard.members_key = sh["members_key"].as<std::string>();
+    if (sh["lease_ttl_secs"]) c.shard.lease_ttl_secs = sh["lease_ttl_secs"].as<int>();
+    if (sh["vnodes"])         c.shard.vnodes = sh["vnodes"].as<int>();
+  }
+
+  // health / metrics (optional; news_gw)
+  if (auto h = root["health"]) {
+    if (h["breaker_failures"])    c.health.breaker_failures = h["breaker_failures"].as<int>();
+    if (h["breaker_base_secs"])   c.health.breaker_base_secs = h["breaker_base_secs"].as<int>();
+    if (h["breaker_max_secs"])    c.health.breaker_max_secs = h["breaker_max_secs"].as<int>();
+    if (h["jitter"])              c.health.jitter = h["jitter"].as<double>();
+    if (h["timeout_p99_factor"])  c.health.timeout_p99_factor = h["timeout_p99_factor"].as<double>();
+    if (h["timeout_min_ms"])      c.health.timeout_min_ms = h["timeout_min_ms"].as<int>();
+    if (h["timeout_min_samples"]) c.health.timeout_min_samples = h["timeout_min_samples"].as<int>();
+  }
+  if (auto m = root["metrics"]) {
+    if (m["enable"]) c.metrics.enable = m["enable"].as<bool>();
+    if (m["bind"])   c.metrics.bind = m["bind"].as<std::string>();
+    if (m["port"])   c.metrics.port = m["port"].as<int>();
+  }
+
+  // cleaner (optional; used by news_clean)
+  if (cl) {
+    if (cl["require_english"])   c.cleaner.require_english = cl["require_english"].as<bool>();
+    if (cl["min_body_chars"])    c.cleaner.min_body_chars = cl["min_body_chars"].as<int>();
+    if (cl["http_timeout_secs"]) c.cleaner.http_timeout_secs = cl["http_timeout_secs"].as<int>();
+    if (cl["user_agent"])        c.cleaner.user_agent = cl["user_agent"].as<std::string>();
+    if (cl["max_body_bytes"])    c.cleaner.max_body_bytes = cl["max_body_bytes"].as<int>();
+    if (cl["require_html_content_type"]) c.cleaner.require_html_content_type = cl["require_html_content_type"].as<bool>();
+    if (cl["max_dom_bytes"])     c.cleaner.max_dom_bytes = cl["max_dom_bytes"].as<int>();
+    if (cl["max_dom_nodes"])     c.cleaner.max_dom_nodes = cl["max_dom_nodes"].as<int>();
+    if (cl["structured_min_body_chars"]) c.cleaner.structured_min_body_chars = cl["structured_min_body_chars"].as<int>();
+    if (cl["streaming"])         c.cleaner.streaming = cl["streaming"].as<bool>();
+    if (cl["stop_after_article_chars"]) c.cleaner.stop_after_article_chars = cl["stop_after_article_chars"].as<int>();
+    if (cl["workers"])       c.cleaner.workers = cl["workers"].as<int>();
+    if (cl["fetch_threads"]) c.cleaner.fetch_threads = cl["fetch_threads"].as<int>();
+    if (cl["max_in_flight"]) c.cleaner.max_in_flight = cl["max_in_flight"].as<int>();
+    if (cl["cpu_pinning"])   c.cleaner.cpu_pinning = cl["cpu_pinning"].as<std::string>();
+    if (auto nd = cl["near_dup"]) {
+      if (nd["enable"])       c.cleaner.near_dup_enable = nd["enable"].as<bool>();
+      if (nd["action"])       c.cleaner.near_dup_action = nd["action"].as<std::string>();
+      if (nd["max_hamming"])  c.cleaner.near_dup_max_hamming = nd["max_hamming"].as<int>();
+      if (nd["window_secs"])  c.cleaner.near_dup_window_secs = nd["window_secs"].as<int>();
+      if (nd["max_entries"])  c.cleaner.near_dup_max_entries = nd["max_entries"].as<int>();
+    }
+    if (auto tp = cl["templates"]) {
+      if (tp["enable"])       c.cleaner.templates_enable = tp["enable"].as<bool>();
+      if (tp["path"])         c.cleaner.templates_path = tp["path"].as<std::string>();
+      if (tp["learn_after"])  c.cleaner.templates_learn_after = tp["learn_after"].as<int>();
+      if (tp["max_failures"]) c.cleaner.templates_max_failures = tp["max_failures"].as<int>();
+    }
+  }
 
   // yahoo (optional)
   if (y) {
@@ -40,6 +125,7 @@ AppConfig load_app_config(const std::string& path) {
     if (y["robots_url"])        c.yahoo.robots_url = y["robots_url"].as<std::string>();
     if (y["min_seconds_between_requests"]) c.yahoo.min_seconds_between_requests = y["min_seconds_between_requests"].as<int>();
     if (y["max_links_per_page"])           c.yahoo.max_links_per_page = y["max_links_per_page"].as<int>();
+    if (y["html_mode"])                    c.yahoo.html_mode = y["html_mode"].as<std::string>();
   }
 
   return c;
@@ -50,7 +136,7 @@ RssConfig load_rss_config(const std::string& path) {
   RssConfig rc;
   rc.interval_secs = root["interval_secs"].as<int>();
   rc.user_agent    = root["user_agent"].as<std::string>();
-  for (auto& f : root["feeds"]) {
+  for (const auto& f : root["feeds"]) {
     Feed feed;
     feed.source = f["source"].as<std::string>();
     feed.url    = f["url"].as<std::string>();
@@ -58,3 +144,201 @@ RssConfig load_rss_config(const std::string& path) {
   }
   return rc;
 }
+
+EntityConfig load_entity_config(const std::string& path) {
+  YAML::Node root = YAML::LoadFile(path);
+  EntityConfig ec;
+
+  auto k = root["kafka"];
+  auto r = root["resolver"];
+
+  ec.kafka.bootstrap_servers = k["bootstrap_servers"].as<std::string>();
+  if (k["group_id"])           ec.kafka.group_id = k["group_id"].as<std::string>();
+  if (k["topic_in"])           ec.kafka.topic_in = k["topic_in"].as<std::string>();
+  if (k["topic_out"])          ec.kafka.topic_out = k["topic_out"].as<std::string>();
+  if (k["acks"])               ec.kafka.acks = k["acks"].as<std::string>();
+  if (k["linger_ms"])          ec.kafka.linger_ms = k["linger_ms"].as<int>();
+  if (k["batch_num_messages"]) ec.kafka.batch_num_messages = k["batch_num_messages"].as<int>();
+  if (k["producer_profile"])   ec.kafka.producer_profile = k["producer_profile"].as<std::string>();
+  if (k["compression"])        ec.kafka.compression = k["compression"].as<std::string>();
+
+  if (r) {
+    if (r["tickers_csv"])    ec.resolver.tickers_csv = r["tickers_csv"].as<std::string>();
+    if (r["topics_yml"])     ec.resolver.topics_yml = r["topics_yml"].as<std::string>();
+    if (r["min_score"])      ec.resolver.min_score = r["min_score"].as<double>();
+    if (r["max_tickers"])    ec.resolver.max_tickers = r["max_tickers"].as<int>();
+    if (r["workers"])        ec.resolver.workers = r["workers"].as<int>();
+    if (r["queue_capacity"]) ec.resolver.queue_capacity = r["queue_capacity"].as<int>();
+  }
+  return ec;
+}
+
+ScoringConfig load_scoring_config(const std::string& path) {
+  YAML::Node root = YAML::LoadFile(path);
+  ScoringConfig sc;
+
+  auto k = root["kafka"];
+  auto g = root["grpc"];
+  auto b = root["batch"];
+
+  sc.kafka.bootstrap_servers = k["bootstrap_servers"].as<std::string>();
+  if (k["topic_in"])  sc.kafka.topic_in = k["topic_in"].as<std::string>();
+  if (k["topic_out"]) sc.kafka.topic_out = k["topic_out"].as<std::string>();
+  if (k["group_id"])  sc.kafka.group_id = k["group_id"].as<std::string>();
+  if (k["output_format"]) sc.kafka.output_format = k["output_format"].as<std::string>();
+
+  if (g) {
+    if (g["host"])       sc.grpc.host = g["host"].as<std::string>();
+    if (g["port"])       sc.grpc.port = g["port"].as<int>();
+    if (g["timeout_ms"]) sc.grpc.timeout_ms = g["timeout_ms"].as<int>();
+  }
+  if (b) {
+    if (b["max_items"])      sc.batch.max_items = b["max_items"].as<int>();
+    if (b["min_items"])      sc.batch.min_items = b["min_items"].as<int>();
+    if (b["max_wait_ms"])    sc.batch.max_wait_ms = b["max_wait_ms"].as<int>();
+    if (b["max_inflight"])   sc.batch.max_inflight = b["max_inflight"].as<int>();
+    if (b["latency_slo_ms"]) sc.batch.latency_slo_ms = b["latency_slo_ms"].as<double>();
+    if (b["excerpt_max_bytes"]) sc.batch.excerpt_max_bytes = b["excerpt_max_bytes"].as<int>();
+  }
+  return sc;
+}
+
+SinksConfig load_sinks_config(const std::string& path) {
+  YAML::Node root = YAML::LoadFile(path);
+  SinksConfig sc;
+
+  auto k = root["kafka"];
+  auto p = root["parquet"];
+
+  sc.kafka.bootstrap_servers = k["bootstrap_servers"].as<std::string>();
+  if (k["topic_scored"])     sc.kafka.topic_scored = k["topic_scored"].as<std::string>();
+  if (k["group_id_parquet"]) sc.kafka.group_id_parquet = k["group_id_parquet"].as<std::string>();
+
+  if (p) {
+    if (p["root_dir"])       sc.parquet.root_dir = p["root_dir"].as<std::string>();
+    if (p["topic"])          sc.parquet.topic = p["topic"].as<std::string>();
+    if (p["input_format"])   sc.parquet.input_format = p["input_format"].as<std::string>();
+    if (p["row_group_rows"]) sc.parquet.row_group_rows = p["row_group_rows"].as<int>();
+    if (p["max_file_mb"])    sc.parquet.max_file_mb = p["max_file_mb"].as<int>();
+    if (p["roll_secs"])      sc.parquet.roll_secs = p["roll_secs"].as<int>();
+    if (p["compression"])    sc.parquet.compression = p["compression"].as<std::string>();
+  }
+  if (auto c = root["clickhouse"]) {
+    if (c["url"])              sc.clickhouse.url = c["url"].as<std::string>();
+    if (c["database"])         sc.clickhouse.database = c["database"].as<std::string>();
+    if (c["table"])            sc.clickhouse.table = c["table"].as<std::string>();
+    if (c["user"])             sc.clickhouse.user = c["user"].as<std::string>();
+    if (c["password"])         sc.clickhouse.password = c["password"].as<std::string>();
+    if (c["group_id"])         sc.clickhouse.group_id = c["group_id"].as<std::string>();
+    if (c["topic"])            sc.clickhouse.topic = c["topic"].as<std::string>();
+    if (c["input_format"])     sc.clickhouse.input_format = c["input_format"].as<std::string>();
+    if (c["max_rows"])         sc.clickhouse.max_rows = c["max_rows"].as<int>();
+    if (c["max_wait_ms"])      sc.clickhouse.max_wait_ms = c["max_wait_ms"].as<int>();
+    if (c["timeout_secs"])     sc.clickhouse.timeout_secs = c["timeout_secs"].as<int>();
+    if (c["max_retries"])      sc.clickhouse.max_retries = c["max_retries"].as<int>();
+    if (c["retry_backoff_ms"]) sc.clickhouse.retry_backoff_ms = c["retry_backoff_ms"].as<int>();
+  }
+  return sc;
+}
+
+LoadgenConfig load_loadgen_config(const std::string& path) {
+  YAML::Node root = YAML::LoadFile(path);
+  LoadgenConfig lc;
+
+  if (auto sv = root["server"]) {
+    if (sv["bind"])    lc.server.bind = sv["bind"].as<std::string>();
+    if (sv["port"])    lc.server.port = sv["port"].as<int>();
+    if (sv["threads"]) lc.server.threads = sv["threads"].as<int>();
+  }
+  if (auto ct = root["content"]) {
+    if (ct["feeds"])             lc.content.feeds = ct["feeds"].as<int>();
+    if (ct["feed_format"])       lc.content.feed_format = ct["feed_format"].as<std::string>();
+    if (ct["items_per_feed"])    lc.content.items_per_feed = ct["items_per_feed"].as<int>();
+    if (ct["items_per_sec"])     lc.content.items_per_sec = ct["items_per_sec"].as<double>();
+    if (ct["duplicate_ratio"])   lc.content.duplicate_ratio = ct["duplicate_ratio"].as<double>();
+    if (ct["page_bytes"])        lc.content.page_bytes = ct["page_bytes"].as<int>();
+    if (ct["page_bytes_jitter"]) lc.content.page_bytes_jitter = ct["page_bytes_jitter"].as<double>();
+  }
+  if (auto f = root["faults"]) {
+    if (f["latency_median_ms"]) lc.faults.latency_median_ms = f["latency_median_ms"].as<double>();
+    if (f["latency_sigma"])     lc.faults.latency_sigma = f["latency_sigma"].as<double>();
+    if (f["error_429_ratio"])   lc.faults.error_429_ratio = f["error_429_ratio"].as<double>();
+    if (f["error_5xx_ratio"])   lc.faults.error_5xx_ratio = f["error_5xx_ratio"].as<double>();
+  }
+  if (auto m = root["measure"]) {
+    if (m["enable"])            lc.measure.enable = m["enable"].as<bool>();
+    if (m["bootstrap_servers"]) lc.measure.bootstrap_servers = m["bootstrap_servers"].as<std::string>();
+    if (m["topic"])             lc.measure.topic = m["topic"].as<std::string>();
+    if (m["report_secs"])       lc.measure.report_secs = m["report_secs"].as<int>();
+  }
+  return lc;
+}
+
+std::vector<std::string> validate_app_config(const AppConfig& c) {
+  std::vector<std::string> errs;
+  if (c.redis.dedup_reserve_seconds < 0) errs.push_back("redis.dedup_reserve_seconds must be >= 0");
+  if (c.redis.dedup_reserve_seconds > c.redis.dedup_ttl_seconds)
+    errs.push_back("redis.dedup_reserve_seconds must be <= redis.dedup_ttl_seconds");
+  if (c.redis.command_timeout_ms < 0) errs.push_back("redis.command_timeout_ms must be >= 0");
+  if (c.kafka.bootstrap_servers.empty()) errs.push_back("kafka.bootstrap_servers is empty");
+  if (c.kafka.topic_raw.empty())         errs.push_back("kafka.topic_raw is empty");
+  if (c.kafka.spool_enable) {
+    if (c.kafka.spool_dir.empty())       errs.push_back("kafka.spool.dir is empty");
+    if (c.kafka.spool_segment_mb <= 0)   errs.push_back("kafka.spool.segment_mb must be > 0");
+    if (c.kafka.spool_max_mb < c.kafka.spool_segment_mb)
+      errs.push_back("kafka.spool.max_mb must be >= kafka.spool.segment_mb");
+  }
+  if (c.ingest.http_timeout_secs <= 0)   errs.push_back("ingest.http_timeout_secs must be > 0");
+  if (c.ingest.max_items_per_feed < 0)   errs.push_back("ingest.max_items_per_feed must be >= 0");
+  if (c.ingest.max_concurrent_fetches <= 0) errs.push_back("ingest.max_concurrent_fetches must be > 0");
+  if (c.ingest.max_host_connections <= 0)   errs.push_back("ingest.max_host_connections must be > 0");
+  if (c.ingest.parse_threads <= 0)          errs.push_back("ingest.parse_threads must be > 0");
+  if (c.ingest.state_snapshot_secs <= 0)    errs.push_back("ingest.state_snapshot_secs must be > 0");
+  if (c.ingest.max_interval_factor < 1)     errs.push_back("ingest.max_interval_factor must be >= 1");
+  if (c.ingest.max_backoff_secs <= 0)       errs.push_back("ingest.max_backoff_secs must be > 0");
+  if (c.ingest.high_water_slack_secs < 0)   errs.push_back("ingest.high_water_slack_secs must be >= 0");
+  if (c.health.breaker_failures < 1)        errs.push_back("health.breaker_failures must be >= 1");
+  if (c.health.breaker_base_secs <= 0)      errs.push_back("health.breaker_base_secs must be > 0");
+  if (c.health.breaker_max_secs < c.health.breaker_base_secs)
+    errs.push_back("health.breaker_max_secs must be >= health.breaker_base_secs");
+  if (c.health.jitter < 0 || c.health.jitter >= 1) errs.push_back("health.jitter must be in [0, 1)");
+  if (c.health.timeout_p99_factor < 1)      errs.push_back("health.timeout_p99_factor must be >= 1");
+  if (c.health.timeout_min_ms <= 0)         errs.push_back("health.timeout_min_ms must be > 0");
+  if (c.metrics.enable && (c.metrics.port <= 0 || c.metrics.port > 65535))
+    errs.push_back("metrics.port must be in 1..65535");
+  for (const auto& [name, pin] : {std::pair{"ingest.parse_pinning", &c.ingest.parse_pinning},
+                                  std::pair{"cleaner.cpu_pinning", &c.cleaner.cpu_pinning}}) {
+    if (*pin != "none" && *pin != "cores" && *pin != "numa")
+      errs.push_back(std::string(name) + " must be 'none', 'cores' or 'numa'");
+  }
+  if (c.cleaner.http_timeout_secs <= 0)  errs.push_back("cleaner.http_timeout_secs must be > 0");
+  if (c.cleaner.min_body_chars < 0)      errs.push_back("cleaner.min_body_chars must be >= 0");
+  if (c.cleaner.workers <= 0)            errs.push_back("cleaner.workers must be > 0");
+  if (c.cleaner.fetch_threads <= 0)      errs.push_back("cleaner.fetch_threads must be > 0");
+  if (c.cleaner.max_in_flight <= 0)      errs.push_back("cleaner.max_in_flight must be > 0");
+  if (c.cleaner.near_dup_action != "tag" && c.cleaner.near_dup_action != "drop")
+    errs.push_back("cleaner.near_dup.action must be 'tag' or 'drop'");
+  if (c.cleaner.templates_learn_after <= 0)  errs.push_back("cleaner.templates.learn_after must be > 0");
+  if (c.cleaner.templates_max_failures <= 0) errs.push_back("cleaner.templates.max_failures must be > 0");
+  if (c.yahoo.enable_html && c.yahoo.min_seconds_between_requests < 0)
+    errs.push_back("yahoo.min_seconds_between_requests must be >= 0");
+  if (c.yahoo.html_mode != "json" && c.yahoo.html_mode != "anchors")
+    errs.push_back("yahoo.html_mode must be 'json' or 'anchors'");
+  for (const auto& t : c.yahoo.tickers) {
+    if (t.empty()) errs.push_back("yahoo.tickers contains an empty ticker");
+  }
+  return errs;
+}
+
+std::vector<std::string> validate_rss_config(const RssConfig& c) {
+  std::vector<std::string> errs;
+  if (c.interval_secs <= 0) errs.push_back("interval_secs must be > 0");
+  std::unordered_set<std::string> urls;
+  for (const auto& f : c.feeds) {
+    if (f.url.rfind("http://", 0) != 0 && f.url.rfind("https://", 0) != 0)
+      errs.push_back("feed '" + f.source + "' has a non-http url: " + f.url);
+    if (!urls.insert(f.url).second)
+      errs.push_back("duplicate feed url: " + f.url);
+  }
+  return errs;
+}
@@ -0,0 +1,67 @@
+#include "config_watch.h"
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <csignal>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <set>
+
+namespace fs = std::filesystem;
+
+static volatile std::sig_atomic_t g_reload = 0;
+static void handle_sighup(int) { g_reload = 1; }
+
+struct ConfigWatcher::Impl {
+  int fd = -1;
+  std::map<int, std::set<std::string>> names_by_wd;   // dir watch -> watched file names
+};
+
+ConfigWatcher::ConfigWatcher(const std::vector<std::string>& paths) : impl_(new Impl) {
+  std::signal(SIGHUP, handle_sighup);
+
+  impl_->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (impl_->fd < 0) {
+    std::cerr << "[config] inotify unavailable, reload on SIGHUP only\n";
+    return;
+  }
+  for (const auto& p : paths) {
+    fs::path path(p);
+    fs::path dir = path.has_parent_path() ? path.parent_path() : fs::path(".");
+    int wd = inotify_add_watch(impl_->fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (wd < 0) {
+      std::cerr << "[config] cannot watch " << dir.string() << ", reload on SIGHUP only\n";
+      continue;
+    }
+    impl_->names_by_wd[wd].insert(path.filename().string());
+  }
+}
+
+ConfigWatcher::~ConfigWatcher() {
+  if (impl_->fd >= 0) close(impl_->fd);
+  delete impl_;
+}
+
+bool ConfigWatcher::poll() {
+  bool changed = false;
+  if (g_reload) {
+    g_reload = 0;
+    changed = true;
+  }
+  if (impl_->fd < 0) return changed;
+
+  alignas(struct inotify_event) char buf[4096];
+  for (;;) {
+    ssize_t n = read(impl_->fd, buf, sizeof(buf));
+    if (n <= 0) break;
+    for (char* p = buf; p < buf + n;) {
+      auto* ev = reinterpret_cast<struct inotify_event*>(p);
+      auto it = impl_->names_by_wd.find(ev->wd);
+      if (ev->len > 0 && it != impl_->names_by_wd.end() && it->second.count(ev->name)) changed = true;
+      p += sizeof(struct inotify_event) + ev->len;
+    }
+  }
+  return changed;
+}
@@ -0,0 +1,166 @@
+#include "event_loop.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+struct Watch {
+  uint32_t events = 0;
+  uint32_t gen = 0;                     // distinguishes a reused fd number from a stale event
+  std::shared_ptr<EventLoop::FdFn> fn;
+};
+
+uint64_t pack(int fd, uint32_t gen) { return ((uint64_t)gen << 32) | (uint32_t)fd; }
+
+} // namespace
+
+struct EventLoop::Impl {
+  int ep = -1;
+  int wake_fd = -1;
+  uint32_t next_gen = 1;
+  std::unordered_map<int, Watch> watches;
+
+  using Due = std::pair<int64_t, TimerId>;
+  std::priority_queue<Due, std::vector<Due>, std::greater<Due>> timer_heap;
+  std::unordered_map<TimerId, std::function<void()>> timers;   // cancelled ids are erased here only
+  TimerId next_timer = 1;
+
+  std::mutex post_mu;
+  std::vector<std::function<void()>> posted;
+
+  void run_timers() {
+    const int64_t now = EventLoop::now_ms();
+    while (!timer_heap.empty() && timer_heap.top().first <= now) {
+      const TimerId id = timer_heap.top().second;
+      timer_heap.pop();
+      auto it = timers.find(id);
+      if (it == timers.end()) continue;
+      auto fn = std::move(it->second);
+      timers.erase(it);
+      fn();
+    }
+  }
+
+  void run_posted() {
+    std::vector<std::function<void()>> batch;
+    {
+      std::lock_guard<std::mutex> lk(post_mu);
+      batch.swap(posted);
+    }
+    for (auto& fn : batch) fn();
+  }
+};
+
+EventLoop::EventLoop() : impl_(new Impl()) {
+  impl_->ep = epoll_create1(EPOLL_CLOEXEC);
+  impl_->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (impl_->ep < 0 || impl_->wake_fd < 0) {
+    if (impl_->ep >= 0) close(impl_->ep);
+    if (impl_->wake_fd >= 0) close(impl_->wake_fd);
+    delete impl_;
+    throw std::runtime_error(std::string("event loop init failed: ") + std::strerror(errno));
+  }
+  const int wfd = impl_->wake_fd;
+  watch(wfd, EPOLLIN, [wfd](uint32_t) {
+    uint64_t n;
+    while (read(wfd, &n, sizeof(n)) > 0) {}
+  });
+}
+
+EventLoop::~EventLoop() {
+  if (impl_) {
+    close(impl_->wake_fd);
+    close(impl_->ep);
+    delete impl_;
+  }
+}
+
+void EventLoop::watch(int fd, uint32_t events, FdFn fn) {
+  auto it = impl_->watches.find(fd);
+  const bool exists = it != impl_->watches.end();
+  Watch& w = exists ? it->second : impl_->watches[fd];
+  if (!exists) w.gen = impl_->next_gen++;
+  w.events = events;
+  w.fn = std::make_shared<FdFn>(std::move(fn));
+
+  epoll_event ev{};
+  ev.events = events;
+  ev.data.u64 = pack(fd, w.gen);
+  int rc = epoll_ctl(impl_->ep, exists ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &ev);
+  if (rc != 0 && errno == EEXIST) rc = epoll_ctl(impl_->ep, EPOLL_CTL_MOD, fd, &ev);
+  if (rc != 0 && errno == ENOENT) rc = epoll_ctl(impl_->ep, EPOLL_CTL_ADD, fd, &ev);
+  if (rc != 0) std::cerr << "[loop] epoll_ctl fd=" << fd << ": " << std::strerror(errno) << "\n";
+}
+
+void EventLoop::unwatch(int fd) {
+  if (impl_->watches.erase(fd) == 0) return;
+  epoll_ctl(impl_->ep, EPOLL_CTL_DEL, fd, nullptr);   // fails harmlessly if fd was already closed
+}
+
+EventLoop::TimerId EventLoop::add_timer(int64_t delay_ms, std::function<void()> fn) {
+  const TimerId id = impl_->next_timer++;
+  impl_->timers.emplace(id, std::move(fn));
+  impl_->timer_heap.emplace(now_ms() + std::max<int64_t>(0, delay_ms), id);
+  return id;
+}
+
+void EventLoop::cancel_timer(TimerId id) {
+  impl_->timers.erase(id);
+}
+
+void EventLoop::post(std::function<void()> fn) {
+  {
+    std::lock_guard<std::mutex> lk(impl_->post_mu);
+    impl_->posted.push_back(std::move(fn));
+  }
+  const uint64_t one = 1;
+  [[maybe_unused]] ssize_t n = write(impl_->wake_fd, &one, sizeof(one));
+}
+
+void EventLoop::run_once(int max_wait_ms) {
+  int timeout = std::max(0, max_wait_ms);
+  while (!impl_->timer_heap.empty() && !impl_->timers.count(impl_->timer_heap.top().second)) {
+    impl_->timer_heap.pop();   // drop cancelled timers so they don't shorten the wait
+  }
+  if (!impl_->timer_heap.empty()) {
+    const int64_t until = impl_->timer_heap.top().first - now_ms();
+    timeout = (int)std::clamp<int64_t>(until, 0, timeout);
+  }
+
+  epoll_event evs[256];
+  const int n = epoll_wait(impl_->ep, evs, 256, timeout);
+  if (n < 0) {
+    if (errno != EINTR) std::cerr << "[loop] epoll_wait: " << std::strerror(errno) << "\n";
+    return;
+  }
+
+  for (int i = 0; i < n; ++i) {
+    const int fd = (int)(uint32_t)evs[i].data.u64;
+    const uint32_t gen = (uint32_t)(evs[i].data.u64 >> 32);
+    auto it = impl_->watches.find(fd);
+    // unwatched (or re-registered) by an earlier callback in this batch
+    if (it == impl_->watches.end() || it->second.gen != gen) continue;
+    auto fn = it->second.fn;   // keeps the callback alive if it unwatches itself
+    (*fn)(evs[i].events);
+  }
+
+  impl_->run_timers();
+  impl_->run_posted();
+}
+
+int64_t EventLoop::now_ms() {
+  using namespace std::chrono;
+  return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
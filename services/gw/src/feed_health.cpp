@@ -0,0 +1,325 @@
+#include "feed_health.h"
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+constexpr size_t kHistory = 16;        // statuses kept per feed/host
+constexpr size_t kLatencyWindow = 128; // successful fetches per host for the p99
+
+struct Stats {
+  uint64_t successes = 0, failures = 0;
+  int consecutive_failures = 0;
+  double ewma_ms = 0;
+  int history[kHistory] = {};
+  size_t history_len = 0, history_pos = 0;
+
+  void add(int status, bool ok, double latency_ms, double alpha) {
+    if (ok) { ++successes; consecutive_failures = 0; }
+    else { ++failures; ++consecutive_failures; }
+    ewma_ms = (successes + failures == 1) ? latency_ms : alpha * latency_ms + (1 - alpha) * ewma_ms;
+    history[history_pos] = status;
+    history_pos = (history_pos + 1) % kHistory;
+    history_len = std::min(history_len + 1, kHistory);
+  }
+
+  void fill(HealthRow& r) const {
+    r.successes = successes;
+    r.failures = failures;
+    r.consecutive_failures = consecutive_failures;
+    r.ewma_ms = ewma_ms;
+    r.history.clear();
+    for (size_t i = 0; i < history_len; ++i) {
+      r.history.push_back(history[(history_pos + kHistory - history_len + i) % kHistory]);
+    }
+  }
+};
+
+struct Feed {
+  std::string host;
+  Stats stats;
+};
+
+struct Host {
+  Stats stats;
+  BreakerState breaker = BreakerState::Closed;
+  int opens = 0;              // consecutive open periods (backoff exponent)
+  int64_t open_until_ms = 0;
+  bool probing = false;       // half-open: the probe is out
+  double latencies[kLatencyWindow] = {};
+  size_t lat_len = 0, lat_pos = 0;
+
+  double p99() const {
+    if (lat_len == 0) return 0;
+    std::vector<double> v(latencies, latencies + lat_len);
+    const size_t k = std::min(lat_len - 1, (size_t)std::ceil(lat_len * 0.99) - 1);
+    std::nth_element(v.begin(), v.begin() + (ptrdiff_t)k, v.end());
+    return v[k];
+  }
+};
+
+// What counts against a breaker: no response, throttling, server errors. A 404 is
+// the feed's problem (the host answered) and only shows in the feed's row.
+bool host_failure(int status) { return status == 0 || status == 429 || status >= 500; }
+bool fetch_ok(int status) { return (status >= 200 && status < 300) || status == 304; }
+
+// Listing order for /health/hosts: open breakers first, then probing, then healthy
+int breaker_rank(BreakerState s) {
+  switch (s) {
+    case BreakerState::Open: return 0;
+    case BreakerState::HalfOpen: return 1;
+    case BreakerState::Closed: return 2;
+  }
+  return 3;
+}
+
+} // namespace
+
+const char* breaker_state_name(BreakerState s) {
+  switch (s) {
+    case BreakerState::Closed: return "closed";
+    case BreakerState::Open: return "open";
+    case BreakerState::HalfOpen: return "half_open";
+  }
+  return "?";
+}
+
+struct HealthTable::Impl {
+  HealthConfig cfg;
+  std::unordered_map<std::string, Feed> feeds;
+  std::unordered_map<std::string, Host> hosts;
+  std::mt19937_64 rng{std::random_device{}()};
+
+  void open(const std::string& name, Host& h, int64_t now_ms) {
+    int64_t period = cfg.breaker_base_ms;
+    for (int i = 0; i < h.opens && period < cfg.breaker_max_ms; ++i) period *= 2;
+    period = std::min(period, cfg.breaker_max_ms);
+    std::uniform_real_distribution<double> j(1.0 - cfg.jitter, 1.0 + cfg.jitter);
+    period = (int64_t)(period * j(rng));   // spread retries of hosts that failed together
+    h.breaker = BreakerState::Open;
+    h.open_until_ms = now_ms + period;
+    h.probing = false;
+    h.opens++;
+    std::cerr << "[health] breaker open for " << name << " (" << h.stats.consecutive_failures
+              << " failures), retry in " << period / 1000 << "s\n";
+  }
+
+  // p99-derived timeout, 0 until the host has enough samples
+  int64_t adaptive_ms(const Host& h) const {
+    if (h.lat_len < (size_t)cfg.timeout_min_samples) return 0;
+    return std::max(cfg.timeout_min_ms, (int64_t)(h.p99() * cfg.timeout_p99_factor));
+  }
+
+  HealthRow host_row(const std::string& name, const Host& h, int64_t now_ms) const {
+    HealthRow r;
+    r.key = name;
+    r.host = name;
+    h.stats.fill(r);
+    r.p99_ms = h.p99();
+    r.breaker = h.breaker;
+    r.open_for_ms = h.breaker == BreakerState::Open ? std::max<int64_t>(0, h.open_until_ms - now_ms) : 0;
+    r.timeout_ms = adaptive_ms(h);
+    return r;
+  }
+};
+
+HealthTable::HealthTable(const HealthConfig& cfg) : impl_(new Impl()) {
+  impl_->cfg = cfg;
+  impl_->cfg.breaker_failures = std::max(1, impl_->cfg.breaker_failures);
+  impl_->cfg.jitter = std::clamp(impl_->cfg.jitter, 0.0, 0.9);
+}
+
+HealthTable::~HealthTable() {
+  delete impl_;
+}
+
+bool HealthTable::allow(const std::string& host, int64_t now_ms) {
+  auto it = impl_->hosts.find(host);
+  if (it == impl_->hosts.end()) return true;
+  Host& h = it->second;
+  switch (h.breaker) {
+    case BreakerState::Closed:
+      return true;
+    case BreakerState::Open:
+      if (now_ms < h.open_until_ms) return false;
+      h.breaker = BreakerState::HalfOpen;
+      h.probing = true;
+      return true;
+    case BreakerState::HalfOpen:
+      if (h.probing) return false;
+      h.probing = true;
+      return true;
+  }
+  return true;
+}
+
+int64_t HealthTable::timeout_ms(const std::string& host, int64_t default_ms) const {
+  auto it = impl_->hosts.find(host);
+  const int64_t t = it == impl_->hosts.end() ? 0 : impl_->adaptive_ms(it->second);
+  return t > 0 ? std::min(t, default_ms) : default_ms;
+}
+
+void HealthTable::record(const std::string& feed, const std::string& host, int status, double latency_ms,
+                         int64_t now_ms) {
+  const double alpha = impl_->cfg.ewma_alpha;
+  Feed& f = impl_->feeds[feed];
+  f.host = host;
+  f.stats.add(status, fetch_ok(status), latency_ms, alpha);
+
+  Host& h = impl_->hosts[host];
+  const bool failed = host_failure(status);
+  h.stats.add(status, !failed, latency_ms, alpha);
+  if (fetch_ok(status)) {
+    h.latencies[h.lat_pos] = latency_ms;
+    h.lat_pos = (h.lat_pos + 1) % kLatencyWindow;
+    h.lat_len = std::min(h.lat_len + 1, kLatencyWindow);
+  }
+  if (!failed) {
+    if (h.breaker != BreakerState::Closed) std::cerr << "[health] breaker closed for " << host << "\n";
+    h.breaker = BreakerState::Closed;
+    h.opens = 0;
+    h.probing = false;
+    return;
+  }
+  if (h.breaker == BreakerState::HalfOpen) {
+    impl_->open(host, h, now_ms);   // probe failed: back off for longer
+  } else if (h.breaker == BreakerState::Closed && h.stats.consecutive_failures >= impl_->cfg.breaker_failures) {
+    impl_->open(host, h, now_ms);
+  }
+}
+
+void HealthTable::prune(const std::vector<std::string>& feeds) {
+  const std::unordered_set<std::string> keep(feeds.begin(), feeds.end());
+  std::unordered_set<std::string> used;
+  for (auto it = impl_->feeds.begin(); it != impl_->feeds.end();) {
+    if (keep.count(it->first)) { used.insert(it->second.host); ++it; }
+    else it = impl_->feeds.erase(it);
+  }
+  for (auto it = impl_->hosts.begin(); it != impl_->hosts.end();) {
+    if (used.count(it->first)) ++it;
+    else it = impl_->hosts.erase(it);
+  }
+}
+
+size_t HealthTable::open_breakers() const {
+  size_t n = 0;
+  for (const auto& [name, h] : impl_->hosts) n += h.breaker != BreakerState::Closed;
+  return n;
+}
+
+std::vector<HealthRow> HealthTable::feeds() const {
+  std::vector<HealthRow> out;
+  out.reserve(impl_->feeds.size());
+  for (const auto& [url, f] : impl_->feeds) {
+    HealthRow r;
+    r.key = url;
+    r.host = f.host;
+    f.stats.fill(r);
+    out.push_back(std::move(r));
+  }
+  std::sort(out.begin(), out.end(), [](const HealthRow& a, const HealthRow& b) {
+    if (a.consecutive_failures != b.consecutive_failures) return a.consecutive_failures > b.consecutive_failures;
+    return a.ewma_ms > b.ewma_ms;
+  });
+  return out;
+}
+
+std::vector<HealthRow> HealthTable::hosts(int64_t now_ms) const {
+  std::vector<HealthRow> out;
+  out.reserve(impl_->hosts.size());
+  for (const auto& [name, h] : impl_->hosts) {
+    out.push_back(impl_->host_row(name, h, now_ms));
+  }
+  std::sort(out.begin(), out.end(), [](const HealthRow& a, const HealthRow& b) {
+    if (a.breaker != b.breaker) return breaker_rank(a.breaker) < breaker_rank(b.breaker);
+    if (a.consecutive_failures != b.consecutive_failures) return a.consecutive_failures > b.consecutive_failures;
+    return a.p99_ms > b.p99_ms;
+  });
+  return out;
+}
+
+static std::string label(const std::string& v) {
+  std::string out;
+  out.reserve(v.size());
+  for (char c : v) {
+    if (c == '\\' || c == '"') out.push_back('\\');
+    if (c == '\n') { out += "\\n"; continue; }
+    out.push_back(c);
+  }
+  return out;
+}
+
+std::string HealthTable::render_prometheus(int64_t now_ms) const {
+  std::string out;
+  out += "# HELP gw_feed_consecutive_failures Failed fetches in a row.\n# TYPE gw_feed_consecutive_failures gauge\n";
+  const auto frows = feeds();
+  for (const auto& r : frows) {
+    out += fmt::format("gw_feed_consecutive_failures{{feed=\"{}\",host=\"{}\"}} {}\n", label(r.key), label(r.host),
+                       r.consecutive_failures);
+  }
+  out += "# HELP gw_feed_latency_ewma_ms Fetch latency, exponentially weighted.\n# TYPE gw_feed_latency_ewma_ms gauge\n";
+  for (const auto& r : frows) {
+    out += fmt::format("gw_feed_latency_ewma_ms{{feed=\"{}\"}} {:.1f}\n", label(r.key), r.ewma_ms);
+  }
+  out += "# HELP gw_feed_fetches_total Completed fetches by outcome.\n# TYPE gw_feed_fetches_total counter\n";
+  for (const auto& r : frows) {
+    out += fmt::format("gw_feed_fetches_total{{feed=\"{}\",outcome=\"ok\"}} {}\n", label(r.key), r.successes);
+    out += fmt::format("gw_feed_fetches_total{{feed=\"{}\",outcome=\"error\"}} {}\n", label(r.key), r.failures);
+  }
+
+  const auto hrows = hosts(now_ms);
+  out += "# HELP gw_host_breaker_state 0 closed, 1 open, 2 half-open.\n# TYPE gw_host_breaker_state gauge\n";
+  for (const auto& r : hrows) {
+    out += fmt::format("gw_host_breaker_state{{host=\"{}\"}} {}\n", label(r.key), (int)r.breaker);
+  }
+  out += "# HELP gw_host_consecutive_failures Breaker-relevant failures in a row.\n"
+         "# TYPE gw_host_consecutive_failures gauge\n";
+  for (const auto& r : hrows) {
+    out += fmt::format("gw_host_consecutive_failures{{host=\"{}\"}} {}\n", label(r.key), r.consecutive_failures);
+  }
+  out += "# HELP gw_host_latency_p99_ms p99 of recent successful fetches.\n# TYPE gw_host_latency_p99_ms gauge\n";
+  for (const auto& r : hrows) {
+    out += fmt::format("gw_host_latency_p99_ms{{host=\"{}\"}} {:.1f}\n", label(r.key), r.p99_ms);
+  }
+  out += "# HELP gw_host_timeout_ms Adaptive request timeout (0 = configured default).\n"
+         "# TYPE gw_host_timeout_ms gauge\n";
+  for (const auto& r : hrows) {
+    out += fmt::format("gw_host_timeout_ms{{host=\"{}\"}} {}\n", label(r.key), r.timeout_ms);
+  }
+  return out;
+}
+
+std::string HealthTable::render_json(int64_t now_ms) const {
+  auto row = [](const HealthRow& r) {
+    return nlohmann::json{{"successes", r.successes},
+                          {"failures", r.failures},
+                          {"consecutive_failures", r.consecutive_failures},
+                          {"ewma_ms", std::round(r.ewma_ms * 10) / 10},
+                          {"history", r.history}};
+  };
+  nlohmann::json j;
+  j["feeds"] = nlohmann::json::array();
+  for (const auto& r : feeds()) {
+    auto o = row(r);
+    o["feed"] = r.key;
+    o["host"] = r.host;
+    j["feeds"].push_back(std::move(o));
+  }
+  j["hosts"] = nlohmann::json::array();
+  for (const auto& r : hosts(now_ms)) {
+    auto o = row(r);
+    o["host"] = r.key;
+    o["breaker"] = breaker_state_name(r.breaker);
+    o["open_for_ms"] = r.open_for_ms;
+    o["p99_ms"] = std::round(r.p99_ms * 10) / 10;
+    o["timeout_ms"] = r.timeout_ms;
+    j["hosts"].push_back(std::move(o));
+  }
+  return j.dump(1) + "\n";
+}
@@ -0,0 +1,132 @@
+#include "feed_shard.h"
+
+#include <hiredis/hiredis.h>
+#include <unistd.h>
+#include <xxhash.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+
+static long long now_ms() {
+  using namespace std::chrono;
+  return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+static uint64_t hash64(const std::string& s) { return XXH64(s.data(), s.size(), 0); }
+
+struct FeedSharder::Impl {
+  ShardConfig cfg;
+  std::string id;
+  redisContext* redis = nullptr;
+  std::vector<std::string> members;      // sorted
+  std::map<uint64_t, std::string> ring;  // point -> member
+  long long next_renew_ms = 0;
+
+  bool connect() {
+    if (redis && !redis->err) return true;
+    if (redis) { redisFree(redis); redis = nullptr; }
+    struct timeval tv{2, 0};
+    redis = redisConnectWithTimeout(cfg.redis_host.c_str(), cfg.redis_port, tv);
+    if (!redis || redis->err) {
+      std::cerr << "[shard] redis connect error: " << (redis ? redis->errstr : "null context") << "\n";
+      if (redis) { redisFree(redis); redis = nullptr; }
+      return false;
+    }
+    redisSetTimeout(redis, tv);
+    if (cfg.redis_db != 0) {
+      redisReply* sel = (redisReply*)redisCommand(redis, "SELECT %d", cfg.redis_db);
+      if (sel) freeReplyObject(sel);
+    }
+    return true;
+  }
+
+  void rebuild_ring() {
+    ring.clear();
+    for (const auto& m : members) {
+      for (int v = 0; v < std::max(1, cfg.vnodes); ++v) {
+        ring.emplace(hash64(m + "#" + std::to_string(v)), m);
+      }
+    }
+  }
+
+  // ZADD our expiry, drop expired members, read the rest - one round trip
+  bool renew(std::vector<std::string>& live) {
+    if (!connect()) return false;
+    const long long now = now_ms();
+    const std::string expiry = std::to_string(now + (long long)cfg.lease_ttl_secs * 1000);
+    const std::string cutoff = std::to_string(now);
+    redisAppendCommand(redis, "ZADD %s %s %s", cfg.members_key.c_str(), expiry.c_str(), id.c_str());
+    redisAppendCommand(redis, "ZREMRANGEBYSCORE %s -inf %s", cfg.members_key.c_str(), cutoff.c_str());
+    redisAppendCommand(redis, "ZRANGE %s 0 -1", cfg.members_key.c_str());
+    bool ok = true;
+    for (int i = 0; i < 3; ++i) {
+      redisReply* r = nullptr;
+      if (redisGetReply(redis, (void**)&r) != REDIS_OK || !r) { ok = false; break; }
+      if (r->type == REDIS_REPLY_ERROR) ok = false;
+      if (i == 2 && r->type == REDIS_REPLY_ARRAY) {
+        for (size_t j = 0; j < r->elements; ++j) live.emplace_back(r->element[j]->str, r->element[j]->len);
+      }
+      freeReplyObject(r);
+    }
+    if (!ok) {
+      std::cerr << "[shard] lease renew failed\n";
+      redisFree(redis);
+      redis = nullptr;
+    }
+    return ok;
+  }
+};
+
+FeedSharder::FeedSharder(const ShardConfig& cfg) : impl_(new Impl) {
+  impl_->cfg = cfg;
+  impl_->id = cfg.instance_id;
+  if (impl_->id.empty()) {
+    char host[256] = {0};
+    gethostname(host, sizeof(host) - 1);
+    impl_->id = std::string(host) + "-" + std::to_string(getpid());
+  }
+  impl_->members = {impl_->id};
+  impl_->rebuild_ring();
+}
+
+FeedSharder::~FeedSharder() {
+  if (impl_->redis) redisFree(impl_->redis);
+  delete impl_;
+}
+
+bool FeedSharder::heartbeat() {
+  if (!impl_->cfg.enable) return false;
+  const long long now = now_ms();
+  if (now < impl_->next_renew_ms) return false;
+  impl_->next_renew_ms = now + std::max(1, impl_->cfg.lease_ttl_secs) * 1000LL / 3;
+
+  std::vector<std::string> live;
+  if (!impl_->renew(live)) return false;   // keep the last known ring
+  if (std::find(live.begin(), live.end(), impl_->id) == live.end()) live.push_back(impl_->id);
+  std::sort(live.begin(), live.end());
+  if (live == impl_->members) return false;
+
+  impl_->members = std::move(live);
+  impl_->rebuild_ring();
+  return true;
+}
+
+bool FeedSharder::owns(const std::string& feed_url) const {
+  if (!impl_->cfg.enable || impl_->ring.empty()) return true;
+  auto it = impl_->ring.lower_bound(hash64(feed_url));
+  if (it == impl_->ring.end()) it = impl_->ring.begin();
+  return it->second == impl_->id;
+}
+
+const std::string& FeedSharder::instance_id() const { return impl_->id; }
+
+std::vector<std::string> FeedSharder::members() const { return impl_->members; }
+
+void FeedSharder::leave() {
+  if (!impl_->cfg.enable || !impl_->connect()) return;
+  redisReply* r = (redisReply*)redisCommand(impl_->redis, "ZREM %s %s",
+                                            impl_->cfg.members_key.c_str(), impl_->id.c_str());
+  if (r) freeReplyObject(r);
+}
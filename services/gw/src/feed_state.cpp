@@ -0,0 +1,251 @@
+#include "feed_state.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr char kMagic[8] = {'N', 'G', 'W', 'F', 'E', 'E', 'D', '\0'};
+constexpr uint32_t kVersion = 1;
+
+struct SnapHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t entry_size;
+  uint64_t count;
+  uint64_t strings_len;
+  int64_t written_ms;
+  uint64_t checksum;     // FNV-1a over entries + strings
+};
+static_assert(sizeof(SnapHeader) == 48, "snapshot header layout");
+
+struct SnapEntry {
+  uint32_t url_off, url_len;
+  uint32_t etag_off, etag_len;
+  uint32_t lm_off, lm_len;
+  int64_t high_water_ms;
+  int64_t last_fetch_ms;
+  int64_t interval_ms;
+  int64_t retry_at_ms;
+  int32_t errors;
+  uint32_t reserved;
+};
+static_assert(sizeof(SnapEntry) == 64, "snapshot entry layout");
+
+uint64_t fnv1a(uint64_t h, const void* data, size_t n) {
+  const auto* p = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < n; ++i) { h ^= p[i]; h *= 1099511628211ULL; }
+  return h;
+}
+constexpr uint64_t kFnvSeed = 14695981039346656037ULL;
+
+int64_t wall_ms() {
+  using namespace std::chrono;
+  return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+const FeedState* FeedStateTable::find(const std::string& url) const {
+  auto it = states_.find(url);
+  return it == states_.end() ? nullptr : &it->second;
+}
+
+bool FeedStateTable::due(const std::string& url, int64_t now_ms, const FeedPolicy& p) const {
+  const FeedState* st = find(url);
+  if (!st) return true;
+  if (now_ms < st->retry_at_ms) return false;
+  const int64_t interval = st->interval_ms > 0 ? st->interval_ms : p.base_interval_ms;
+  return now_ms - st->last_fetch_ms >= interval - 1000;
+}
+
+void FeedStateTable::on_fetched(const std::string& url, const std::string& etag, const std::string& last_modified,
+                                int64_t newest_item_ms, size_t new_items, int64_t now_ms, const FeedPolicy& p) {
+  FeedState& st = at(url);
+  st.etag = etag;
+  st.last_modified = last_modified;
+  // the clamp also pulls back a mark saved before it existed
+  st.high_water_ms = std::min(std::max(st.high_water_ms, newest_item_ms), now_ms + p.max_future_ms);
+  st.errors = 0;
+  st.retry_at_ms = 0;
+  if (new_items > 0) {
+    st.interval_ms = p.base_interval_ms;
+  } else {
+    on_not_modified(url, p);
+  }
+}
+
+void FeedStateTable::on_not_modified(const std::string& url, const FeedPolicy& p) {
+  FeedState& st = at(url);
+  const int64_t cur = st.interval_ms > 0 ? st.interval_ms : p.base_interval_ms;
+  st.interval_ms = std::clamp(cur + cur / 2, p.base_interval_ms, std::max(p.base_interval_ms, p.max_interval_ms));
+  st.errors = 0;
+  st.retry_at_ms = 0;
+}
+
+void FeedStateTable::on_error(const std::string& url, int64_t now_ms, const FeedPolicy& p) {
+  FeedState& st = at(url);
+  st.errors++;
+  if (st.errors < p.breaker_failures) return;   // retried on the normal schedule
+  int64_t backoff = p.base_interval_ms;
+  for (int i = p.breaker_failures; i < st.errors && backoff < p.max_backoff_ms; ++i) backoff *= 2;
+  backoff = std::min(backoff, p.max_backoff_ms);
+  if (p.jitter > 0) {
+    static std::mt19937_64 rng{std::random_device{}()};
+    backoff = (int64_t)(backoff * std::uniform_real_distribution<double>(1 - p.jitter, 1 + p.jitter)(rng));
+  }
+  st.retry_at_ms = now_ms + backoff;
+}
+
+void FeedStateTable::rewind(const std::string& url, int64_t item_ts_ms) {
+  auto it = states_.find(url);
+  if (it == states_.end()) return;
+  FeedState& st = it->second;
+  st.etag.clear();
+  st.last_modified.clear();
+  if (item_ts_ms > 0) st.high_water_ms = std::min(st.high_water_ms, item_ts_ms);
+  dirty_ = true;
+}
+
+bool FeedStateTable::save(const std::string& path, const std::unordered_map<std::string, int64_t>& pending) {
+  std::vector<SnapEntry> entries;
+  entries.reserve(states_.size());
+  std::string strings;
+  auto put = [&](const std::string& s, uint32_t& off, uint32_t& len) {
+    off = (uint32_t)strings.size();
+    len = (uint32_t)s.size();
+    strings += s;
+  };
+  for (const auto& [url, st] : states_) {
+    SnapEntry e{};
+    const auto p = pending.find(url);
+    const bool rewound = p != pending.end();
+    static const std::string none;
+    put(url, e.url_off, e.url_len);
+    put(rewound ? none : st.etag, e.etag_off, e.etag_len);
+    put(rewound ? none : st.last_modified, e.lm_off, e.lm_len);
+    e.high_water_ms = rewound && p->second > 0 ? std::min(st.high_water_ms, p->second) : st.high_water_ms;
+    e.last_fetch_ms = st.last_fetch_ms;
+    e.interval_ms = st.interval_ms;
+    e.retry_at_ms = st.retry_at_ms;
+    e.errors = st.errors;
+    entries.push_back(e);
+  }
+  if (strings.size() > UINT32_MAX) {
+    std::cerr << "[feed_state] snapshot too large, not saved\n";
+    return false;
+  }
+
+  SnapHeader h{};
+  std::memcpy(h.magic, kMagic, sizeof(kMagic));
+  h.version = kVersion;
+  h.entry_size = sizeof(SnapEntry);
+  h.count = entries.size();
+  h.strings_len = strings.size();
+  h.written_ms = wall_ms();
+  h.checksum = fnv1a(fnv1a(kFnvSeed, entries.data(), entries.size() * sizeof(SnapEntry)),
+                     strings.data(), strings.size());
+
+  const std::string tmp = path + ".tmp";
+  try {
+    const auto parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent);
+  } catch (const std::exception& ex) {
+    std::cerr << "[feed_state] " << ex.what() << "\n";
+    return false;
+  }
+  FILE* f = std::fopen(tmp.c_str(), "wb");
+  if (!f) {
+    std::cerr << "[feed_state] write " << tmp << ": " << std::strerror(errno) << "\n";
+    return false;
+  }
+  bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1;
+  if (ok && !entries.empty()) ok = std::fwrite(entries.data(), sizeof(SnapEntry), entries.size(), f) == entries.size();
+  if (ok && !strings.empty()) ok = std::fwrite(strings.data(), 1, strings.size(), f) == strings.size();
+  ok = std::fflush(f) == 0 && ok;
+  ok = ::fsync(fileno(f)) == 0 && ok;
+  ok = std::fclose(f) == 0 && ok;
+  if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+    std::cerr << "[feed_state] write " << path << ": " << std::strerror(errno) << "\n";
+    std::remove(tmp.c_str());
+    return false;
+  }
+  dirty_ = false;
+  return true;
+}
+
+bool FeedStateTable::load(const std::string& path) {
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return false;   // first start
+  struct stat sb{};
+  if (::fstat(fd, &sb) != 0 || (size_t)sb.st_size < sizeof(SnapHeader)) {
+    ::close(fd);
+    std::cerr << "[feed_state] ignoring truncated snapshot " << path << "\n";
+    return false;
+  }
+  const size_t size = (size_t)sb.st_size;
+  void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    std::cerr << "[feed_state] mmap " << path << ": " << std::strerror(errno) << "\n";
+    return false;
+  }
+  const char* base = static_cast<const char*>(map);
+
+  auto reject = [&](const char* why) {
+    std::cerr << "[feed_state] ignoring snapshot " << path << ": " << why << "\n";
+    ::munmap(map, size);
+    return false;
+  };
+  SnapHeader h;
+  std::memcpy(&h, base, sizeof(h));
+  if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0) return reject("bad magic");
+  if (h.version != kVersion) return reject("unsupported version");
+  if (h.entry_size < offsetof(SnapEntry, reserved)) return reject("entry size too small");
+  const size_t avail = size - sizeof(SnapHeader);
+  if (h.count > avail / h.entry_size || h.strings_len != avail - h.count * h.entry_size) {
+    return reject("size mismatch");
+  }
+  const char* ents = base + sizeof(SnapHeader);
+  const char* strs = ents + h.count * h.entry_size;
+  if (fnv1a(kFnvSeed, ents, avail) != h.checksum) return reject("checksum mismatch");   // entries, then strings
+
+  std::unordered_map<std::string, FeedState> loaded;
+  loaded.reserve(h.count);
+  auto str = [&](uint32_t off, uint32_t len, std::string& out) {
+    if ((uint64_t)off + len > h.strings_len) return false;
+    out.assign(strs + off, len);
+    return true;
+  };
+  for (uint64_t i = 0; i < h.count; ++i) {
+    SnapEntry e{};
+    std::memcpy(&e, ents + i * h.entry_size, std::min<size_t>(h.entry_size, sizeof(SnapEntry)));
+    std::string url;
+    FeedState st;
+    if (!str(e.url_off, e.url_len, url) || !str(e.etag_off, e.etag_len, st.etag) ||
+        !str(e.lm_off, e.lm_len, st.last_modified)) {
+      return reject("string out of range");
+    }
+    st.high_water_ms = e.high_water_ms;
+    st.last_fetch_ms = e.last_fetch_ms;
+    st.interval_ms = e.interval_ms;
+    st.retry_at_ms = e.retry_at_ms;
+    st.errors = e.errors;
+    loaded[std::move(url)] = std::move(st);
+  }
+  ::munmap(map, size);
+  states_ = std::move(loaded);
+  dirty_ = false;
+  return true;
+}
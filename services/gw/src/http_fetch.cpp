@@ -43,5 +43,64 @@ std::optional<HttpResponse> http_get(const std::string& url, const HttpOptions&
   std::string effective = eff ? std::string(eff) : url;
 
   curl_easy_cleanup(curl);
-  return HttpResponse{status, std::move(body), std::move(effective)};
+  return HttpResponse{status, std::move(body), std::move(effective), {}, {}};
+}
+
+struct StreamSink {
+  CURL* curl = nullptr;
+  const std::function<bool(const char*, size_t)>* on_chunk = nullptr;
+  bool checked_status = false;
+  bool stopped = false;
+};
+
+static size_t stream_cb(char* ptr, size_t size, size_t nmemb, void* userdata) {
+  auto* sink = reinterpret_cast<StreamSink*>(userdata);
+  size_t total = size * nmemb;
+  if (!sink->checked_status) {
+    sink->checked_status = true;
+    long status = 0;
+    curl_easy_getinfo(sink->curl, CURLINFO_RESPONSE_CODE, &status);
+    if (status < 200 || status >= 300) { sink->stopped = true; return 0; } // error page: don't parse it
+  }
+  if (!(*sink->on_chunk)(ptr, total)) { sink->stopped = true; return 0; }
+  return total;
+}
+
+std::optional<HttpResponse> http_get_stream(const std::string& url, const HttpOptions& opt,
+                                            const std::function<bool(const char*, size_t)>& on_chunk) {
+  CURL* curl = curl_easy_init();
+  if (!curl) return std::nullopt;
+
+  StreamSink sink;
+  sink.curl = curl;
+  sink.on_chunk = &on_chunk;
+  char errbuf[CURL_ERROR_SIZE]; errbuf[0] = 0;
+
+  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, stream_cb);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &sink);
+  curl_easy_setopt(curl, CURLOPT_USERAGENT, opt.user_agent.c_str());
+  curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+  curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 5L);
+  curl_easy_setopt(curl, CURLOPT_TIMEOUT, opt.timeout_secs);
+  curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, errbuf);
+  if (opt.accept_gzip) {
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");  // decompressed incrementally by curl
+  }
+
+  CURLcode res = curl_easy_perform(curl);
+  if (res != CURLE_OK && !(res == CURLE_WRITE_ERROR && sink.stopped)) {
+    std::cerr << "[http] curl error: " << (errbuf[0] ? errbuf : curl_easy_strerror(res)) << "\n";
+    curl_easy_cleanup(curl);
+    return std::nullopt;
+  }
+
+  long status = 0;
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+  char* eff = nullptr;
+  curl_easy_getinfo(curl, CURLINFO_EFFECTIVE_URL, &eff);
+  std::string effective = eff ? std::string(eff) : url;
+
+  curl_easy_cleanup(curl);
+  return HttpResponse{status, std::string(), std::move(effective), {}, {}};
 }
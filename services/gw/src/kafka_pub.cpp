@@ -1,71 +1,444 @@
 #include "kafka_pub.h"
+#include "spool.h"
+#include <google/protobuf/message_lite.h>
 #include <rdkafka.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
 #include <iostream>
+#include <cstdlib>
+#include <condition_variable>
 #include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+int64_t now_us() {
+  using namespace std::chrono;
+  return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Payload buffers for every produce. A buffer is lent to librdkafka (no COPY/FREE
+// flag) and comes back through the delivery report via the per-message opaque,
+// carrying the enqueue time for latency accounting.
+struct PooledBuf {
+  char* data = nullptr;
+  size_t cap = 0;
+  int64_t enqueued_us = 0;
+  bool replay = false;   // sent by the spool replayer
+};
+
+class BufferPool {
+ public:
+  ~BufferPool() {
+    for (auto* b : free_) destroy(b);
+  }
+
+  PooledBuf* acquire(size_t size) {
+    PooledBuf* b = nullptr;
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      if (!free_.empty()) { b = free_.back(); free_.pop_back(); }
+    }
+    if (!b) b = new PooledBuf();
+    if (b->cap < size) {
+      size_t cap = b->cap ? b->cap : 1024;
+      while (cap < size) cap *= 2;
+      std::free(b->data);
+      b->data = static_cast<char*>(std::malloc(cap));
+      b->cap = b->data ? cap : 0;
+      if (!b->data) { delete b; return nullptr; }
+    }
+    return b;
+  }
+
+  void release(PooledBuf* b) {
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      // keep enough for a full in-flight window; beyond that give memory back
+      if (free_.size() < kMaxIdle && b->cap <= kMaxIdleBytes) { free_.push_back(b); return; }
+    }
+    destroy(b);
+  }
+
+ private:
+  static constexpr size_t kMaxIdle = 4096;
+  static constexpr size_t kMaxIdleBytes = 1 << 20;
+  static void destroy(PooledBuf* b) { std::free(b->data); delete b; }
+
+  std::mutex mu_;
+  std::vector<PooledBuf*> free_;
+};
+
+// Failures worth spooling: the broker or cluster is unavailable, not the message bad
+bool retriable(rd_kafka_resp_err_t err) {
+  switch (err) {
+    case RD_KAFKA_RESP_ERR__QUEUE_FULL:
+    case RD_KAFKA_RESP_ERR__MSG_TIMED_OUT:
+    case RD_KAFKA_RESP_ERR__TIMED_OUT:
+    case RD_KAFKA_RESP_ERR__TRANSPORT:
+    case RD_KAFKA_RESP_ERR__ALL_BROKERS_DOWN:
+    case RD_KAFKA_RESP_ERR__PURGE_QUEUE:
+    case RD_KAFKA_RESP_ERR__PURGE_INFLIGHT:
+    case RD_KAFKA_RESP_ERR_REQUEST_TIMED_OUT:
+    case RD_KAFKA_RESP_ERR_NOT_ENOUGH_REPLICAS:
+    case RD_KAFKA_RESP_ERR_NOT_ENOUGH_REPLICAS_AFTER_APPEND:
+    case RD_KAFKA_RESP_ERR_LEADER_NOT_AVAILABLE:
+    case RD_KAFKA_RESP_ERR_NOT_LEADER_FOR_PARTITION:
+    case RD_KAFKA_RESP_ERR_NETWORK_EXCEPTION:
+      return true;
+    default:
+      return false;
+  }
+}
+
+} // namespace
 
 struct KafkaProducer::Impl {
   rd_kafka_conf_t* conf = nullptr;
   rd_kafka_t* rk = nullptr;
   rd_kafka_topic_t* rkt = nullptr;
   std::string topic;
+  int queue_full_max_wait_ms = 5000;
+  BufferPool pool;
+  int event_pipe[2] = {-1, -1};   // main queue io-event: librdkafka writes, the owner's loop reads
+
+  // delivery reports are served on whichever thread polls/flushes (the owner's, or
+  // the replayer's while it waits for a round)
+  std::atomic<uint64_t> delivered{0}, failed{0}, queue_full_waits{0};
+  std::atomic<uint64_t> latency_sum_us{0};
+  std::atomic<uint64_t> latency_hist[32] = {};   // bucket i: latency < 2^i us
+
+  std::unique_ptr<Spool> spool;
+  int replay_batch = 500;
+  std::atomic<uint64_t> spooled{0}, replayed{0};
+  std::atomic<uint64_t> replay_acked{0}, replay_failed{0};   // current round
+  std::mutex replay_mu;
+  std::condition_variable replay_cv;
+  bool replay_stop = false;
+  std::thread replayer;
+
+  bool track_outcomes = false;
+  std::mutex outcome_mu;
+  std::vector<std::string> settled_ok, settled_failed;
+
+  void settle(const void* key, size_t key_len, bool ok) {
+    if (!track_outcomes) return;
+    std::lock_guard<std::mutex> lk(outcome_mu);
+    (ok ? settled_ok : settled_failed).emplace_back(static_cast<const char*>(key), key_len);
+  }
 
-  static void dr_cb(rd_kafka_t*, const rd_kafka_message_t* rkmessage, void*) {
-    if (rkmessage->err) {
+  bool to_spool(const void* key, size_t key_len, const void* val, size_t len) {
+    if (!spool->append(key, key_len, val, len)) {
+      std::cerr << "[kafka] spool full, message dropped\n";
+      return false;
+    }
+    if (spooled++ == 0 || spool->stats().depth_records == 1) {
+      std::cerr << "[kafka] broker unavailable, spooling to disk\n";
+    }
+    replay_cv.notify_one();
+    return true;
+  }
+
+  static void dr_cb(rd_kafka_t*, const rd_kafka_message_t* rkmessage, void* opaque) {
+    auto* self = static_cast<Impl*>(opaque);
+    auto* buf = static_cast<PooledBuf*>(rkmessage->_private);
+    if (buf && buf->replay) {
+      // still in the spool; the replayer rewinds on failure
+      if (rkmessage->err) self->replay_failed++; else self->replay_acked++;
+    } else if (rkmessage->err && self->spool && retriable(rkmessage->err)) {
+      const bool ok = self->to_spool(rkmessage->key, rkmessage->key_len, rkmessage->payload, rkmessage->len);
+      if (!ok) self->failed++;
+      self->settle(rkmessage->key, rkmessage->key_len, ok);
+    } else if (rkmessage->err) {
+      self->failed++;
+      self->settle(rkmessage->key, rkmessage->key_len, false);
       std::cerr << "[kafka] delivery failed: " << rd_kafka_err2str(rkmessage->err) << "\n";
+    } else {
+      self->settle(rkmessage->key, rkmessage->key_len, true);
+    }
+    if (buf) {
+      if (!rkmessage->err) {
+        const uint64_t us = (uint64_t)std::max<int64_t>(0, now_us() - buf->enqueued_us);
+        int b = 0;
+        while (b < 31 && (1ULL << b) <= us) ++b;
+        self->delivered++;
+        self->latency_sum_us += us;
+        self->latency_hist[b]++;
+      }
+      self->pool.release(buf);
+    }
+  }
+
+  // Hands `buf` to librdkafka; on a full local queue serves delivery reports
+  // (which frees queue space) until it fits or queue_full_max_wait_ms passes.
+  bool send(const std::string& key, PooledBuf* buf, size_t len) {
+    if (spool && !spool->empty()) {
+      // a backlog is waiting: queue behind it so replay keeps the order
+      const bool ok = to_spool(key.data(), key.size(), buf->data, len);
+      pool.release(buf);
+      if (ok) settle(key.data(), key.size(), true);
+      return ok;
     }
+    buf->enqueued_us = now_us();
+    buf->replay = false;
+    const int64_t deadline_us = buf->enqueued_us + (int64_t)queue_full_max_wait_ms * 1000;
+    bool waited = false;
+    for (;;) {
+      rd_kafka_resp_err_t err = rd_kafka_producev(
+          rk,
+          RD_KAFKA_V_TOPIC(topic.c_str()),
+          RD_KAFKA_V_MSGFLAGS(0),   // buffer stays ours; released in dr_cb
+          RD_KAFKA_V_VALUE(buf->data, len),
+          RD_KAFKA_V_KEY(const_cast<char*>(key.data()), key.size()),
+          RD_KAFKA_V_OPAQUE(buf),
+          RD_KAFKA_V_END);
+      if (!err) return true;
+      if (err == RD_KAFKA_RESP_ERR__QUEUE_FULL && now_us() < deadline_us) {
+        if (!waited) { waited = true; queue_full_waits++; }
+        rd_kafka_poll(rk, 10);
+        continue;
+      }
+      if (spool && retriable(err)) {
+        const bool ok = to_spool(key.data(), key.size(), buf->data, len);
+        pool.release(buf);
+        if (ok) settle(key.data(), key.size(), true);
+        return ok;
+      }
+      pool.release(buf);
+      std::cerr << "[kafka] produce failed: " << rd_kafka_err2str(err) << "\n";
+      return false;
+    }
+  }
+
+  // Replays the spool in rounds of replay_batch records: when the cluster answers a
+  // metadata request, the next records are produced and the round is committed only
+  // if every one was acknowledged; otherwise it is rewound and retried after a backoff.
+  void replay_main() {
+    int backoff_ms = 500;
+    std::string key, val;
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lk(replay_mu);
+        replay_cv.wait_for(lk, std::chrono::milliseconds(200), [&] { return replay_stop; });
+        if (replay_stop) return;
+      }
+      spool->sync();
+      if (spool->empty()) continue;
+
+      const rd_kafka_metadata_t* md = nullptr;
+      if (rd_kafka_metadata(rk, 0, nullptr, &md, 2000) != RD_KAFKA_RESP_ERR_NO_ERROR) {
+        if (pause(backoff_ms)) return;
+        backoff_ms = std::min(backoff_ms * 2, 30000);
+        continue;
+      }
+      rd_kafka_metadata_destroy(md);
+
+      replay_acked = 0;
+      replay_failed = 0;
+      uint64_t sent = 0;
+      bool send_failed = false;
+      while ((int)sent < replay_batch && spool->peek(key, val)) {
+        PooledBuf* buf = pool.acquire(val.size());
+        if (!buf) { send_failed = true; break; }
+        if (!val.empty()) std::memcpy(buf->data, val.data(), val.size());
+        buf->enqueued_us = now_us();
+        buf->replay = true;
+        rd_kafka_resp_err_t err;
+        while ((err = rd_kafka_producev(rk, RD_KAFKA_V_TOPIC(topic.c_str()), RD_KAFKA_V_MSGFLAGS(0),
+                                        RD_KAFKA_V_VALUE(buf->data, val.size()),
+                                        RD_KAFKA_V_KEY(key.data(), key.size()), RD_KAFKA_V_OPAQUE(buf),
+                                        RD_KAFKA_V_END)) == RD_KAFKA_RESP_ERR__QUEUE_FULL && !stopping()) {
+          rd_kafka_poll(rk, 10);
+        }
+        if (err) { pool.release(buf); send_failed = true; break; }
+        ++sent;
+      }
+      while (replay_acked + replay_failed < sent && !stopping()) rd_kafka_poll(rk, 100);
+
+      if (!send_failed && replay_failed == 0 && replay_acked == sent) {
+        spool->commit();
+        replayed += sent;
+        backoff_ms = 500;
+        if (spool->empty()) std::cerr << "[kafka] spool drained\n";
+      } else {
+        spool->rewind();   // at-least-once: the whole round goes again
+        if (pause(backoff_ms)) return;
+        backoff_ms = std::min(backoff_ms * 2, 30000);
+      }
+    }
+  }
+
+  bool stopping() {
+    std::lock_guard<std::mutex> lk(replay_mu);
+    return replay_stop;
+  }
+
+  // Sleeps up to ms; true if the producer is shutting down
+  bool pause(int ms) {
+    std::unique_lock<std::mutex> lk(replay_mu);
+    return replay_cv.wait_for(lk, std::chrono::milliseconds(ms), [&] { return replay_stop; });
   }
 };
 
+static void conf_set(rd_kafka_conf_t* conf, const char* name, const std::string& value) {
+  char errstr[512];
+  if (rd_kafka_conf_set(conf, name, value.c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK)
+    throw std::runtime_error(std::string("kafka config ") + name + ": " + errstr);
+}
+
 KafkaProducer::KafkaProducer(const KafkaConfig& cfg) : impl_(new Impl()) {
   char errstr[512];
 
   impl_->conf = rd_kafka_conf_new();
   rd_kafka_conf_set_dr_msg_cb(impl_->conf, Impl::dr_cb);
+  rd_kafka_conf_set_opaque(impl_->conf, impl_);
 
   if (rd_kafka_conf_set(impl_->conf, "bootstrap.servers", cfg.bootstrap_servers.c_str(), errstr, sizeof(errstr)) != RD_KAFKA_CONF_OK)
     throw std::runtime_error(errstr);
-  rd_kafka_conf_set(impl_->conf, "acks", cfg.acks.c_str(), errstr, sizeof(errstr));
-  {
-    std::string v = std::to_string(cfg.linger_ms);
-    rd_kafka_conf_set(impl_->conf, "linger.ms", v.c_str(), errstr, sizeof(errstr));
-  }
-  {
-    std::string v = std::to_string(cfg.batch_num_messages);
-    rd_kafka_conf_set(impl_->conf, "batch.num.messages", v.c_str(), errstr, sizeof(errstr));
+
+  std::string acks = cfg.acks;
+  int linger_ms = cfg.linger_ms;
+  int batch_num_messages = cfg.batch_num_messages;
+  std::string compression = "none";
+  bool idempotence = cfg.idempotence;
+  if (cfg.profile == "throughput") {
+    linger_ms = std::max(linger_ms, 50);
+    batch_num_messages = std::max(batch_num_messages, 10000);
+    compression = "zstd";
+    idempotence = true;
+    conf_set(impl_->conf, "batch.size", "1048576");
+  } else if (cfg.profile == "latency") {
+    linger_ms = 1;
+  } else if (!cfg.profile.empty()) {
+    throw std::runtime_error("unknown kafka producer profile: " + cfg.profile);
   }
+  if (!cfg.compression.empty()) compression = cfg.compression;
+  if (idempotence) acks = "all";   // required by enable.idempotence
+
+  conf_set(impl_->conf, "acks", acks);
+  conf_set(impl_->conf, "linger.ms", std::to_string(linger_ms));
+  conf_set(impl_->conf, "batch.num.messages", std::to_string(batch_num_messages));
+  conf_set(impl_->conf, "compression.type", compression);
+  conf_set(impl_->conf, "enable.idempotence", idempotence ? "true" : "false");
+  impl_->queue_full_max_wait_ms = std::max(0, cfg.queue_full_max_wait_ms);
+  impl_->track_outcomes = cfg.track_outcomes;
 
   impl_->rk = rd_kafka_new(RD_KAFKA_PRODUCER, impl_->conf, errstr, sizeof(errstr));
   if (!impl_->rk) throw std::runtime_error(std::string("rd_kafka_new failed: ") + errstr);
 
   impl_->topic = cfg.topic;
+
+  if (!cfg.spool_dir.empty()) {
+    SpoolConfig scfg;
+    scfg.dir = cfg.spool_dir;
+    scfg.segment_bytes = cfg.spool_segment_bytes;
+    scfg.max_bytes = cfg.spool_max_bytes;
+    scfg.sync_ms = cfg.spool_sync_ms;
+    impl_->spool = std::make_unique<Spool>(scfg);
+    impl_->replay_batch = std::max(1, cfg.spool_replay_batch);
+    impl_->replayer = std::thread([this] { impl_->replay_main(); });
+  }
 }
 
 KafkaProducer::~KafkaProducer() {
   if (impl_) {
+    if (impl_->replayer.joinable()) {
+      {
+        std::lock_guard<std::mutex> lk(impl_->replay_mu);
+        impl_->replay_stop = true;
+      }
+      impl_->replay_cv.notify_all();
+      impl_->replayer.join();
+    }
     if (impl_->rk) {
       rd_kafka_flush(impl_->rk, 2000);
+      if (impl_->spool) {
+        // whatever is still queued fails with a purge error and lands in the spool
+        rd_kafka_purge(impl_->rk, RD_KAFKA_PURGE_F_QUEUE | RD_KAFKA_PURGE_F_INFLIGHT);
+        rd_kafka_poll(impl_->rk, 0);
+      }
       rd_kafka_destroy(impl_->rk);
     }
+    impl_->spool.reset();
+    for (int fd : impl_->event_pipe) if (fd >= 0) close(fd);
     delete impl_;
   }
 }
 
 bool KafkaProducer::produce(const std::string& key, const void* payload, size_t len) {
-  rd_kafka_resp_err_t err = rd_kafka_producev(
-      impl_->rk,
-      RD_KAFKA_V_TOPIC(impl_->topic.c_str()),
-      RD_KAFKA_V_MSGFLAGS(RD_KAFKA_MSG_F_COPY),
-      RD_KAFKA_V_VALUE(const_cast<void*>(payload), len),
-      RD_KAFKA_V_KEY(const_cast<char*>(key.data()), key.size()),
-      RD_KAFKA_V_END);
-
-  if (err) {
-    std::cerr << "[kafka] produce failed: " << rd_kafka_err2str(err) << "\n";
-    return false;
-  }
-  return true;
+  PooledBuf* buf = impl_->pool.acquire(len);
+  if (!buf) return false;
+  if (len) std::memcpy(buf->data, payload, len);
+  return impl_->send(key, buf, len);
+}
+
+bool KafkaProducer::produce_message(const std::string& key, const google::protobuf::MessageLite& msg) {
+  const size_t len = msg.ByteSizeLong();
+  PooledBuf* buf = impl_->pool.acquire(len);
+  if (!buf) return false;
+  msg.SerializeWithCachedSizesToArray(reinterpret_cast<uint8_t*>(buf->data));
+  return impl_->send(key, buf, len);
 }
 
 void KafkaProducer::flush(int timeout_ms) {
   rd_kafka_flush(impl_->rk, timeout_ms);
 }
+
+void KafkaProducer::poll(int timeout_ms) {
+  rd_kafka_poll(impl_->rk, timeout_ms);
+}
+
+void KafkaProducer::take_outcomes(std::vector<std::string>& delivered, std::vector<std::string>& failed) {
+  delivered.clear();
+  failed.clear();
+  std::lock_guard<std::mutex> lk(impl_->outcome_mu);
+  delivered.swap(impl_->settled_ok);
+  failed.swap(impl_->settled_failed);
+}
+
+int KafkaProducer::event_fd() {
+  if (impl_->event_pipe[0] >= 0) return impl_->event_pipe[0];
+  if (pipe2(impl_->event_pipe, O_NONBLOCK | O_CLOEXEC) != 0) {
+    std::cerr << "[kafka] event pipe: " << std::strerror(errno) << "\n";
+    impl_->event_pipe[0] = impl_->event_pipe[1] = -1;
+    return -1;
+  }
+  // librdkafka writes one byte whenever the main queue (delivery reports) goes non-empty
+  rd_kafka_queue_t* q = rd_kafka_queue_get_main(impl_->rk);
+  rd_kafka_queue_io_event_enable(q, impl_->event_pipe[1], "1", 1);
+  rd_kafka_queue_destroy(q);
+  return impl_->event_pipe[0];
+}
+
+KafkaProducerStats KafkaProducer::stats() const {
+  KafkaProducerStats st;
+  st.delivered = impl_->delivered.load();
+  st.failed = impl_->failed.load();
+  st.queue_full_waits = impl_->queue_full_waits.load();
+  if (impl_->spool) {
+    const SpoolStats ss = impl_->spool->stats();
+    st.spooled = impl_->spooled.load();
+    st.replayed = impl_->replayed.load();
+    st.spool_rejected = ss.rejected;
+    st.spool_alloc_failed = ss.alloc_failed;
+    st.spool_depth = ss.depth_records;
+    st.spool_bytes = ss.depth_bytes;
+  }
+  if (st.delivered > 0) {
+    st.avg_latency_ms = impl_->latency_sum_us.load() / 1000.0 / st.delivered;
+    const uint64_t rank = st.delivered - st.delivered / 100;   // p99
+    uint64_t seen = 0;
+    for (int b = 0; b < 32; ++b) {
+      seen += impl_->latency_hist[b].load();
+      if (seen >= rank) { st.p99_latency_ms = (double)(1ULL << b) / 1000.0; break; }
+    }
+  }
+  return st;
+}
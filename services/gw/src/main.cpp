@@ -1,11 +1,13 @@
 #include <absl/strings/str_format.h>
 #include <fmt/core.h>
 #include <nlohmann/json.hpp>
-#include <xxhash.h>
+#include <atomic>
 #include <chrono>
 #include <csignal>
+#include <functional>
 #include <iostream>
-#include <thread>
+#include <memory>
+#include <set>
 #include <string>
 #include <unordered_map>
 
@@ -16,6 +18,20 @@
 #include "kafka_pub.h"
 #include "config.h"
 #include "yahoo_html.h"
+#include "url_merge.h"
+#include "feed_shard.h"
+#include "config_watch.h"
+#include "event_loop.h"
+#include "async_http.h"
+#include "async_dedup.h"
+#include "task_sched.h"
+#include "feed_state.h"
+#include "feed_health.h"
+#include "metrics_server.h"
+
+#include <libxml/parser.h>
+#include <sys/epoll.h>
+#include <unistd.h>
 
 // Protobuf
 #include "news.pb.h"
@@ -28,15 +44,6 @@ static long long NowMs() {
   return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
 }
 
-static std::string stable_id(const std::string& source, const std::string& normalized_url) {
-  std::string key = source;
-  key.append("|").append(normalized_url);
-  unsigned long long h = XXH64(key.data(), key.size(), 0);
-  char buf[32];
-  snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)h);
-  return std::string(buf);
-}
-
 static std::string replace_all(std::string s, const std::string& from, const std::string& to) {
   size_t pos = 0;
   while ((pos = s.find(from, pos)) != std::string::npos) {
@@ -46,6 +53,60 @@ static std::string replace_all(std::string s, const std::string& from, const std
   return s;
 }
 
+// Everything the poll loop reads that may change on reload. Published as an
+// immutable snapshot; a cycle keeps the snapshot it started with, so a reload
+// never stalls or tears in-flight fetches.
+struct GwSettings {
+  AppConfig app;
+  RssConfig rss;          // rss.yml feeds + generated Yahoo RSS feeds
+  HttpOptions httpopt;
+  YahooHtmlConfig yhcfg;
+  bool yahoo_allowed = true;
+};
+
+static std::shared_ptr<const GwSettings> make_settings(AppConfig app, RssConfig rss, const GwSettings* prev) {
+  auto st = std::make_shared<GwSettings>();
+
+  // Optionally append Yahoo Finance RSS feeds per ticker
+  if (app.yahoo.enable_rss && !app.yahoo.rss_url_template.empty() && !app.yahoo.tickers.empty()) {
+    for (const auto& t : app.yahoo.tickers) {
+      std::string url = replace_all(app.yahoo.rss_url_template, "{TICKER}", t);
+      rss.feeds.push_back(Feed{ "YahooFinanceRSS:" + t, url });
+    }
+    fmt::print("[news_gw] Yahoo RSS enabled: +{} feeds from tickers list\n", app.yahoo.tickers.size());
+  }
+
+  // HTTP options
+  st->httpopt.user_agent  = app.ingest.user_agent.empty() ? rss.user_agent : app.ingest.user_agent;
+  st->httpopt.timeout_secs = app.ingest.http_timeout_secs;
+
+  // Prepare Yahoo HTML config
+  st->yhcfg.url_template = app.yahoo.html_url_template;
+  st->yhcfg.robots_url = app.yahoo.robots_url;
+  st->yhcfg.user_agent = st->httpopt.user_agent;
+  st->yhcfg.http_timeout_secs = st->httpopt.timeout_secs;
+  st->yhcfg.min_seconds_between_requests = app.yahoo.min_seconds_between_requests;
+  st->yhcfg.max_links_per_page = app.yahoo.max_links_per_page;
+  st->yhcfg.mode = app.yahoo.html_mode == "anchors" ? YahooHtmlMode::Anchors : YahooHtmlMode::EmbeddedJson;
+
+  if (app.yahoo.enable_html) {
+    if (prev && prev->app.yahoo.enable_html && prev->yhcfg.robots_url == st->yhcfg.robots_url) {
+      st->yahoo_allowed = prev->yahoo_allowed;   // don't re-fetch robots.txt on every reload
+    } else {
+      st->yahoo_allowed = yahoo_html_robots_allows(st->yhcfg);
+      if (!st->yahoo_allowed) {
+        fmt::print("[news_gw] Yahoo HTML adapter disabled by robots.txt\n");
+      } else {
+        fmt::print("[news_gw] Yahoo HTML adapter enabled for {} tickers\n", app.yahoo.tickers.size());
+      }
+    }
+  }
+
+  st->app = std::move(app);
+  st->rss = std::move(rss);
+  return st;
+}
+
 int main(int argc, char** argv) {
   std::signal(SIGINT, handle_sigint);
   std::signal(SIGTERM, handle_sigint);
@@ -59,21 +120,7 @@ int main(int argc, char** argv) {
   AppConfig app = load_app_config(app_cfg_path);
   RssConfig rss = load_rss_config(rss_cfg_path);
 
-  // Optionally append Yahoo Finance RSS feeds per ticker
-  std::vector<Feed> yahooFeeds;
-  if (app.yahoo.enable_rss && !app.yahoo.rss_url_template.empty() && !app.yahoo.tickers.empty()) {
-    for (const auto& t : app.yahoo.tickers) {
-      std::string url = replace_all(app.yahoo.rss_url_template, "{TICKER}", t);
-      yahooFeeds.push_back(Feed{ "YahooFinanceRSS:" + t, url });
-    }
-    rss.feeds.insert(rss.feeds.end(), yahooFeeds.begin(), yahooFeeds.end());
-    fmt::print("[news_gw] Yahoo RSS enabled: +{} feeds from tickers list\n", yahooFeeds.size());
-  }
-
-  // HTTP options
-  HttpOptions httpopt;
-  httpopt.user_agent  = app.ingest.user_agent.empty() ? rss.user_agent : app.ingest.user_agent;
-  httpopt.timeout_secs = app.ingest.http_timeout_secs;
+  std::atomic<std::shared_ptr<const GwSettings>> settings{make_settings(app, rss, nullptr)};
 
   // Dedup config
   DedupConfig dcfg;
@@ -81,6 +128,8 @@ int main(int argc, char** argv) {
   dcfg.port = app.redis.port;
   dcfg.db   = app.redis.db;
   dcfg.ttl_seconds = app.redis.dedup_ttl_seconds;
+  dcfg.reserve_seconds = app.redis.dedup_reserve_seconds;
+  dcfg.command_timeout_ms = app.redis.command_timeout_ms;
 
   // Kafka
   KafkaConfig kcfg;
@@ -89,129 +138,549 @@ int main(int argc, char** argv) {
   kcfg.acks                = app.kafka.acks;
   kcfg.linger_ms           = app.kafka.linger_ms;
   kcfg.batch_num_messages  = app.kafka.batch_num_messages;
+  kcfg.profile             = app.kafka.producer_profile;
+  kcfg.compression         = app.kafka.compression;
+  kcfg.idempotence         = app.kafka.idempotence;
+  kcfg.queue_full_max_wait_ms = app.kafka.queue_full_max_wait_ms;
+  kcfg.track_outcomes = dcfg.reserve_seconds > 0;   // two-phase dedup below
+  if (app.kafka.spool_enable) {
+    kcfg.spool_dir = app.kafka.spool_dir + "/" + kcfg.topic;
+    kcfg.spool_segment_bytes = (size_t)app.kafka.spool_segment_mb << 20;
+    kcfg.spool_max_bytes = (size_t)app.kafka.spool_max_mb << 20;
+    kcfg.spool_sync_ms = app.kafka.spool_sync_ms;
+  }
 
   KafkaProducer producer(kcfg);
 
-  // Prepare Yahoo HTML config
-  YahooHtmlConfig yhcfg;
-  yhcfg.url_template = app.yahoo.html_url_template;
-  yhcfg.robots_url = app.yahoo.robots_url;
-  yhcfg.user_agent = httpopt.user_agent;
-  yhcfg.http_timeout_secs = httpopt.timeout_secs;
-  yhcfg.min_seconds_between_requests = app.yahoo.min_seconds_between_requests;
-  yhcfg.max_links_per_page = app.yahoo.max_links_per_page;
+  // Feed sharding across news_gw instances
+  ShardConfig shcfg;
+  shcfg.enable = app.shard.enable;
+  shcfg.redis_host = app.redis.host;
+  shcfg.redis_port = app.redis.port;
+  shcfg.redis_db = app.redis.db;
+  shcfg.instance_id = app.shard.instance_id;
+  shcfg.members_key = app.shard.members_key;
+  shcfg.lease_ttl_secs = app.shard.lease_ttl_secs;
+  shcfg.vnodes = app.shard.vnodes;
+  FeedSharder sharder(shcfg);
+  if (shcfg.enable) {
+    fmt::print("[news_gw] Sharding enabled: instance='{}' members_key='{}'\n",
+               sharder.instance_id(), shcfg.members_key);
+  }
+  auto shard_heartbeat = [&]() {
+    if (sharder.heartbeat()) {
+      size_t owned = 0;
+      const auto cfg = settings.load();
+      for (const auto& f : cfg->rss.feeds) owned += sharder.owns(f.url) ? 1 : 0;
+      fmt::print("[news_gw] Shard rebalance: {} live instances, this one owns {}/{} RSS feeds\n",
+                 sharder.members().size(), owned, cfg->rss.feeds.size());
+    }
+  };
+
+  // Hot reload (SIGHUP or file change): validate, diff, swap the snapshot. Feeds
+  // that stay keep their state (rate limits); added ones are picked up next cycle.
+  ConfigWatcher watcher({app_cfg_path, rss_cfg_path});
+  auto maybe_reload = [&]() {
+    if (!watcher.poll()) return;
+    try {
+      AppConfig next_app = load_app_config(app_cfg_path);
+      RssConfig next_rss = load_rss_config(rss_cfg_path);
+      auto errs = validate_app_config(next_app);
+      auto rss_errs = validate_rss_config(next_rss);
+      errs.insert(errs.end(), rss_errs.begin(), rss_errs.end());
+      if (!errs.empty()) {
+        for (const auto& e : errs) fmt::print("[news_gw] Reload rejected: {}\n", e);
+        return;
+      }
+      if (next_app.kafka.bootstrap_servers != app.kafka.bootstrap_servers ||
+          next_app.kafka.topic_raw != app.kafka.topic_raw || next_app.redis.host != app.redis.host ||
+          next_app.redis.port != app.redis.port || next_app.shard.enable != app.shard.enable ||
+          next_app.ingest.max_concurrent_fetches != app.ingest.max_concurrent_fetches ||
+          next_app.ingest.max_host_connections != app.ingest.max_host_connections ||
+          next_app.ingest.parse_threads != app.ingest.parse_threads ||
+          next_app.ingest.parse_pinning != app.ingest.parse_pinning) {
+        fmt::print("[news_gw] Reload: kafka/redis/shard/connection/thread changes need a restart; "
+                   "applying the rest\n");
+      }
 
-  bool yahoo_allowed = true;
-  if (app.yahoo.enable_html) {
-    yahoo_allowed = yahoo_html_robots_allows(yhcfg);
-    if (!yahoo_allowed) {
-      fmt::print("[news_gw] Yahoo HTML adapter disabled by robots.txt\n");
-    } else {
-      fmt::print("[news_gw] Yahoo HTML adapter enabled for {} tickers\n", app.yahoo.tickers.size());
+      auto prev = settings.load();
+      auto next = make_settings(std::move(next_app), std::move(next_rss), prev.get());
+      std::set<std::string> before, after;
+      for (const auto& f : prev->rss.feeds) before.insert(f.url);
+      for (const auto& f : next->rss.feeds) after.insert(f.url);
+      size_t added = 0, removed = 0;
+      for (const auto& f : next->rss.feeds) {
+        if (!before.count(f.url)) { ++added; fmt::print("[news_gw] Reload: + {} {}\n", f.source, f.url); }
+      }
+      for (const auto& f : prev->rss.feeds) {
+        if (!after.count(f.url)) { ++removed; fmt::print("[news_gw] Reload: - {} {}\n", f.source, f.url); }
+      }
+      settings.store(std::move(next));
+      fmt::print("[news_gw] Reloaded config: {} feeds (+{} -{})\n", after.size(), added, removed);
+    } catch (const std::exception& e) {
+      fmt::print("[news_gw] Reload failed, keeping current config: {}\n", e.what());
+    }
+  };
+
+  // Everything below runs on one event loop: fetches (curl multi), dedup (hiredis
+  // async) and Kafka delivery reports are multiplexed; parsing goes to parse_pool.
+  xmlInitParser();   // once, before libxml2 is used from the parse workers
+  EventLoop loop;
+  AsyncHttp http(loop, app.ingest.max_concurrent_fetches, app.ingest.max_host_connections);
+  AsyncDedup dedup(loop, dcfg);
+
+  // Fetch health per feed and host: breakers skip dead hosts, timeouts follow each
+  // host's observed p99 (restart to change)
+  HealthConfig hcfg;
+  hcfg.breaker_failures = app.health.breaker_failures;
+  hcfg.breaker_base_ms = (int64_t)app.health.breaker_base_secs * 1000;
+  hcfg.breaker_max_ms = (int64_t)app.health.breaker_max_secs * 1000;
+  hcfg.jitter = app.health.jitter;
+  hcfg.timeout_p99_factor = app.health.timeout_p99_factor;
+  hcfg.timeout_min_ms = app.health.timeout_min_ms;
+  hcfg.timeout_min_samples = app.health.timeout_min_samples;
+  HealthTable health(hcfg);
+  TaskSchedConfig scfg;
+  scfg.workers = (size_t)app.ingest.parse_threads;
+  scfg.pinning = app.ingest.parse_pinning;
+  TaskScheduler parse_pool(scfg);
+
+  // Per-URL fetch state (validators, high-water marks, adaptive intervals, backoff),
+  // warm-started from the last snapshot so a restart neither refetches every feed at
+  // once nor hands already seen items to dedup again
+  FeedStateTable feed_state;
+  const std::string state_path = app.ingest.state_path;
+  if (!state_path.empty()) {
+    const auto t0 = std::chrono::steady_clock::now();
+    if (feed_state.load(state_path)) {
+      fmt::print("[news_gw] Warm start: {} feed states from {} in {:.2f}ms\n", feed_state.size(), state_path,
+                 std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
     }
   }
-
-  // Track last fetch time so we don't hammer the host
-  std::unordered_map<std::string, long long> last_fetch_ms;
-
-  fmt::print("[news_gw] Starting poll loop (every {}s) with {} RSS feeds\n",
-             rss.interval_secs, rss.feeds.size());
-
-  while (!g_stop) {
-    auto t_start = std::chrono::steady_clock::now();
-
-    // --- RSS path ---
-    for (const auto& f : rss.feeds) {
-      auto resp = http_get(f.url, httpopt);
-      if (!resp || resp->status < 200 || resp->status >= 300) {
-        fmt::print("[news_gw] WARN fetch failed source={} url={} status={}\n",
-                   f.source, f.url, (resp ? resp->status : -1));
-        continue;
+  auto feed_policy = [](const GwSettings& s) {
+    FeedPolicy p;
+    p.base_interval_ms = (int64_t)s.rss.interval_secs * 1000;
+    p.max_interval_ms = p.base_interval_ms * s.app.ingest.max_interval_factor;
+    p.max_backoff_ms = (int64_t)s.app.ingest.max_backoff_secs * 1000;
+    p.breaker_failures = s.app.health.breaker_failures;
+    p.jitter = s.app.health.jitter;
+    return p;
+  };
+  // Two-phase dedup: a published URL holds a short reservation until Kafka confirms
+  // it; each batch of delivery reports becomes one pipelined Redis write that extends
+  // the delivered keys to the full TTL and drops the failed ones.
+  const bool two_phase = dcfg.reserve_seconds > 0;
+  std::vector<std::string> acked, lost;
+  uint64_t dedup_confirmed = 0, dedup_released = 0;
+  // A released key is only retried if the feeds that listed the item offer it again,
+  // so their fetch state is rewound (see FeedStateTable::rewind)
+  struct Origin {
+    std::vector<std::string> feeds;
+    int64_t published_ts_ms = 0;
+  };
+  std::unordered_map<std::string, Origin> unsettled;   // url id -> origin, until Kafka settles it
+  auto rewind_feeds = [&](const Origin& o) {
+    for (const auto& f : o.feeds) feed_state.rewind(f, o.published_ts_ms);
+  };
+  auto settle_dedup = [&]() {
+    if (!two_phase) return;
+    producer.take_outcomes(acked, lost);
+    for (const auto& k : acked) unsettled.erase(k);
+    for (const auto& k : lost) {
+      if (auto it = unsettled.find(k); it != unsettled.end()) {
+        rewind_feeds(it->second);
+        unsettled.erase(it);
       }
+    }
+    for (auto& k : acked) k.insert(0, "dedup:url:");
+    for (auto& k : lost) k.insert(0, "dedup:url:");
+    dedup.confirm(acked);
+    dedup.release(lost);
+    dedup_confirmed += acked.size();
+    dedup_released += lost.size();
+  };
+
+  const int kafka_fd = producer.event_fd();
+  if (kafka_fd >= 0) {
+    loop.watch(kafka_fd, EPOLLIN, [&](uint32_t) {
+      char buf[64];
+      while (read(kafka_fd, buf, sizeof(buf)) > 0) {}
+      producer.poll(0);
+      settle_dedup();
+    });
+  }
 
-      auto items = parse_feed_xml(resp->body);
-      fmt::print("[news_gw] {}: parsed {} RSS items\n", f.source, items.size());
-
-      for (auto& it : items) {
-        std::string norm = normalize_url(it.link);
-        std::string id = stable_id(f.source, norm);
-        std::string dedup_key = "dedup:" + id;
-
-        if (!dedup_setnx(dcfg, dedup_key)) continue;
-
-        finnews::ArticleRaw raw;
-        raw.set_id(id);
-        raw.set_source(f.source);
-        raw.set_url(norm);
-        raw.set_title(it.title);
-        raw.set_body("");
-        raw.set_published_ts(it.published_ts_ms);
-        raw.set_ingested_ts(NowMs());
+  int64_t state_saved_ms = EventLoop::now_ms();
+  auto save_state = [&](bool force) {
+    if (state_path.empty() || !feed_state.dirty()) return;
+    const auto cfg = settings.load();
+    if (!force && EventLoop::now_ms() - state_saved_ms < (int64_t)cfg->app.ingest.state_snapshot_secs * 1000) return;
+    std::set<std::string> polled;   // drop state of feeds removed by a reload
+    for (const auto& f : cfg->rss.feeds) polled.insert(f.url);
+    for (const auto& t : cfg->app.yahoo.tickers) polled.insert(yahoo_html_url_for(t, cfg->yhcfg));
+    feed_state.prune([&](const std::string& url) { return polled.count(url) > 0; });
+    // feeds with items still awaiting a delivery report are saved as if released
+    std::unordered_map<std::string, int64_t> pending;
+    for (const auto& [id, o] : unsettled) {
+      for (const auto& f : o.feeds) {
+        auto [it, fresh] = pending.try_emplace(f, o.published_ts_ms);
+        if (!fresh && o.published_ts_ms > 0 && (it->second == 0 || o.published_ts_ms < it->second))
+          it->second = o.published_ts_ms;
+      }
+    }
+    feed_state.save(state_path, pending);
+    state_saved_ms = EventLoop::now_ms();
+  };
+
+  fmt::print("[news_gw] Starting event loop (cycle every {}s) with {} RSS feeds, "
+             "{} connections, {} parse threads\n",
+             settings.load()->rss.interval_secs, settings.load()->rss.feeds.size(),
+             app.ingest.max_concurrent_fetches, app.ingest.parse_threads);
+
+  // Items from every feed in a cycle are folded by normalized URL before dedup/publish
+  UrlMerger merger;
+  finnews::ArticleRaw raw;   // reused across items; Clear() keeps field capacity
+
+  // One cycle: start every owned fetch at once, merge results as they come back, and
+  // publish after the last one. Cycle time is bounded by the slowest fetch, not by the
+  // number of feeds; hosts with an open breaker are not fetched and the others time
+  // out after their adaptive timeout.
+  struct Cycle {
+    std::shared_ptr<const GwSettings> cfg;   // snapshot for the whole cycle
+    int64_t started_ms = 0;
+    size_t outstanding = 0;                  // fetches/parses not merged yet
+    FeedPolicy policy;
+    size_t fetches = 0, failed = 0, not_modified = 0, not_due = 0, breaker_open = 0;
+  };
+  Cycle cyc;
+  int64_t last_cycle_ms = 0;
+  const GwSettings* health_pruned_for = nullptr;
+  std::function<void()> start_cycle;
+
+  auto end_cycle = [&](size_t published, size_t folded) {
+    const int64_t elapsed = EventLoop::now_ms() - cyc.started_ms;
+    if (folded > 0 || published > 0) {
+      fmt::print("[news_gw] cycle: published {} articles ({} cross-source duplicates folded)\n",
+                 published, folded);
+    }
+    fmt::print("[news_gw] cycle: {} fetches ({} failed, {} not modified, {} not due, {} behind open breakers) in {}ms\n",
+               cyc.fetches, cyc.failed, cyc.not_modified, cyc.not_due, cyc.breaker_open, elapsed);
+    last_cycle_ms = elapsed;
+    if (health_pruned_for != cyc.cfg.get()) {   // a reload may have dropped feeds
+      std::vector<std::string> polled;
+      for (const auto& f : cyc.cfg->rss.feeds) polled.push_back(f.url);
+      for (const auto& t : cyc.cfg->app.yahoo.tickers) polled.push_back(yahoo_html_url_for(t, cyc.cfg->yhcfg));
+      health.prune(polled);
+      health_pruned_for = cyc.cfg.get();
+    }
+    const auto ks = producer.stats();
+    if (ks.delivered > 0 || ks.failed > 0) {
+      fmt::print("[news_gw] kafka: delivered={} failed={} queue_full={} avg={:.1f}ms p99<={:.1f}ms\n",
+                 ks.delivered, ks.failed, ks.queue_full_waits, ks.avg_latency_ms, ks.p99_latency_ms);
+    }
+    if (dedup_confirmed > 0 || dedup_released > 0) {
+      fmt::print("[news_gw] dedup: confirmed={} released={}\n", dedup_confirmed, dedup_released);
+    }
+    if (ks.spooled > 0 || ks.spool_alloc_failed > 0) {
+      fmt::print("[news_gw] spool: depth={} ({} KB) spooled={} replayed={} dropped={} alloc_failed={}\n",
+                 ks.spool_depth, ks.spool_bytes / 1024, ks.spooled, ks.replayed, ks.spool_rejected,
+                 ks.spool_alloc_failed);
+    }
+    for (const auto& t : parse_pool.timings()) {
+      fmt::print("[news_gw] parse {}: n={} avg={:.2f}ms p99<={:.2f}ms max={:.1f}ms wait={:.2f}ms steals={}\n",
+                 t.kind, t.count, t.avg_ms, t.p99_ms, t.max_ms, t.avg_wait_ms, parse_pool.steals());
+    }
+    const int64_t next_in = std::max<int64_t>(1000, (int64_t)cyc.cfg->rss.interval_secs * 1000 - elapsed);
+    cyc.cfg.reset();
+    loop.add_timer(next_in, [&] { start_cycle(); });
+  };
+
+  // --- URL-level dedup + publish (one ArticleRaw per URL, all sources attached) ---
+  auto publish_cycle = [&]() {
+    const size_t folded = merger.merged_count();
+    auto articles = merger.take();
+    if (articles.empty()) { end_cycle(0, folded); return; }
+
+    struct Publish { size_t remaining = 0, published = 0, folded = 0; };
+    auto pub = std::make_shared<Publish>(Publish{articles.size(), 0, folded});
+    for (auto& a : articles) {
+      std::string id = url_id(a.url);
+      // SET NX replies arrive in order; all of a cycle's lookups share one pipelined write.
+      // With two-phase dedup this only reserves the URL (see settle_dedup).
+      dedup.setnx("dedup:url:" + id, [&, id, a = std::move(a), pub](bool is_new) {
+        if (is_new) {
+          raw.Clear();
+          raw.set_id(id);
+          raw.set_source(a.sources.front());
+          raw.set_url(a.url);
+          raw.set_title(a.title);
+          raw.set_body("");
+          raw.set_published_ts(a.published_ts_ms);
+          raw.set_ingested_ts(NowMs());
+          for (auto& s : a.sources) raw.add_sources(s);
+          if (producer.produce_message(id, raw)) {
+            ++pub->published;
+            if (two_phase) unsettled[id] = Origin{a.feeds, a.published_ts_ms};
+          } else if (two_phase) {
+            dedup.release({"dedup:url:" + id});   // retry next cycle
+            rewind_feeds(Origin{a.feeds, a.published_ts_ms});
+          }
+        }
+        if (--pub->remaining == 0) end_cycle(pub->published, pub->folded);
+      });
+    }
+  };
+
+  auto task_done = [&]() {
+    if (--cyc.outstanding == 0) publish_cycle();
+  };
+
+  // True when there is a body to parse; 304s and failures are recorded here, and
+  // every outcome goes into the health table
+  auto fetch_ok = [&](const std::optional<HttpResponse>& resp, const std::string& what,
+                      const std::string& url, const FeedPolicy& policy, int64_t started_ms) {
+    ++cyc.fetches;
+    health.record(url, url_host(url), resp ? (int)resp->status : 0,
+                  (double)(EventLoop::now_ms() - started_ms), NowMs());
+    if (resp && resp->status >= 200 && resp->status < 300) return true;
+    if (resp && resp->status == 304) {
+      ++cyc.not_modified;
+      feed_state.on_not_modified(url, policy);
+      return false;
+    }
+    ++cyc.failed;
+    feed_state.on_error(url, NowMs(), policy);
+    fmt::print("[news_gw] WARN fetch failed {} url={} status={}\n", what, url, (resp ? resp->status : -1));
+    return false;
+  };
+
+  // Items dated well below the feed's high-water mark were published in an earlier
+  // cycle (or before a restart) and skip dedup; undated items always go through, and
+  // so do items dated past the ceiling (now + max_future_ms), which never raise the mark
+  struct HighWater {
+    int64_t mark = 0, floor = 0, ceiling = 0, newest = 0;
+    size_t fresh = 0, skipped = 0;
+    bool keep(int64_t ts) {
+      if (ts > 0 && ts < floor) { ++skipped; return false; }
+      if (ts == 0 || ts > mark) ++fresh;
+      if (ts <= ceiling) newest = std::max(newest, ts);
+      return true;
+    }
+  };
+  auto high_water = [&](const std::string& url, const FeedPolicy& policy) {
+    HighWater hw;
+    hw.ceiling = NowMs() + policy.max_future_ms;
+    if (const FeedState* st = feed_state.find(url); st && st->high_water_ms > 0) {
+      hw.mark = std::min<int64_t>(st->high_water_ms, hw.ceiling);
+      hw.floor = hw.mark - (int64_t)cyc.cfg->app.ingest.high_water_slack_secs * 1000;
+    }
+    return hw;
+  };
+
+  auto merge_rss = [&](const std::string& url, const std::string& source, const std::vector<FeedItem>& items,
+                       const HttpResponse& resp) {
+    HighWater hw = high_water(url, cyc.policy);
+    for (auto& it : items) {
+      if (hw.keep(it.published_ts_ms)) merger.add(source, url, normalize_url(it.link), it.title, it.published_ts_ms);
+    }
+    fmt::print("[news_gw] {}: parsed {} RSS items ({} new, {} below high-water)\n",
+               source, items.size(), hw.fresh, hw.skipped);
+    feed_state.on_fetched(url, resp.etag, resp.last_modified, hw.newest, hw.fresh, NowMs(), cyc.policy);
+  };
+
+  auto merge_yahoo = [&](const std::string& url, const std::string& tkr, const std::vector<YahooHtmlItem>& items,
+                         const HttpResponse& resp, const FeedPolicy& policy) {
+    HighWater hw = high_water(url, policy);
+    size_t timed = 0;
+    const std::string source = "YahooFinanceHTML:" + tkr;
+    for (auto& it : items) {
+      timed += it.published_ts_ms > 0;
+      if (!hw.keep(it.published_ts_ms)) continue;
+      merger.add(source, url, normalize_url(it.url), it.title, it.published_ts_ms);   // 0 (anchor) = unknown
+    }
+    fmt::print("[news_gw] YahooHTML:{}: extracted {} links ({} with publish time, {} below high-water)\n",
+               tkr, items.size(), timed, hw.skipped);
+    feed_state.on_fetched(url, resp.etag, resp.last_modified, hw.newest, hw.fresh, NowMs(), policy);
+  };
+
+  // Validators from the last 200, so unchanged feeds answer 304 with no body, and
+  // the host's adaptive timeout
+  auto request_options = [&](const HttpOptions& base, const std::string& url, const std::string& host) {
+    HttpOptions opt = base;
+    opt.timeout_ms = health.timeout_ms(host, (int64_t)base.timeout_secs * 1000);
+    if (const FeedState* st = feed_state.find(url)) {
+      opt.if_none_match = st->etag;
+      opt.if_modified_since = st->last_modified;
+    }
+    return opt;
+  };
+
+  start_cycle = [&]() {
+    if (g_stop) return;
+    maybe_reload();
+    shard_heartbeat();
+    cyc.cfg = settings.load();   // this cycle's snapshot
+    cyc.started_ms = EventLoop::now_ms();
+    cyc.policy = feed_policy(*cyc.cfg);
+    cyc.fetches = cyc.failed = cyc.not_modified = cyc.not_due = cyc.breaker_open = 0;
+    cyc.outstanding = 1;         // held until every fetch is issued
+    const auto& cfg = cyc.cfg;
 
-        std::string bytes;
-        if (!raw.SerializeToString(&bytes)) continue;
-        producer.produce(id, bytes.data(), bytes.size());
+    // --- RSS path ---
+    const size_t max_items = (size_t)cfg->app.ingest.max_items_per_feed;
+    const int64_t now_ms = NowMs();
+    for (const auto& f : cfg->rss.feeds) {
+      if (!sharder.owns(f.url)) continue;
+      if (!feed_state.due(f.url, now_ms, cyc.policy)) { ++cyc.not_due; continue; }
+      const std::string host = url_host(f.url);
+      if (!health.allow(host, now_ms)) { ++cyc.breaker_open; continue; }
+      feed_state.at(f.url).last_fetch_ms = now_ms;
+      ++cyc.outstanding;
+      const std::string source = "source=" + f.source;
+      const HttpOptions opt = request_options(cfg->httpopt, f.url, host);
+      const int64_t started = EventLoop::now_ms();
+      if (cfg->app.ingest.streaming_parse) {
+        // parse while downloading, on the loop (bounded work per chunk); stop the
+        // transfer once enough items are complete
+        auto parser = std::make_shared<FeedPushParser>(max_items);
+        http.get_stream(f.url, opt,
+                        [parser](const char* d, size_t n) { return parser->feed(d, n); },
+                        [&, parser, url = f.url, source, started](std::optional<HttpResponse> resp) {
+                          if (fetch_ok(resp, source, url, cyc.policy, started)) {
+                            merge_rss(url, source, parser->finish(), *resp);
+                          }
+                          task_done();
+                        });
+      } else {
+        http.get(f.url, opt,
+                 [&, url = f.url, source, max_items, started](std::optional<HttpResponse> resp) {
+                   if (!fetch_ok(resp, source, url, cyc.policy, started)) { task_done(); return; }
+                   std::string body = std::move(resp->body);
+                   parse_pool.submit("feed_parse", [&, url, source, max_items, head = std::move(*resp),
+                                                    body = std::move(body)]() mutable {
+                     auto items = parse_feed_xml(body);
+                     if (max_items > 0 && items.size() > max_items) items.resize(max_items);
+                     loop.post([&, url, source, head = std::move(head), items = std::move(items)]() {
+                       merge_rss(url, source, items, head);
+                       task_done();
+                     });
+                   });
+                 });
       }
     }
 
     // --- Yahoo HTML path ---
-    if (app.yahoo.enable_html && yahoo_allowed && !app.yahoo.tickers.empty() &&
-        !app.yahoo.html_url_template.empty()) {
-
-      const long long now = NowMs();
-      for (const auto& tkr : app.yahoo.tickers) {
-        // simple per-ticker rate limit (polite)
-        long long last = last_fetch_ms[tkr];
-        if (last > 0 && (now - last) < (long long)yhcfg.min_seconds_between_requests * 1000LL) {
-          continue;
-        }
-
+    const YahooHtmlConfig& yhcfg = cfg->yhcfg;
+    if (cfg->app.yahoo.enable_html && cfg->yahoo_allowed && !cfg->app.yahoo.tickers.empty() &&
+        !cfg->app.yahoo.html_url_template.empty()) {
+
+      // per-ticker politeness: never more often than min_seconds_between_requests
+      // (measured from the end of the last fetch), stretched like a feed when quiet
+      FeedPolicy ypolicy = cyc.policy;
+      ypolicy.base_interval_ms = std::max<int64_t>(ypolicy.base_interval_ms,
+                                                   (int64_t)yhcfg.min_seconds_between_requests * 1000);
+      ypolicy.max_interval_ms = std::max(ypolicy.max_interval_ms, ypolicy.base_interval_ms);
+      for (const auto& tkr : cfg->app.yahoo.tickers) {
         const std::string url = yahoo_html_url_for(tkr, yhcfg);
-        HttpOptions yopt = httpopt; // reuse UA/timeout
-        auto resp = http_get(url, yopt);
-        last_fetch_ms[tkr] = NowMs();
-
-        if (!resp || resp->status < 200 || resp->status >= 300) {
-          fmt::print("[news_gw] WARN Yahoo HTML fetch failed ticker={} url={} status={}\n",
-                     tkr, url, (resp ? resp->status : -1));
-          continue;
+        if (!sharder.owns(url)) continue;
+        if (!feed_state.due(url, now_ms, ypolicy)) { ++cyc.not_due; continue; }
+        const std::string host = url_host(url);
+        if (!health.allow(host, now_ms)) { ++cyc.breaker_open; continue; }
+        feed_state.at(url).last_fetch_ms = now_ms;
+
+        ++cyc.outstanding;
+        const int max_links = yhcfg.max_links_per_page;
+        const YahooHtmlMode mode = yhcfg.mode;
+        const HttpOptions opt = request_options(cfg->httpopt, url, host);
+        const int64_t started = EventLoop::now_ms();
+        if (cfg->app.ingest.streaming_parse) {
+          // the page is scanned as it arrives, on the loop; the transfer stops once
+          // max_links items are found
+          auto scanner = std::make_shared<YahooPageScanner>(max_links, mode);
+          http.get_stream(url, opt,
+                          [scanner](const char* d, size_t n) { return scanner->feed(d, n); },
+                          [&, scanner, tkr, url, ypolicy, started](std::optional<HttpResponse> resp) {
+                            feed_state.at(url).last_fetch_ms = NowMs();
+                            if (fetch_ok(resp, "Yahoo HTML ticker=" + tkr, url, ypolicy, started)) {
+                              merge_yahoo(url, tkr, scanner->finish(), *resp, ypolicy);
+                            }
+                            task_done();
+                          });
+        } else {
+          http.get(url, opt, [&, tkr, url, max_links, mode, ypolicy, started](std::optional<HttpResponse> resp) {
+            feed_state.at(url).last_fetch_ms = NowMs();
+            if (!fetch_ok(resp, "Yahoo HTML ticker=" + tkr, url, ypolicy, started)) { task_done(); return; }
+            std::string body = std::move(resp->body);
+            parse_pool.submit("yahoo_html", [&, tkr, url, max_links, mode, ypolicy, head = std::move(*resp),
+                                             body = std::move(body)]() mutable {
+              auto items = yahoo_html_extract_items(body, max_links, mode);
+              loop.post([&, tkr, url, ypolicy, head = std::move(head), items = std::move(items)]() {
+                merge_yahoo(url, tkr, items, head, ypolicy);
+                task_done();
+              });
+            });
+          });
         }
+      }
+    }
 
-        auto items = yahoo_html_extract_items(resp->body, yhcfg.max_links_per_page);
-        fmt::print("[news_gw] YahooHTML:{}: extracted {} links\n", tkr, items.size());
-
-        const std::string source = "YahooFinanceHTML:" + tkr;
-        for (auto& it : items) {
-          std::string norm = normalize_url(it.url);
-          std::string id = stable_id(source, norm);
-          std::string dedup_key = "dedup:" + id;
-          if (!dedup_setnx(dcfg, dedup_key)) continue;
-
-          finnews::ArticleRaw raw;
-          raw.set_id(id);
-          raw.set_source(source);
-          raw.set_url(norm);
-          raw.set_title(it.title);
-          raw.set_body("");
-          raw.set_published_ts(it.published_ts_ms > 0 ? it.published_ts_ms : NowMs());
-          raw.set_ingested_ts(NowMs());
-
-          std::string bytes;
-          if (!raw.SerializeToString(&bytes)) continue;
-          producer.produce(id, bytes.data(), bytes.size());
+    task_done();   // release the hold; publishes now if nothing was started
+  };
+
+  // /metrics and /health, served from the loop
+  std::unique_ptr<MetricsServer> metrics;
+  if (app.metrics.enable) {
+    try {
+      metrics = std::make_unique<MetricsServer>(loop, app.metrics.bind, app.metrics.port, [&](const std::string& path) {
+        MetricsResponse r;
+        const int64_t now = NowMs();
+        if (path == "/metrics") {
+          r.body = health.render_prometheus(now);
+          r.body += fmt::format("# HELP gw_cycle_duration_ms Duration of the last poll cycle.\n"
+                                "# TYPE gw_cycle_duration_ms gauge\ngw_cycle_duration_ms {}\n"
+                                "# HELP gw_breakers_open Hosts whose breaker is not closed.\n"
+                                "# TYPE gw_breakers_open gauge\ngw_breakers_open {}\n",
+                                last_cycle_ms, health.open_breakers());
+        } else if (path == "/health") {
+          r.content_type = "application/json";
+          r.body = health.render_json(now);
+        } else {
+          r.status = 404;
+          r.body = "not found\n";
         }
-      }
+        return r;
+      });
+      fmt::print("[news_gw] Metrics on {}:{} (/metrics, /health)\n", app.metrics.bind, app.metrics.port);
+    } catch (const std::exception& e) {
+      fmt::print("[news_gw] WARN {}; running without the metrics endpoint\n", e.what());
     }
+  }
 
-    producer.flush(100);
+  // housekeeping between cycles: lease renewal, reload checks, delivery-report fallback,
+  // feed state snapshots
+  std::function<void()> housekeeping = [&]() {
+    shard_heartbeat();   // keep the lease alive across long intervals
+    maybe_reload();
+    if (kafka_fd < 0) producer.poll(0);
+    settle_dedup();
+    save_state(false);
+    loop.add_timer(1000, housekeeping);
+  };
+  loop.add_timer(1000, housekeeping);
+  loop.add_timer(0, [&] { start_cycle(); });
 
-    // sleep for remainder of interval
-    auto t_end = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(t_end - t_start).count();
-    int to_sleep = std::max(1, rss.interval_secs - (int)elapsed);
-    for (int i = 0; i < to_sleep && !g_stop; ++i) std::this_thread::sleep_for(std::chrono::seconds(1));
+  while (!g_stop) {
+    loop.run_once(1000);   // signals interrupt the wait
   }
 
+  if (two_phase) {
+    // confirm what is still in flight while the loop can still talk to Redis
+    producer.flush(5000);
+    settle_dedup();
+    for (int i = 0; i < 50 && dedup.pending() > 0; ++i) loop.run_once(100);
+  }
+  save_state(true);   // SIGTERM/SIGINT: the next start resumes from here
+  sharder.leave();
   fmt::print("[news_gw] Stopping.\n");
   return 0;
 }
@@ -0,0 +1,141 @@
+#include "metrics_server.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+constexpr size_t kMaxRequest = 8192;
+constexpr size_t kMaxConnections = 64;
+constexpr int64_t kConnDeadlineMs = 10000;   // request in and response out, or the socket is closed
+
+struct Conn {
+  std::string in;
+  std::string out;
+  size_t sent = 0;
+  EventLoop::TimerId deadline = 0;
+};
+
+const char* reason(int status) {
+  switch (status) {
+    case 200: return "OK";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    default: return "Error";
+  }
+}
+
+} // namespace
+
+struct MetricsServer::Impl {
+  EventLoop& loop;
+  Handler handler;
+  int listen_fd = -1;
+  std::unordered_map<int, Conn> conns;
+
+  Impl(EventLoop& l, Handler h) : loop(l), handler(std::move(h)) {}
+
+  void close_conn(int fd) {
+    auto it = conns.find(fd);
+    if (it == conns.end()) return;
+    loop.cancel_timer(it->second.deadline);   // the fd number may be reused by the next accept
+    loop.unwatch(fd);
+    ::close(fd);
+    conns.erase(it);
+  }
+
+  void on_accept() {
+    for (;;) {
+      const int fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+      if (fd < 0) return;   // EAGAIN, or a transient error: wait for the next readiness
+      if (conns.size() >= kMaxConnections) { ::close(fd); continue; }
+      // an idle or trickling client would otherwise hold one of the slots forever
+      conns[fd].deadline = loop.add_timer(kConnDeadlineMs, [this, fd] { close_conn(fd); });
+      loop.watch(fd, EPOLLIN, [this, fd](uint32_t ev) { on_conn(fd, ev); });
+    }
+  }
+
+  void respond(int fd, Conn& c, const MetricsResponse& r) {
+    char head[256];
+    std::snprintf(head, sizeof(head),
+                  "HTTP/1.0 %d %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+                  r.status, reason(r.status), r.content_type.c_str(), r.body.size());
+    c.out = head;
+    c.out += r.body;
+    loop.watch(fd, EPOLLOUT, [this, fd](uint32_t ev) { on_conn(fd, ev); });
+  }
+
+  void on_conn(int fd, uint32_t ev) {
+    auto it = conns.find(fd);
+    if (it == conns.end()) return;
+    Conn& c = it->second;
+    if (ev & (EPOLLERR | EPOLLHUP)) { close_conn(fd); return; }
+
+    if (c.out.empty()) {
+      char buf[2048];
+      const ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+      if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) { close_conn(fd); return; }
+      if (n < 0) return;
+      c.in.append(buf, (size_t)n);
+      if (c.in.find("\r\n\r\n") == std::string::npos && c.in.find("\n\n") == std::string::npos) {
+        if (c.in.size() > kMaxRequest) respond(fd, c, MetricsResponse{400, "text/plain", "request too large\n"});
+        return;
+      }
+      char method[8] = {0}, path[1024] = {0};
+      if (std::sscanf(c.in.c_str(), "%7s %1023s", method, path) != 2) {
+        respond(fd, c, MetricsResponse{400, "text/plain", "bad request\n"});
+      } else if (std::strcmp(method, "GET") != 0) {
+        respond(fd, c, MetricsResponse{405, "text/plain", "GET only\n"});
+      } else {
+        std::string p = path;
+        if (auto q = p.find('?'); q != std::string::npos) p.erase(q);
+        respond(fd, c, handler(p));
+      }
+      return;
+    }
+
+    while (c.sent < c.out.size()) {
+      const ssize_t n = ::send(fd, c.out.data() + c.sent, c.out.size() - c.sent, MSG_NOSIGNAL);
+      if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+      if (n <= 0) break;
+      c.sent += (size_t)n;
+    }
+    close_conn(fd);
+  }
+};
+
+MetricsServer::MetricsServer(EventLoop& loop, const std::string& bind, int port, Handler handler)
+    : impl_(new Impl(loop, std::move(handler))) {
+  const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0) { delete impl_; throw std::runtime_error("metrics: socket() failed"); }
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons((uint16_t)port);
+  if (inet_pton(AF_INET, bind.c_str(), &addr.sin_addr) != 1 ||
+      ::bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(fd, 64) != 0) {
+    const std::string err = std::strerror(errno);
+    ::close(fd);
+    delete impl_;
+    throw std::runtime_error("metrics: cannot listen on " + bind + ":" + std::to_string(port) + ": " + err);
+  }
+  impl_->listen_fd = fd;
+  loop.watch(fd, EPOLLIN, [this](uint32_t) { impl_->on_accept(); });
+}
+
+MetricsServer::~MetricsServer() {
+  if (!impl_) return;
+  while (!impl_->conns.empty()) impl_->close_conn(impl_->conns.begin()->first);
+  impl_->loop.unwatch(impl_->listen_fd);
+  ::close(impl_->listen_fd);
+  delete impl_;
+}
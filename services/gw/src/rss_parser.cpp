@@ -1,4 +1,5 @@
 #include "rss_parser.h"
+#include <libxml/SAX2.h>
 #include <libxml/parser.h>
 #include <libxml/tree.h>
 #include <string>
@@ -35,10 +36,9 @@ static int64_t parse_pubdate(const std::string& s) {
   return now_ms();
 }
 
-std::vector<FeedItem> parse_feed_xml(const std::string& xml) {
+// Walks a parsed (possibly truncated) feed document; takes ownership of `doc`
+static std::vector<FeedItem> items_from_doc(xmlDocPtr doc) {
   std::vector<FeedItem> out;
-
-  xmlDocPtr doc = xmlReadMemory(xml.c_str(), (int)xml.size(), "noname.xml", nullptr, XML_PARSE_NOERROR | XML_PARSE_NOWARNING);
   if (!doc) return out;
 
   xmlNode* root = xmlDocGetRootElement(doc);
@@ -85,3 +85,62 @@ std::vector<FeedItem> parse_feed_xml(const std::string& xml) {
   xmlFreeDoc(doc);
   return out;
 }
+
+std::vector<FeedItem> parse_feed_xml(const std::string& xml) {
+  xmlDocPtr doc = xmlReadMemory(xml.c_str(), (int)xml.size(), "noname.xml", nullptr, XML_PARSE_NOERROR | XML_PARSE_NOWARNING);
+  return items_from_doc(doc);
+}
+
+struct FeedPushParser::Impl {
+  xmlParserCtxtPtr ctxt = nullptr;
+  xmlSAXHandler sax;
+  size_t max_items = 0;
+  size_t items = 0;
+
+  // SAX2 defaults build the tree; we only count closed <item>/<entry> elements
+  static void on_end(void* ctx, const xmlChar* localname, const xmlChar* prefix, const xmlChar* uri) {
+    xmlSAX2EndElementNs(ctx, localname, prefix, uri);
+    auto* im = reinterpret_cast<Impl*>(reinterpret_cast<xmlParserCtxtPtr>(ctx)->_private);
+    if (!xmlStrcasecmp(localname, BAD_CAST "item") || !xmlStrcasecmp(localname, BAD_CAST "entry")) im->items++;
+  }
+  bool done() const { return max_items > 0 && items >= max_items; }
+};
+
+FeedPushParser::FeedPushParser(size_t max_items) : impl_(new Impl()) {
+  impl_->max_items = max_items;
+  std::memset(&impl_->sax, 0, sizeof(impl_->sax));
+  xmlSAXVersion(&impl_->sax, 2);
+  impl_->sax.endElementNs = Impl::on_end;
+}
+
+FeedPushParser::~FeedPushParser() {
+  if (impl_) {
+    if (impl_->ctxt) {
+      if (impl_->ctxt->myDoc) xmlFreeDoc(impl_->ctxt->myDoc);
+      xmlFreeParserCtxt(impl_->ctxt);
+    }
+    delete impl_;
+  }
+}
+
+bool FeedPushParser::feed(const char* data, size_t len) {
+  if (impl_->done()) return false;
+  if (!impl_->ctxt) {
+    // nullptr user_data: SAX2 defaults receive the parser context, our state rides in _private
+    impl_->ctxt = xmlCreatePushParserCtxt(&impl_->sax, nullptr, data, (int)len, "noname.xml");
+    if (!impl_->ctxt) return false;
+    impl_->ctxt->_private = impl_;
+    xmlCtxtUseOptions(impl_->ctxt, XML_PARSE_RECOVER | XML_PARSE_NOERROR | XML_PARSE_NOWARNING | XML_PARSE_NONET);
+  } else {
+    xmlParseChunk(impl_->ctxt, data, (int)len, 0);
+  }
+  return !impl_->done();
+}
+
+std::vector<FeedItem> FeedPushParser::finish() {
+  if (!impl_->ctxt) return {};
+  xmlParseChunk(impl_->ctxt, nullptr, 0, 1);
+  xmlDocPtr doc = impl_->ctxt->myDoc;
+  impl_->ctxt->myDoc = nullptr;
+  return items_from_doc(doc);
+}
@@ -0,0 +1,390 @@
+#include "spool.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr uint32_t kRecordMagic = 0x52505350;   // "PSPR"
+constexpr char kSegmentMagic[8] = {'N', 'S', 'P', 'O', 'O', 'L', '0', '1'};
+constexpr size_t kSegmentHeader = 64;           // magic + seq, rest reserved
+constexpr size_t kRecordHeader = 16;
+
+struct RecordHeader {
+  uint32_t magic;
+  uint32_t key_len;
+  uint32_t val_len;
+  uint32_t crc;
+};
+static_assert(sizeof(RecordHeader) == kRecordHeader);
+
+size_t align8(size_t n) { return (n + 7) & ~size_t(7); }
+
+uint32_t crc32c(uint32_t crc, const void* data, size_t len) {
+  static const auto table = [] {
+    std::array<uint32_t, 256> t{};
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; ++k) c = (c & 1) ? (c >> 1) ^ 0x82F63B78u : c >> 1;
+      t[i] = c;
+    }
+    return t;
+  }();
+  const auto* p = static_cast<const uint8_t*>(data);
+  crc = ~crc;
+  for (size_t i = 0; i < len; ++i) crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
+
+uint32_t record_crc(const RecordHeader& h, const char* key, const char* val) {
+  uint32_t crc = crc32c(0, &h.key_len, 8);   // key_len + val_len
+  crc = crc32c(crc, key, h.key_len);
+  return crc32c(crc, val, h.val_len);
+}
+
+int64_t now_ms() {
+  using namespace std::chrono;
+  return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+struct Segment {
+  uint64_t seq = 0;
+  std::string path;
+  int fd = -1;
+  char* base = nullptr;
+  size_t size = 0;
+  size_t end = kSegmentHeader;   // offset after the last valid record
+  bool sealed = false;           // blocks not reserved: read it, never append to it
+};
+
+struct Cursor {
+  uint64_t seq = 0;
+  uint64_t off = kSegmentHeader;
+  uint32_t crc = 0;
+};
+
+} // namespace
+
+struct Spool::Impl {
+  SpoolConfig cfg;
+  mutable std::mutex mu;
+  std::map<uint64_t, Segment> segs;   // oldest first; the last one is appended to
+  Cursor committed;                   // read position persisted in "cursor"
+  uint64_t peek_seq = 0, peek_off = kSegmentHeader;
+  uint64_t peeked_records = 0, peeked_bytes = 0;
+  uint64_t depth_records = 0, depth_bytes = 0;
+  uint64_t appended = 0, consumed = 0, rejected = 0, corrupt = 0, alloc_failed = 0;
+  size_t dirty_from = SIZE_MAX;       // unsynced range of the last segment starts here
+  int64_t last_sync_ms = now_ms();
+
+  std::string seg_path(uint64_t seq) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%020llu.seg", (unsigned long long)seq);
+    return (fs::path(cfg.dir) / name).string();
+  }
+
+  bool map(Segment& s, bool create) {
+    s.fd = ::open(s.path.c_str(), O_RDWR | O_CLOEXEC | (create ? O_CREAT | O_EXCL : 0), 0644);
+    if (s.fd < 0) {
+      std::cerr << "[spool] open " << s.path << ": " << std::strerror(errno) << "\n";
+      return false;
+    }
+    // Blocks are reserved up front: a store into a sparse MAP_SHARED page that the
+    // filesystem cannot back raises SIGBUS instead of returning ENOSPC.
+    if (create) {
+      if (const int err = ::posix_fallocate(s.fd, 0, (off_t)cfg.segment_bytes); err != 0) {
+        std::cerr << "[spool] allocate " << s.path << ": " << std::strerror(err) << "\n";
+        alloc_failed++;
+        ::close(s.fd);
+        ::unlink(s.path.c_str());
+        s.fd = -1;
+        return false;
+      }
+      s.size = cfg.segment_bytes;
+    } else {
+      struct stat st{};
+      if (::fstat(s.fd, &st) != 0 || (size_t)st.st_size < kSegmentHeader) { ::close(s.fd); s.fd = -1; return false; }
+      s.size = (size_t)st.st_size;   // written with a possibly different segment_bytes
+      // segments left by a build that only ftruncate'd them may still be sparse
+      if (const int err = ::posix_fallocate(s.fd, 0, (off_t)s.size); err != 0) {
+        std::cerr << "[spool] allocate " << s.path << ": " << std::strerror(err)
+                  << " (replaying it, no further appends)\n";
+        alloc_failed++;
+        s.sealed = true;
+      }
+    }
+    void* p = ::mmap(nullptr, s.size, PROT_READ | PROT_WRITE, MAP_SHARED, s.fd, 0);
+    if (p == MAP_FAILED) {
+      std::cerr << "[spool] mmap " << s.path << ": " << std::strerror(errno) << "\n";
+      ::close(s.fd);
+      s.fd = -1;
+      return false;
+    }
+    s.base = static_cast<char*>(p);
+    if (create) {
+      std::memcpy(s.base, kSegmentMagic, sizeof(kSegmentMagic));
+      std::memcpy(s.base + 8, &s.seq, sizeof(s.seq));
+    } else if (std::memcmp(s.base, kSegmentMagic, sizeof(kSegmentMagic)) != 0) {
+      std::cerr << "[spool] " << s.path << " is not a spool segment\n";
+      unmap(s);
+      return false;
+    }
+    return true;
+  }
+
+  static void unmap(Segment& s) {
+    if (s.base) ::munmap(s.base, s.size);
+    if (s.fd >= 0) ::close(s.fd);
+    s.base = nullptr;
+    s.fd = -1;
+  }
+
+  // Validates the record at `off`; returns its padded size, 0 at the end of the data
+  static size_t record_at(const Segment& s, size_t off, size_t limit, RecordHeader& h) {
+    if (off + kRecordHeader > limit) return 0;
+    std::memcpy(&h, s.base + off, kRecordHeader);
+    if (h.magic != kRecordMagic) return 0;
+    const size_t total = align8(kRecordHeader + (size_t)h.key_len + (size_t)h.val_len);
+    if (off + total > limit) return 0;
+    const char* key = s.base + off + kRecordHeader;
+    if (record_crc(h, key, key + h.key_len) != h.crc) return 0;
+    return total;
+  }
+
+  void open_existing() {
+    for (const auto& e : fs::directory_iterator(cfg.dir)) {
+      const std::string name = e.path().filename().string();
+      if (name.size() != 24 || name.compare(20, 4, ".seg") != 0) continue;
+      Segment s;
+      try { s.seq = std::stoull(name.substr(0, 20)); } catch (...) { continue; }
+      s.path = e.path().string();
+      if (!map(s, false)) continue;
+      // data ends at the first record that is missing or fails its CRC
+      RecordHeader h{};
+      size_t off = kSegmentHeader;
+      while (size_t n = record_at(s, off, s.size, h)) off += n;
+      if (off + kRecordHeader <= s.size && h.magic != 0) corrupt++;   // torn or damaged record
+      s.end = off;
+      segs.emplace(s.seq, s);
+    }
+
+    const std::string cpath = (fs::path(cfg.dir) / "cursor").string();
+    if (FILE* f = std::fopen(cpath.c_str(), "rb")) {
+      Cursor c;
+      if (std::fread(&c, sizeof(c), 1, f) == 1 && crc32c(0, &c, 16) == c.crc) committed = c;
+      std::fclose(f);
+    }
+    if (segs.empty()) {
+      committed = Cursor{};
+    } else if (!segs.count(committed.seq)) {
+      // cursor older than every segment (or missing): start at the oldest
+      committed.seq = segs.begin()->first;
+      committed.off = kSegmentHeader;
+    }
+    peek_seq = committed.seq;
+    peek_off = committed.off;
+
+    // depth from the committed position
+    for (auto& [seq, s] : segs) {
+      if (seq < committed.seq) continue;
+      RecordHeader h;
+      size_t off = seq == committed.seq ? committed.off : kSegmentHeader;
+      while (size_t n = record_at(s, off, s.end, h)) { off += n; depth_records++; depth_bytes += n; }
+    }
+    // segments entirely before the cursor were consumed before a crash
+    while (!segs.empty() && segs.begin()->first < committed.seq) remove_oldest();
+    if (depth_records > 0) {
+      std::cerr << "[spool] " << cfg.dir << ": " << depth_records << " records (" << depth_bytes
+                << " bytes) to replay in " << segs.size() << " segment(s)\n";
+    }
+  }
+
+  void remove_oldest() {
+    Segment& s = segs.begin()->second;
+    unmap(s);
+    ::unlink(s.path.c_str());
+    segs.erase(segs.begin());
+  }
+
+  void write_cursor() {
+    committed.crc = crc32c(0, &committed, 16);
+    const std::string cpath = (fs::path(cfg.dir) / "cursor").string();
+    const std::string tmp = cpath + ".tmp";
+    FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) { std::cerr << "[spool] write " << tmp << ": " << std::strerror(errno) << "\n"; return; }
+    const bool ok = std::fwrite(&committed, sizeof(committed), 1, f) == 1;
+    if (std::fclose(f) != 0 || !ok || std::rename(tmp.c_str(), cpath.c_str()) != 0) {
+      std::cerr << "[spool] write " << cpath << ": " << std::strerror(errno) << "\n";
+    }
+  }
+
+  void sync_locked() {
+    if (segs.empty() || dirty_from == SIZE_MAX) return;
+    Segment& w = segs.rbegin()->second;
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    const size_t from = dirty_from & ~(page - 1);
+    if (w.end > from) ::msync(w.base + from, w.end - from, MS_SYNC);
+    dirty_from = SIZE_MAX;
+    last_sync_ms = now_ms();
+  }
+
+  Segment* rotate() {
+    const uint64_t seq = segs.empty() ? std::max<uint64_t>(1, committed.seq) : segs.rbegin()->first + 1;
+    sync_locked();   // the old segment is complete
+    // a drained writer segment would otherwise count against max_bytes until the next commit
+    if (depth_records == 0) {
+      while (!segs.empty()) remove_oldest();
+    }
+    if ((segs.size() + 1) * cfg.segment_bytes > cfg.max_bytes) return nullptr;
+    Segment s;
+    s.seq = seq;
+    s.path = seg_path(seq);
+    if (!map(s, true)) return nullptr;
+    const bool first = segs.empty();
+    Segment& added = segs.emplace(seq, s).first->second;
+    if (first) {
+      committed.seq = peek_seq = seq;
+      committed.off = peek_off = kSegmentHeader;
+    }
+    return &added;
+  }
+};
+
+Spool::Spool(const SpoolConfig& cfg) : impl_(new Impl()) {
+  impl_->cfg = cfg;
+  impl_->cfg.segment_bytes = std::max<size_t>(impl_->cfg.segment_bytes, 1u << 20);
+  impl_->cfg.max_bytes = std::max(impl_->cfg.max_bytes, impl_->cfg.segment_bytes);
+  try {
+    fs::create_directories(cfg.dir);
+    impl_->open_existing();
+  } catch (const std::exception& e) {
+    for (auto& [seq, s] : impl_->segs) Impl::unmap(s);
+    delete impl_;
+    throw std::runtime_error("spool " + cfg.dir + ": " + e.what());
+  }
+}
+
+Spool::~Spool() {
+  if (!impl_) return;
+  {
+    std::lock_guard<std::mutex> lk(impl_->mu);
+    impl_->sync_locked();
+    for (auto& [seq, s] : impl_->segs) Impl::unmap(s);
+  }
+  delete impl_;
+}
+
+bool Spool::append(const void* key, size_t key_len, const void* val, size_t val_len) {
+  std::lock_guard<std::mutex> lk(impl_->mu);
+  const size_t total = align8(kRecordHeader + key_len + val_len);
+  if (total > impl_->cfg.segment_bytes - kSegmentHeader || key_len > UINT32_MAX || val_len > UINT32_MAX) {
+    impl_->rejected++;
+    return false;
+  }
+  Segment* w = impl_->segs.empty() ? nullptr : &impl_->segs.rbegin()->second;
+  if (!w || w->sealed || w->end + total > w->size) w = impl_->rotate();
+  if (!w) {
+    impl_->rejected++;
+    return false;
+  }
+  char* at = w->base + w->end;
+  RecordHeader h{0, (uint32_t)key_len, (uint32_t)val_len, 0};
+  if (key_len) std::memcpy(at + kRecordHeader, key, key_len);
+  if (val_len) std::memcpy(at + kRecordHeader + key_len, val, val_len);
+  h.crc = record_crc(h, at + kRecordHeader, at + kRecordHeader + key_len);
+  std::memcpy(at, &h, kRecordHeader);
+  std::atomic_thread_fence(std::memory_order_release);
+  h.magic = kRecordMagic;
+  std::memcpy(at, &h.magic, sizeof(h.magic));   // header last: the record now exists
+  impl_->dirty_from = std::min(impl_->dirty_from, w->end);
+  w->end += total;
+  impl_->appended++;
+  impl_->depth_records++;
+  impl_->depth_bytes += total;
+  return true;
+}
+
+bool Spool::empty() const {
+  std::lock_guard<std::mutex> lk(impl_->mu);
+  return impl_->depth_records == 0;
+}
+
+bool Spool::peek(std::string& key, std::string& val) {
+  std::lock_guard<std::mutex> lk(impl_->mu);
+  auto& im = *impl_;
+  for (;;) {
+    auto it = im.segs.find(im.peek_seq);
+    if (it == im.segs.end()) return false;
+    const Segment& s = it->second;
+    RecordHeader h;
+    if (size_t n = Impl::record_at(s, im.peek_off, s.end, h)) {
+      const char* p = s.base + im.peek_off + kRecordHeader;
+      key.assign(p, h.key_len);
+      val.assign(p + h.key_len, h.val_len);
+      im.peek_off += n;
+      im.peeked_records++;
+      im.peeked_bytes += n;
+      return true;
+    }
+    auto next = std::next(it);
+    if (next == im.segs.end()) return false;   // caught up with the writer
+    im.peek_seq = next->first;
+    im.peek_off = kSegmentHeader;
+  }
+}
+
+void Spool::rewind() {
+  std::lock_guard<std::mutex> lk(impl_->mu);
+  impl_->peek_seq = impl_->committed.seq;
+  impl_->peek_off = impl_->committed.off;
+  impl_->peeked_records = impl_->peeked_bytes = 0;
+}
+
+void Spool::commit() {
+  std::lock_guard<std::mutex> lk(impl_->mu);
+  auto& im = *impl_;
+  if (im.peeked_records == 0 && im.peek_seq == im.committed.seq) return;
+  im.committed.seq = im.peek_seq;
+  im.committed.off = im.peek_off;
+  im.consumed += im.peeked_records;
+  im.depth_records -= std::min(im.depth_records, im.peeked_records);
+  im.depth_bytes -= std::min(im.depth_bytes, im.peeked_bytes);
+  im.peeked_records = im.peeked_bytes = 0;
+  im.write_cursor();
+  while (!im.segs.empty() && im.segs.begin()->first < im.committed.seq) im.remove_oldest();
+}
+
+void Spool::sync(bool force) {
+  std::lock_guard<std::mutex> lk(impl_->mu);
+  if (!force && (impl_->cfg.sync_ms <= 0 || now_ms() - impl_->last_sync_ms < impl_->cfg.sync_ms)) return;
+  impl_->sync_locked();
+}
+
+SpoolStats Spool::stats() const {
+  std::lock_guard<std::mutex> lk(impl_->mu);
+  SpoolStats st;
+  st.depth_records = impl_->depth_records;
+  st.depth_bytes = impl_->depth_bytes;
+  st.segments = impl_->segs.size();
+  st.appended = impl_->appended;
+  st.consumed = impl_->consumed;
+  st.rejected = impl_->rejected;
+  st.corrupt = impl_->corrupt;
+  st.alloc_failed = impl_->alloc_failed;
+  return st;
+}
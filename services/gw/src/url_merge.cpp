@@ -0,0 +1,52 @@
+#include "url_merge.h"
+#include <xxhash.h>
+#include <algorithm>
+#include <cstdio>
+
+void UrlMerger::add(const std::string& source, const std::string& feed_url, const std::string& normalized_url,
+                    const std::string& title, int64_t published_ts_ms) {
+  if (normalized_url.empty()) return;
+
+  auto [it, inserted] = index_.try_emplace(normalized_url, order_.size());
+  if (inserted) {
+    MergedArticle a;
+    a.url = normalized_url;
+    a.title = title;
+    a.published_ts_ms = published_ts_ms;
+    a.sources.push_back(source);
+    a.feeds.push_back(feed_url);
+    order_.push_back(std::move(a));
+    return;
+  }
+
+  MergedArticle& a = order_[it->second];
+  if (a.title.empty()) a.title = title;
+  if (published_ts_ms > 0 && (a.published_ts_ms <= 0 || published_ts_ms < a.published_ts_ms))
+    a.published_ts_ms = published_ts_ms;
+  if (std::find(a.sources.begin(), a.sources.end(), source) == a.sources.end())
+    a.sources.push_back(source);
+  if (std::find(a.feeds.begin(), a.feeds.end(), feed_url) == a.feeds.end())
+    a.feeds.push_back(feed_url);
+  ++merged_;
+}
+
+std::vector<MergedArticle> UrlMerger::take() {
+  std::vector<MergedArticle> out = std::move(order_);
+  order_.clear();
+  index_.clear();
+  merged_ = 0;
+  return out;
+}
+
+std::string url_id(const std::string& normalized_url) {
+  unsigned long long h = XXH64(normalized_url.data(), normalized_url.size(), 0);
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%016llx", h);
+  return std::string(buf);
+}
+
+std::string source_ticker(const std::string& source) {
+  auto colon = source.rfind(':');
+  if (colon == std::string::npos || colon + 1 >= source.size()) return {};
+  return source.substr(colon + 1);
+}
@@ -76,3 +76,12 @@ std::string normalize_url(const std::string& in) {
   if (!query.empty()) out += "?" + query;
   return out;
 }
+
+std::string url_host(const std::string& url) {
+  auto scheme_pos = url.find("://");
+  const size_t start = scheme_pos == std::string::npos ? 0 : scheme_pos + 3;
+  const size_t end = url.find_first_of("/?#", start);
+  std::string host = url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+  if (auto at = host.rfind('@'); at != std::string::npos) host.erase(0, at + 1);
+  return to_lower(host);
+}
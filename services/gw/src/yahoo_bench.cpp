@@ -0,0 +1,114 @@
+#include <fmt/core.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "yahoo_html.h"
+
+#include <libxml/parser.h>
+
+// news_yahoo_bench: times the streaming page scanner against the DOM extractor on
+// saved Yahoo quote pages and checks which links each finds.
+//
+//   news_yahoo_bench [--iters N] [--max-links N] [--chunk BYTES] [--mode json|anchors] page.html...
+// --chunk feeds the scanner in pieces of that size, as a streamed download would.
+// In json mode the scanner reads the embedded news stream, so its links can differ from
+// the anchors the DOM extractor finds; the report says which source was used.
+
+static double elapsed_ms(std::chrono::steady_clock::time_point t0) {
+  using namespace std::chrono;
+  return duration<double, std::milli>(steady_clock::now() - t0).count();
+}
+
+static std::vector<YahooHtmlItem> scan_chunked(const std::string& html, int max_links, size_t chunk,
+                                               YahooHtmlMode mode, bool* used_json = nullptr) {
+  YahooPageScanner scanner(max_links, mode);
+  for (size_t off = 0; off < html.size(); off += chunk) {
+    if (!scanner.feed(html.data() + off, std::min(chunk, html.size() - off))) break;
+  }
+  auto items = scanner.finish();
+  if (used_json) *used_json = scanner.used_json();
+  return items;
+}
+
+static std::set<std::string> urls(const std::vector<YahooHtmlItem>& items) {
+  std::set<std::string> out;
+  for (const auto& it : items) out.insert(it.url);
+  return out;
+}
+
+int main(int argc, char** argv) {
+  int iters = 50;
+  int max_links = 30;
+  size_t chunk = 16384;
+  YahooHtmlMode mode = YahooHtmlMode::EmbeddedJson;
+  std::vector<std::string> pages;
+  for (int i = 1; i < argc; ++i) {
+    std::string a = argv[i];
+    if (a == "--iters" && i + 1 < argc) iters = std::max(1, std::stoi(argv[++i]));
+    else if (a == "--max-links" && i + 1 < argc) max_links = std::stoi(argv[++i]);
+    else if (a == "--chunk" && i + 1 < argc) chunk = (size_t)std::max(1, std::stoi(argv[++i]));
+    else if (a == "--mode" && i + 1 < argc)
+      mode = std::string(argv[++i]) == "anchors" ? YahooHtmlMode::Anchors : YahooHtmlMode::EmbeddedJson;
+    else pages.push_back(a);
+  }
+  if (pages.empty()) {
+    fmt::print("usage: news_yahoo_bench [--iters N] [--max-links N] [--chunk BYTES] [--mode json|anchors] page.html...\n");
+    return 2;
+  }
+
+  xmlInitParser();
+  double total_dom = 0, total_scan = 0;
+  size_t total_bytes = 0;
+  int mismatches = 0;
+  for (const auto& path : pages) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) { fmt::print("[news_yahoo_bench] ERROR: cannot read {}\n", path); return 1; }
+    std::stringstream ss;
+    ss << in.rdbuf();
+    const std::string html = ss.str();
+
+    // agreement on every link (no limit), then timing with the configured limit
+    const auto dom_all = urls(yahoo_html_extract_items_dom(html, 0));
+    bool used_json = false;
+    const auto scan_list = scan_chunked(html, 0, chunk, mode, &used_json);
+    const auto scan_all = urls(scan_list);
+    size_t timed = 0;
+    for (const auto& it : scan_list) timed += it.published_ts_ms > 0;
+    std::vector<std::string> only_dom, only_scan;
+    std::set_difference(dom_all.begin(), dom_all.end(), scan_all.begin(), scan_all.end(), std::back_inserter(only_dom));
+    std::set_difference(scan_all.begin(), scan_all.end(), dom_all.begin(), dom_all.end(), std::back_inserter(only_scan));
+
+    size_t dom_items = 0, scan_items = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < iters; ++k) dom_items = yahoo_html_extract_items_dom(html, max_links).size();
+    const double dom_ms = elapsed_ms(t0) / iters;
+    t0 = std::chrono::steady_clock::now();
+    for (int k = 0; k < iters; ++k) scan_items = scan_chunked(html, max_links, chunk, mode).size();
+    const double scan_ms = elapsed_ms(t0) / iters;
+
+    fmt::print("[news_yahoo_bench] {}: {} KB dom={:.3f}ms scan={:.3f}ms speedup={:.1f}x "
+               "items[dom={} scan={}] source={} timed={} links[common={} dom_only={} scan_only={}]\n",
+               path, html.size() / 1024, dom_ms, scan_ms, scan_ms > 0 ? dom_ms / scan_ms : 0.0,
+               dom_items, scan_items, used_json ? "json" : "anchors", timed,
+               dom_all.size() - only_dom.size(), only_dom.size(), only_scan.size());
+    for (const auto& u : only_dom) fmt::print("  dom only:  {}\n", u);
+    for (const auto& u : only_scan) fmt::print("  scan only: {}\n", u);
+    if (!only_dom.empty() || !only_scan.empty()) ++mismatches;
+    total_dom += dom_ms;
+    total_scan += scan_ms;
+    total_bytes += html.size();
+  }
+
+  const double mb = total_bytes / 1048576.0;
+  fmt::print("[news_yahoo_bench] {} pages, {} iters: dom={:.3f}ms/pass ({:.0f} MB/s) scan={:.3f}ms/pass ({:.0f} MB/s) "
+             "speedup={:.1f}x, {} page(s) with differing links\n",
+             pages.size(), iters, total_dom, total_dom > 0 ? mb / (total_dom / 1000) : 0.0,
+             total_scan, total_scan > 0 ? mb / (total_scan / 1000) : 0.0,
+             total_scan > 0 ? total_dom / total_scan : 0.0, mismatches);
+  return 0;
+}
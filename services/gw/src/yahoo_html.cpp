@@ -1,15 +1,20 @@
 #include "yahoo_html.h"
 #include "http_fetch.h"
+#include "structured_data.h"
+#include <nlohmann/json.hpp>
 #include <libxml/HTMLparser.h>
 #include <libxml/HTMLtree.h>
 #include <libxml/parser.h>
 #include <libxml/tree.h>
+#include <strings.h>
 #include <algorithm>
 #include <cctype>
 #include <chrono>
+#include <cstring>
 #include <iostream>
 #include <set>
 #include <string>
+#include <string_view>
 #include <unordered_set>
 
 static std::string to_lower(std::string s) {
@@ -95,7 +100,7 @@ static std::string trim(std::string s) {
 // Extract links that look like Yahoo Finance news items.
 // Heuristic: <a href="https://finance.yahoo.com/...."> and URL contains "/news/"
 // Title = anchor text (trimmed). Timestamp: not always present, default to now.
-std::vector<YahooHtmlItem> yahoo_html_extract_items(const std::string& html, int max_links) {
+std::vector<YahooHtmlItem> yahoo_html_extract_items_dom(const std::string& html, int max_links) {
   std::vector<YahooHtmlItem> out;
   if (html.empty()) return out;
 
@@ -107,9 +112,9 @@ std::vector<YahooHtmlItem> yahoo_html_extract_items(const std::string& html, int
 
   xmlNode* root = xmlDocGetRootElement(doc);
   std::vector<xmlNode*> stack;
-  stack.push_back(root);
+  if (root) stack.push_back(root);
 
-  while (!stack.empty()) {
+  while (!stack.empty() && (max_links <= 0 || (int)out.size() < max_links)) {
     xmlNode* node = stack.back();
     stack.pop_back();
 
@@ -122,20 +127,19 @@ std::vector<YahooHtmlItem> yahoo_html_extract_items(const std::string& html, int
         // Filter: must be Yahoo domain and contain "/news/"
         std::string low = to_lower(href);
         if (low.find("finance.yahoo.com") != std::string::npos &&
-            low.find("/news/") != std::string::npos &&
-            seen.insert(href).second) {
+            low.find("/news/") != std::string::npos) {
 
           std::string text;
           collect_text(node->children, text);
           text = trim(text);
 
-          if (!text.empty()) {
+          // image-only anchors to the same story must not hide the titled one
+          if (!text.empty() && seen.insert(href).second) {
             YahooHtmlItem it;
             it.title = text;
             it.url = href;
             it.published_ts_ms = now_ms(); // we don’t have the exact article time here
             out.push_back(std::move(it));
-            if ((int)out.size() >= max_links) break;
           }
         }
       }
@@ -147,3 +151,477 @@ std::vector<YahooHtmlItem> yahoo_html_extract_items(const std::string& html, int
   xmlFreeDoc(doc);
   return out;
 }
+
+// ---------------- streaming anchor scanner ----------------
+
+namespace {
+
+constexpr size_t kMaxTagBytes = 8192;      // longer tags are skipped, not parsed
+constexpr size_t kMaxAnchorText = 16384;   // text kept per anchor
+constexpr size_t kMaxIslandBytes = 8u << 20;   // embedded state larger than this is ignored
+constexpr size_t kIslandProbeBytes = 512;      // untyped scripts must show "root.App" this early
+
+// Case-insensitive substring test without copying; `needle` is lowercase ASCII
+bool icontains(std::string_view hay, std::string_view needle) {
+  if (needle.empty()) return true;
+  const char first = needle[0];
+  for (size_t i = 0; i + needle.size() <= hay.size(); ++i) {
+    if (std::tolower((unsigned char)hay[i]) != first) continue;
+    if (!strncasecmp(hay.data() + i + 1, needle.data() + 1, needle.size() - 1)) return true;
+  }
+  return false;
+}
+
+// Raw tag bytes ("a class=x href=...") name test: "a" matches "a href" but not "abbr"
+bool tag_is(std::string_view tag, const char* name) {
+  const size_t n = std::strlen(name);
+  if (tag.size() < n || strncasecmp(tag.data(), name, n) != 0) return false;
+  return tag.size() == n || std::isspace((unsigned char)tag[n]) || tag[n] == '/';
+}
+
+// Value of attribute `name` in raw tag bytes, as a view into `tag`
+std::string_view tag_attr(std::string_view tag, const char* name) {
+  const size_t n = std::strlen(name);
+  size_t i = 0;
+  while (i < tag.size() && !std::isspace((unsigned char)tag[i])) ++i;   // tag name
+  while (i < tag.size()) {
+    while (i < tag.size() && (std::isspace((unsigned char)tag[i]) || tag[i] == '/')) ++i;
+    const size_t a = i;
+    while (i < tag.size() && tag[i] != '=' && !std::isspace((unsigned char)tag[i]) && tag[i] != '/') ++i;
+    const bool match = (i - a == n) && !strncasecmp(tag.data() + a, name, n);
+    while (i < tag.size() && std::isspace((unsigned char)tag[i])) ++i;
+    if (i >= tag.size() || tag[i] != '=') { if (i == a) ++i; continue; }
+    ++i;
+    while (i < tag.size() && std::isspace((unsigned char)tag[i])) ++i;
+    size_t b, e;
+    if (i < tag.size() && (tag[i] == '"' || tag[i] == '\'')) {
+      const char q = tag[i++];
+      b = i;
+      e = tag.find(q, i);
+      if (e == std::string_view::npos) e = tag.size();
+      i = e + 1;
+    } else {
+      b = e = i;
+      while (e < tag.size() && !std::isspace((unsigned char)tag[e])) ++e;
+      i = e;
+    }
+    if (match) return tag.substr(b, e - b);
+  }
+  return {};
+}
+
+void append_utf8(std::string& out, unsigned long cp) {
+  if (cp < 0x80) out.push_back((char)cp);
+  else if (cp < 0x800) { out.push_back((char)(0xC0 | (cp >> 6))); out.push_back((char)(0x80 | (cp & 0x3F))); }
+  else if (cp < 0x10000) {
+    out.push_back((char)(0xE0 | (cp >> 12)));
+    out.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+    out.push_back((char)(0x80 | (cp & 0x3F)));
+  } else if (cp < 0x110000) {
+    out.push_back((char)(0xF0 | (cp >> 18)));
+    out.push_back((char)(0x80 | ((cp >> 12) & 0x3F)));
+    out.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+    out.push_back((char)(0x80 | (cp & 0x3F)));
+  }
+}
+
+// Appends `in` with the common HTML entities decoded; unknown ones are kept as written
+void append_decoded(std::string& out, std::string_view in) {
+  size_t i = 0;
+  while (i < in.size()) {
+    const size_t amp = in.find('&', i);
+    if (amp == std::string_view::npos) { out.append(in.data() + i, in.size() - i); return; }
+    out.append(in.data() + i, amp - i);
+    const size_t semi = in.find(';', amp);
+    if (semi == std::string_view::npos || semi - amp > 10) { out.push_back('&'); i = amp + 1; continue; }
+    const std::string_view ent = in.substr(amp + 1, semi - amp - 1);
+    unsigned long cp = 0;
+    if (!ent.empty() && ent[0] == '#') {
+      const bool hex = ent.size() > 1 && (ent[1] == 'x' || ent[1] == 'X');
+      for (size_t k = hex ? 2 : 1; k < ent.size(); ++k) {
+        const int c = (unsigned char)ent[k];
+        const int d = std::isdigit(c) ? c - '0' : (hex && std::isxdigit(c)) ? std::tolower(c) - 'a' + 10 : -1;
+        if (d < 0) { cp = 0; break; }
+        cp = cp * (hex ? 16 : 10) + (unsigned long)d;
+        if (cp >= 0x110000) { cp = 0; break; }
+      }
+    } else if (ent == "amp") cp = '&';
+    else if (ent == "lt") cp = '<';
+    else if (ent == "gt") cp = '>';
+    else if (ent == "quot") cp = '"';
+    else if (ent == "apos") cp = '\'';
+    else if (ent == "nbsp") cp = 0xA0;
+    if (cp == 0) { out.push_back('&'); i = amp + 1; continue; }
+    append_utf8(out, cp);
+    i = semi + 1;
+  }
+}
+
+// "/news/x.html" and "//finance.yahoo.com/..." -> absolute
+std::string absolute_yahoo_url(std::string url) {
+  if (url.rfind("//", 0) == 0) return "https:" + url;
+  if (!url.empty() && url[0] == '/') return "https://finance.yahoo.com" + url;
+  return url;
+}
+
+// SAX consumer for an embedded state island. Everything outside the news stream
+// arrays is tokenized and dropped without building values; each object directly in a
+// "stream_items"/"stream" array is one item. Stops the parse once `limit` is reached.
+class NewsStreamSax : public nlohmann::json_sax<nlohmann::json> {
+public:
+  NewsStreamSax(std::vector<YahooHtmlItem>& out, std::unordered_set<std::string>& seen, size_t limit)
+      : out_(out), seen_(seen), limit_(limit) {}
+
+  bool full() const { return limit_ > 0 && out_.size() >= limit_; }
+
+  bool null() override { return true; }
+  bool boolean(bool v) override {
+    if (in_item() && v && (key() == "isAd" || key() == "is_ad")) cur_.ad = true;
+    return true;
+  }
+  bool number_integer(number_integer_t v) override { on_time_number(v); return true; }
+  bool number_unsigned(number_unsigned_t v) override { on_time_number((int64_t)v); return true; }
+  bool number_float(number_float_t v, const string_t&) override { on_time_number((int64_t)v); return true; }
+  bool binary(binary_t&) override { return true; }
+
+  bool string(string_t& v) override {
+    if (stack_.empty() || !stack_.back().is_object) return true;
+    const std::string& k = stack_.back().key;
+    if (!in_item()) {
+      // some pages ship the stream as a JSON document inside a string ({"body":"{\"stream\":...}"})
+      if (k == "body" && !v.empty() && v[0] == '{' && v.find("\"stream") != std::string::npos) {
+        NewsStreamSax inner(out_, seen_, limit_);
+        nlohmann::json::sax_parse(v, &inner, nlohmann::json::input_format_t::json, false);
+      }
+      return !full();
+    }
+    const size_t rel = stack_.size() - 1 - item_depth_;   // 0 = the item, 1 = e.g. item.content
+    const std::string& owner = stack_.back().owner_key;
+    if (k == "title" && rel <= 1 && cur_.title.empty()) cur_.title = std::move(v);
+    else if (k == "url" && owner == "canonicalUrl") set_url(std::move(v), 0);
+    else if (k == "link" && rel <= 1) set_url(std::move(v), 1);
+    else if (k == "url" && owner == "clickThroughUrl") set_url(std::move(v), 2);
+    else if (k == "url" && rel <= 1) set_url(std::move(v), 3);
+    else if ((k == "pubDate" || k == "displayTime" || k == "published_at") && rel <= 1 && cur_.ts == 0)
+      cur_.ts = parse_iso8601_ms(v);
+    else if (k == "type" && rel == 0 && (v == "ad" || v == "ads")) cur_.ad = true;
+    return true;
+  }
+
+  bool start_object(std::size_t) override {
+    const bool item = item_depth_ == npos && !stack_.empty() && !stack_.back().is_object && stack_.back().stream;
+    stack_.push_back(Frame{true, false, {}, parent_key()});
+    if (item) { item_depth_ = stack_.size() - 1; cur_ = Item{}; }
+    return true;
+  }
+  bool key(string_t& k) override {
+    stack_.back().key = std::move(k);
+    return true;
+  }
+  bool end_object() override {
+    const bool closing_item = stack_.size() - 1 == item_depth_;
+    stack_.pop_back();
+    if (closing_item) {
+      item_depth_ = npos;
+      emit();
+      return !full();
+    }
+    return true;
+  }
+  bool start_array(std::size_t) override {
+    std::string k = parent_key();
+    const bool stream = item_depth_ == npos && (k == "stream_items" || k == "stream");
+    stack_.push_back(Frame{false, stream, {}, std::move(k)});
+    return true;
+  }
+  bool end_array() override {
+    stack_.pop_back();
+    return true;
+  }
+  bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override {
+    return false;   // keep the items that closed before the error
+  }
+
+private:
+  static constexpr size_t npos = (size_t)-1;
+  struct Frame {
+    bool is_object = true;
+    bool stream = false;      // array holding news items
+    std::string key;          // current key (objects)
+    std::string owner_key;    // key this object/array is the value of
+  };
+  struct Item {
+    std::string title, url;
+    int url_rank = 99;        // canonicalUrl < link < clickThroughUrl < url
+    int64_t ts = 0;
+    bool ad = false;
+  };
+
+  bool in_item() const { return item_depth_ != npos; }
+  const std::string& key() const { static const std::string none; return stack_.empty() ? none : stack_.back().key; }
+  std::string parent_key() const {
+    if (stack_.empty()) return {};
+    return stack_.back().is_object ? stack_.back().key : stack_.back().owner_key;
+  }
+
+  void set_url(std::string v, int rank) {
+    if (v.empty() || rank >= cur_.url_rank) return;
+    cur_.url = std::move(v);
+    cur_.url_rank = rank;
+  }
+
+  void on_time_number(int64_t v) {
+    if (!in_item() || cur_.ts != 0 || v <= 0) return;
+    const std::string& k = key();
+    if (stack_.size() - 1 - item_depth_ > 1) return;
+    if (k == "pubtime" || k == "providerPublishTime" || k == "published_at" || k == "pubDate") {
+      cur_.ts = v > 100000000000LL ? v : v * 1000;   // ms or seconds
+    }
+  }
+
+  void emit() {
+    if (full() || cur_.ad || cur_.url.empty()) return;
+    std::string title = trim(std::move(cur_.title));
+    if (title.empty()) return;
+    std::string url = absolute_yahoo_url(std::move(cur_.url));
+    if (!seen_.insert(url).second) return;
+    YahooHtmlItem it;
+    it.title = std::move(title);
+    it.url = std::move(url);
+    it.published_ts_ms = cur_.ts;
+    out_.push_back(std::move(it));
+  }
+
+  std::vector<YahooHtmlItem>& out_;
+  std::unordered_set<std::string>& seen_;
+  size_t limit_;
+  std::vector<Frame> stack_;
+  size_t item_depth_ = npos;
+  Item cur_;
+};
+
+} // namespace
+
+struct YahooPageScanner::Impl {
+  enum class State { Text, TagStart, Tag, Comment, RawSkip };
+  enum class Capture { None, Probe, Island };
+  int max_links = 0;
+  YahooHtmlMode mode = YahooHtmlMode::EmbeddedJson;
+  State state = State::Text;
+  std::string tag;               // bytes between '<' and '>' (capacity reused)
+  char quote = 0;
+  const char* close = nullptr;   // terminator searched for in Comment/RawSkip
+  size_t matched = 0;
+
+  bool in_anchor = false;        // inside a matching <a>, collecting its text
+  std::string href;
+  std::string text;              // raw (entity-encoded) anchor text
+  std::unordered_set<std::string> seen;
+  std::vector<YahooHtmlItem> items;
+  bool anchors_full = false;     // max_links anchors found; stop collecting them
+
+  Capture capture = Capture::None;   // copying the current script's text
+  std::string island;
+  std::unordered_set<std::string> json_seen;
+  std::vector<YahooHtmlItem> json_items;
+  bool used_json = false;
+  bool full = false;             // nothing more to find: stop the transfer
+
+  void begin_anchor() {
+    const std::string_view h = tag_attr(tag, "href");
+    if (h.empty() || !icontains(h, "finance.yahoo.com") || !icontains(h, "/news/")) return;
+    href.clear();
+    if (h.rfind("//finance.yahoo.com", 0) == 0) href = "https:";   // protocol-relative
+    append_decoded(href, h);
+    text.clear();
+    in_anchor = true;
+  }
+
+  void end_anchor() {
+    in_anchor = false;
+    std::string title;
+    append_decoded(title, text);
+    title = trim(std::move(title));
+    if (title.empty() || !seen.insert(href).second) return;
+    YahooHtmlItem it;
+    it.title = std::move(title);
+    it.url = href;
+    items.push_back(std::move(it));   // no publish time next to the link
+    if (max_links > 0 && (int)items.size() >= max_links) {
+      anchors_full = true;
+      // the embedded stream usually follows the markup, so keep reading for it
+      if (mode == YahooHtmlMode::Anchors) full = true;
+    }
+  }
+
+  void begin_script(std::string_view t) {
+    state = State::RawSkip;
+    close = "</script";
+    matched = 0;
+    capture = Capture::None;
+    if (mode != YahooHtmlMode::EmbeddedJson || !json_items.empty()) return;
+    const std::string_view type = tag_attr(t, "type");
+    if (icontains(type, "application/json")) capture = Capture::Island;
+    else if (type.empty() || icontains(type, "javascript")) capture = Capture::Probe;
+    island.clear();
+  }
+
+  void capture_bytes(const char* d, size_t n) {
+    if (capture == Capture::None) return;
+    if (island.size() + n > kMaxIslandBytes) { capture = Capture::None; island.clear(); return; }
+    island.append(d, n);
+    if (capture == Capture::Probe && island.size() >= kIslandProbeBytes &&
+        island.find("root.App") == std::string::npos) {
+      capture = Capture::None;   // ordinary script
+      island.clear();
+    }
+  }
+
+  void end_script() {
+    if (capture == Capture::None) return;
+    const Capture kind = capture;
+    capture = Capture::None;
+    const size_t cl = std::strlen(close);
+    if (island.size() >= cl) island.resize(island.size() - cl);
+    size_t start = 0;
+    if (kind == Capture::Probe) {
+      // root.App.main = {...};  (trailing JS is ignored by the non-strict parse)
+      const size_t m = island.find("root.App.main");
+      start = m == std::string::npos ? std::string::npos : island.find('{', m);
+    } else if (island.find("stream") == std::string::npos) {
+      start = std::string::npos;   // some other JSON blob
+    }
+    if (start != std::string::npos) {
+      NewsStreamSax sax(json_items, json_seen, max_links > 0 ? (size_t)max_links : 0);
+      nlohmann::json::sax_parse(island.begin() + (std::ptrdiff_t)start, island.end(), &sax,
+                                nlohmann::json::input_format_t::json, false);
+      if (sax.full()) full = true;
+    }
+    island.clear();
+  }
+
+  void on_tag() {
+    const std::string_view t(tag);
+    if (!t.empty() && t[0] == '/') {
+      if (in_anchor && tag_is(t.substr(1), "a")) end_anchor();
+      return;
+    }
+    if (tag_is(t, "a")) {
+      if (in_anchor) end_anchor();   // <a> can't nest; the parser closes the open one
+      if (!anchors_full) begin_anchor();
+    } else if (tag_is(t, "script")) {
+      if (t.back() != '/') begin_script(t);
+    } else if (tag_is(t, "style")) {
+      state = State::RawSkip; close = "</style"; matched = 0;
+    }
+  }
+
+  // Case-insensitive streaming match of `close`; true when it completes
+  bool match_close(char c) {
+    const char lc = (char)std::tolower((unsigned char)c);
+    if (lc == close[matched]) {
+      if (close[++matched] == 0) { matched = 0; return true; }
+    } else if (!(matched >= 2 && close[0] == close[1] && lc == close[0])) {   // "--->" still ends a comment
+      matched = (lc == close[0]) ? 1 : 0;
+    }
+    return false;
+  }
+
+  void append_text(const char* d, size_t n) {
+    if (text.size() < kMaxAnchorText) text.append(d, std::min(n, kMaxAnchorText - text.size()));
+  }
+
+  bool feed(const char* p, size_t n) {
+    size_t i = 0;
+    while (i < n && !full) {
+      switch (state) {
+        case State::Text: {
+          const void* lt = std::memchr(p + i, '<', n - i);
+          const size_t stop = lt ? (size_t)((const char*)lt - p) : n;
+          if (in_anchor) append_text(p + i, stop - i);
+          if (!lt) return true;
+          i = stop + 1;
+          state = State::TagStart;
+          break;
+        }
+        case State::TagStart: {
+          const char c = p[i];
+          if (std::isalpha((unsigned char)c) || c == '/' || c == '!' || c == '?') {
+            state = State::Tag;
+            tag.clear();
+            quote = 0;
+          } else {
+            if (in_anchor) append_text("<", 1);   // a stray '<' is text
+            state = State::Text;
+          }
+          break;
+        }
+        case State::Tag: {
+          const char c = p[i++];
+          if (quote) {
+            if (c == quote) quote = 0;
+          } else if (c == '"' || c == '\'') {
+            quote = c;
+          } else if (c == '>') {
+            state = State::Text;
+            on_tag();
+            break;
+          }
+          tag.push_back(c);
+          if (tag.size() == 3 && tag == "!--") { state = State::Comment; close = "-->"; matched = 0; }
+          else if (tag.size() > kMaxTagBytes) state = State::Text;
+          break;
+        }
+        case State::Comment:
+        case State::RawSkip: {
+          if (matched == 0) {
+            const void* q = std::memchr(p + i, close[0], n - i);
+            const size_t stop = q ? (size_t)((const char*)q - p) : n;
+            if (state == State::RawSkip) capture_bytes(p + i, stop - i);
+            i = stop;
+            if (!q) return true;
+          }
+          if (state == State::RawSkip) capture_bytes(p + i, 1);
+          if (match_close(p[i++])) {
+            if (state == State::RawSkip) {
+              end_script();
+              // "</script" matched; the rest of the end tag is consumed as a tag
+              state = State::Tag;
+              tag.assign(close + 1);
+              quote = 0;
+            } else {
+              state = State::Text;
+            }
+          }
+          break;
+        }
+      }
+    }
+    return !full;
+  }
+};
+
+YahooPageScanner::YahooPageScanner(int max_links, YahooHtmlMode mode) : impl_(new Impl()) {
+  impl_->max_links = max_links;
+  impl_->mode = mode;
+}
+YahooPageScanner::~YahooPageScanner() { delete impl_; }
+
+bool YahooPageScanner::feed(const char* data, size_t len) { return impl_->feed(data, len); }
+
+std::vector<YahooHtmlItem> YahooPageScanner::finish() {
+  if (!impl_->json_items.empty()) {
+    impl_->used_json = true;
+    return std::move(impl_->json_items);
+  }
+  if (impl_->in_anchor && !impl_->anchors_full) impl_->end_anchor();
+  return std::move(impl_->items);
+}
+
+bool YahooPageScanner::used_json() const { return impl_->used_json; }
+
+std::vector<YahooHtmlItem> yahoo_html_extract_items(const std::string& html, int max_links, YahooHtmlMode mode) {
+  YahooPageScanner scanner(max_links, mode);
+  scanner.feed(html.data(), html.size());
+  return scanner.finish();
+}
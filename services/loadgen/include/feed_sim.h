@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "config.h"
+
+// Deterministic synthetic content. Article k is published at start + k / items_per_sec
+// and belongs to feed k % feeds; no per-item state is kept, so any number of server
+// threads can render concurrently. Article URLs embed the publish time
+// (/article/<k>-<published_ms>.html) so downstream consumers can measure end-to-end
+// latency without a side channel.
+class FeedSim {
+public:
+  FeedSim(const LoadgenContent& cfg, std::string base_url, int64_t start_ms);
+
+  // Feed document (RSS or Atom) listing the newest items_per_feed items of `feed`.
+  std::optional<std::string> feed(int feed, int64_t now_ms) const;
+  // Article HTML for id `k`, or nullopt if it is not published yet.
+  std::optional<std::string> article(uint64_t k, int64_t now_ms) const;
+
+  uint64_t published(int64_t now_ms) const;   // articles generated so far
+  int64_t published_ms(uint64_t k) const;
+
+  // Parses "/article/<k>-<ms>.html" out of a URL; false if it is not ours.
+  static bool parse_article_url(const std::string& url, uint64_t& k, int64_t& published_ms);
+
+private:
+  std::string article_url(uint64_t k) const;
+  bool atom_for(int feed) const;
+
+  LoadgenContent cfg_;
+  std::string base_url_;
+  int64_t start_ms_;
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include "config.h"
+#include "feed_sim.h"
+
+struct SimServerStats {
+  uint64_t feed_requests = 0;
+  uint64_t article_requests = 0;
+  uint64_t errors_429 = 0;
+  uint64_t errors_5xx = 0;
+  uint64_t bytes_sent = 0;
+  double avg_cycle_secs = 0;   // mean gap between consecutive fetches of the same feed
+};
+
+// Minimal blocking HTTP/1.1 server for FeedSim content: `threads` workers share one
+// listening socket, each serving one keep-alive connection at a time. Responses are
+// delayed by a lognormal latency and replaced by 429/503 at the configured ratios.
+class SimServer {
+public:
+  SimServer(const LoadgenConfig& cfg, const FeedSim& sim);
+  ~SimServer();
+
+  void start();   // throws std::runtime_error if the port cannot be bound
+  void stop();
+  SimServerStats stats() const;
+
+private:
+  struct Impl;
+  Impl* impl_;
+};
@@ -0,0 +1,180 @@
+#include "feed_sim.h"
+
+#include <xxhash.h>
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <vector>
+
+namespace {
+
+const char* kWords[] = {
+  "shares", "market", "investors", "quarter", "revenue", "guidance", "analysts", "growth",
+  "earnings", "company", "profit", "outlook", "demand", "supply", "rates", "inflation",
+  "the", "and", "for", "with", "after", "while", "said", "expects", "reported", "higher",
+  "lower", "billion", "million", "percent", "trading", "session", "stock", "index",
+};
+constexpr size_t kNumWords = sizeof(kWords) / sizeof(kWords[0]);
+
+uint64_t mix(uint64_t k, uint64_t salt) {
+  uint64_t v[2] = {k, salt};
+  return XXH64(v, sizeof(v), 0);
+}
+
+double unit(uint64_t h) { return (double)(h >> 11) / (double)(1ULL << 53); }
+
+std::string xml_escape(const std::string& s) {
+  std::string out;
+  out.reserve(s.size());
+  for (char c : s) {
+    switch (c) {
+      case '&': out += "&amp;"; break;
+      case '<': out += "&lt;"; break;
+      case '>': out += "&gt;"; break;
+      case '"': out += "&quot;"; break;
+      default: out += c;
+    }
+  }
+  return out;
+}
+
+std::string rfc822(int64_t ms) {
+  std::time_t t = (std::time_t)(ms / 1000);
+  std::tm tm{};
+  gmtime_r(&t, &tm);
+  char buf[64];
+  std::strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+  return buf;
+}
+
+std::string iso8601(int64_t ms) {
+  std::time_t t = (std::time_t)(ms / 1000);
+  std::tm tm{};
+  gmtime_r(&t, &tm);
+  char buf[64];
+  std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &tm);
+  return buf;
+}
+
+std::string headline(uint64_t k) {
+  std::string t = "Synthetic story " + std::to_string(k) + ":";
+  for (int i = 0; i < 6; ++i) {
+    t += ' ';
+    t += kWords[mix(k, 100 + i) % kNumWords];
+  }
+  return t;
+}
+
+} // namespace
+
+FeedSim::FeedSim(const LoadgenContent& cfg, std::string base_url, int64_t start_ms)
+    : cfg_(cfg), base_url_(std::move(base_url)), start_ms_(start_ms) {
+  cfg_.feeds = std::max(1, cfg_.feeds);
+  cfg_.items_per_sec = std::max(0.001, cfg_.items_per_sec);
+}
+
+uint64_t FeedSim::published(int64_t now_ms) const {
+  if (now_ms <= start_ms_) return 0;
+  return (uint64_t)((double)(now_ms - start_ms_) * cfg_.items_per_sec / 1000.0);
+}
+
+int64_t FeedSim::published_ms(uint64_t k) const {
+  return start_ms_ + (int64_t)std::ceil((double)k * 1000.0 / cfg_.items_per_sec);
+}
+
+std::string FeedSim::article_url(uint64_t k) const {
+  return base_url_ + "/article/" + std::to_string(k) + "-" + std::to_string(published_ms(k)) + ".html";
+}
+
+bool FeedSim::atom_for(int feed) const {
+  if (cfg_.feed_format == "atom") return true;
+  if (cfg_.feed_format == "mixed") return feed % 2 == 1;
+  return false;
+}
+
+std::optional<std::string> FeedSim::feed(int feed, int64_t now_ms) const {
+  if (feed < 0 || feed >= cfg_.feeds) return std::nullopt;
+  const uint64_t n = published(now_ms);
+  const uint64_t feeds = (uint64_t)cfg_.feeds;
+
+  // newest k < n with k % feeds == feed, walking backwards
+  std::vector<uint64_t> ks;
+  if (n > (uint64_t)feed) {
+    uint64_t k = (n - 1) - ((n - 1 - (uint64_t)feed) % feeds);
+    for (int i = 0; i < cfg_.items_per_feed; ++i) {
+      ks.push_back(k);
+      if (k < feeds) break;
+      k -= feeds;
+    }
+  }
+
+  const bool atom = atom_for(feed);
+  std::string out;
+  out.reserve(256 + ks.size() * 256);
+  if (atom) {
+    out += "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<feed xmlns=\"http://www.w3.org/2005/Atom\">\n";
+    out += "<title>Loadgen feed " + std::to_string(feed) + "</title>\n";
+  } else {
+    out += "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<rss version=\"2.0\"><channel>\n";
+    out += "<title>Loadgen feed " + std::to_string(feed) + "</title>\n";
+  }
+  for (uint64_t k : ks) {
+    // a duplicate re-lists the previous article, which lives in another feed
+    const uint64_t target = (k > 0 && unit(mix(k, 1)) < cfg_.duplicate_ratio) ? k - 1 : k;
+    const std::string url = xml_escape(article_url(target));
+    const std::string title = xml_escape(headline(target));
+    if (atom) {
+      out += "<entry><title>" + title + "</title><link href=\"" + url + "\"/><id>" + url +
+             "</id><updated>" + iso8601(published_ms(k)) + "</updated></entry>\n";
+    } else {
+      out += "<item><title>" + title + "</title><link>" + url + "</link><guid>" + url +
+             "</guid><pubDate>" + rfc822(published_ms(k)) + "</pubDate></item>\n";
+    }
+  }
+  out += atom ? "</feed>\n" : "</channel></rss>\n";
+  return out;
+}
+
+std::optional<std::string> FeedSim::article(uint64_t k, int64_t now_ms) const {
+  if (k >= published(now_ms)) return std::nullopt;
+
+  double jitter = (unit(mix(k, 2)) * 2.0 - 1.0) * cfg_.page_bytes_jitter;
+  const size_t target = (size_t)std::max(512.0, cfg_.page_bytes * (1.0 + jitter));
+
+  std::string out;
+  out.reserve(target + 512);
+  out += "<!DOCTYPE html><html lang=\"en\"><head><meta charset=\"utf-8\"><title>";
+  out += xml_escape(headline(k));
+  out += "</title></head><body><nav><a href=\"/\">Home</a></nav><article><h1>";
+  out += xml_escape(headline(k));
+  out += "</h1>\n";
+  uint64_t w = 0;
+  while (out.size() < target) {
+    out += "<p>";
+    for (int i = 0; i < 40; ++i) {
+      out += kWords[mix(k, 1000 + w++) % kNumWords];
+      out += ' ';
+    }
+    out += "$LGEN reported results.</p>\n";
+  }
+  out += "</article><footer>synthetic</footer></body></html>\n";
+  return out;
+}
+
+bool FeedSim::parse_article_url(const std::string& url, uint64_t& k, int64_t& published_ms) {
+  const std::string marker = "/article/";
+  size_t p = url.rfind(marker);
+  if (p == std::string::npos) return false;
+  p += marker.size();
+  size_t dash = url.find('-', p);
+  size_t dot = url.find(".html", p);
+  if (dash == std::string::npos || dot == std::string::npos || dash > dot) return false;
+  try {
+    k = std::stoull(url.substr(p, dash - p));
+    published_ms = std::stoll(url.substr(dash + 1, dot - dash - 1));
+  } catch (...) {
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,140 @@
+#include <fmt/core.h>
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "feed_sim.h"
+#include "sim_server.h"
+#include "kafka_consumer.h"
+#include "config.h"
+#include "news.pb.h"
+
+// news_loadgen: serves synthetic feeds/articles for news_gw + news_clean and, with
+// measure.enable, consumes their output to report sustained throughput and
+// end-to-end latency (article publish time -> message on the topic).
+//
+//   news_loadgen [config/loadgen.yml] [--rss-out <path>]
+// --rss-out writes an rss.yml pointing news_gw at every simulated feed.
+
+static volatile std::sig_atomic_t g_stop = 0;
+static void handle_sigint(int) { g_stop = 1; }
+
+static long long NowMs() {
+  using namespace std::chrono;
+  return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+static double pct(std::vector<int64_t>& v, double p) {
+  if (v.empty()) return 0;
+  size_t i = std::min(v.size() - 1, (size_t)(p * (double)(v.size() - 1) + 0.5));
+  std::nth_element(v.begin(), v.begin() + i, v.end());
+  return (double)v[i];
+}
+
+int main(int argc, char** argv) {
+  std::signal(SIGINT, handle_sigint);
+  std::signal(SIGTERM, handle_sigint);
+
+  std::string cfg_path = "config/loadgen.yml";
+  std::string rss_out;
+  for (int i = 1; i < argc; ++i) {
+    std::string a = argv[i];
+    if (a == "--rss-out" && i + 1 < argc) rss_out = argv[++i];
+    else cfg_path = a;
+  }
+
+  fmt::print("[news_loadgen] Loading config: '{}'\n", cfg_path);
+  LoadgenConfig cfg = load_loadgen_config(cfg_path);
+
+  const std::string base_url = fmt::format("http://{}:{}", cfg.server.bind, cfg.server.port);
+  FeedSim sim(cfg.content, base_url, NowMs());
+
+  if (!rss_out.empty()) {
+    FILE* f = std::fopen(rss_out.c_str(), "w");
+    if (!f) { fmt::print("[news_loadgen] ERROR: cannot write {}\n", rss_out); return 1; }
+    fmt::print(f, "interval_secs: 20\nuser_agent: \"FinNewsLoadgen/1.0\"\nfeeds:\n");
+    for (int i = 0; i < cfg.content.feeds; ++i) {
+      fmt::print(f, "  - source: \"Loadgen{}\"\n    url: \"{}/feed/{}.xml\"\n", i, base_url, i);
+    }
+    std::fclose(f);
+    fmt::print("[news_loadgen] Wrote {} feeds to {}\n", cfg.content.feeds, rss_out);
+  }
+
+  SimServer server(cfg, sim);
+  server.start();
+  fmt::print("[news_loadgen] Serving {} {} feeds at {}/feed/<n>.xml ({} items/s, dup={:.0f}%, "
+             "page={}B, latency p50={}ms, 429={:.1f}%, 5xx={:.1f}%)\n",
+             cfg.content.feeds, cfg.content.feed_format, base_url, cfg.content.items_per_sec,
+             cfg.content.duplicate_ratio * 100, cfg.content.page_bytes, cfg.faults.latency_median_ms,
+             cfg.faults.error_429_ratio * 100, cfg.faults.error_5xx_ratio * 100);
+
+  std::unique_ptr<KafkaConsumer> consumer;
+  if (cfg.measure.enable) {
+    KafkaConsumerCfg ccfg;
+    ccfg.bootstrap_servers = cfg.measure.bootstrap_servers;
+    ccfg.group_id = fmt::format("news-loadgen-{}", NowMs());   // fresh group: only this run
+    ccfg.topic = cfg.measure.topic;
+    ccfg.auto_offset_reset = "latest";
+    consumer = std::make_unique<KafkaConsumer>(ccfg);
+    fmt::print("[news_loadgen] Measuring end-to-end latency on '{}'\n", cfg.measure.topic);
+  }
+  const bool raw_topic = cfg.measure.topic == "news.raw";
+
+  std::vector<int64_t> window_latency;
+  uint64_t total_seen = 0, window_seen = 0;
+  uint64_t last_published = sim.published(NowMs());
+  auto window_start = std::chrono::steady_clock::now();
+
+  std::string key;
+  const void* payload = nullptr; size_t len = 0;
+  finnews::ArticleRaw raw;
+  finnews::ArticleClean clean;
+
+  while (!g_stop) {
+    if (consumer) {
+      if (consumer->poll(key, payload, len, 100) && payload && len > 0) {
+        const std::string* url = nullptr;
+        if (raw_topic ? raw.ParseFromArray(payload, (int)len) : clean.ParseFromArray(payload, (int)len)) {
+          url = raw_topic ? &raw.url() : &clean.url();
+        }
+        uint64_t k = 0; int64_t published_ms = 0;
+        if (url && FeedSim::parse_article_url(*url, k, published_ms)) {
+          window_latency.push_back(NowMs() - published_ms);
+          ++window_seen;
+          ++total_seen;
+        }
+      }
+    } else {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    const double secs = std::chrono::duration<double>(now - window_start).count();
+    if (secs >= std::max(1, cfg.measure.report_secs)) {
+      const uint64_t published = sim.published(NowMs());
+      const auto st = server.stats();
+      fmt::print("[news_loadgen] generated={:.1f}/s served[feeds={} articles={} 429={} 5xx={} {:.1f}MB] "
+                 "cycle={:.1f}s\n",
+                 (published - last_published) / secs, st.feed_requests, st.article_requests,
+                 st.errors_429, st.errors_5xx, st.bytes_sent / 1e6, st.avg_cycle_secs);
+      if (consumer) {
+        fmt::print("[news_loadgen] sustained={:.1f} items/s total={} e2e_ms[p50={:.0f} p95={:.0f} p99={:.0f} max={:.0f}]\n",
+                   window_seen / secs, total_seen, pct(window_latency, 0.50), pct(window_latency, 0.95),
+                   pct(window_latency, 0.99), pct(window_latency, 1.0));
+      }
+      last_published = published;
+      window_seen = 0;
+      window_latency.clear();
+      window_start = now;
+    }
+  }
+
+  server.stop();
+  fmt::print("[news_loadgen] Stopping.\n");
+  return 0;
+}
@@ -0,0 +1,189 @@
+#include "sim_server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+static int64_t now_ms() {
+  using namespace std::chrono;
+  return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+struct SimServer::Impl {
+  LoadgenConfig cfg;
+  const FeedSim& sim;
+  int listen_fd = -1;
+  std::atomic<bool> stopping{false};
+  std::vector<std::thread> workers;
+
+  std::atomic<uint64_t> feed_requests{0}, article_requests{0}, errors_429{0}, errors_5xx{0}, bytes_sent{0};
+  std::unique_ptr<std::atomic<int64_t>[]> last_feed_fetch_ms;
+  std::atomic<uint64_t> cycle_gap_sum_ms{0}, cycle_gaps{0};
+
+  Impl(const LoadgenConfig& c, const FeedSim& s) : cfg(c), sim(s) {
+    last_feed_fetch_ms.reset(new std::atomic<int64_t>[std::max(1, cfg.content.feeds)]);
+    for (int i = 0; i < std::max(1, cfg.content.feeds); ++i) last_feed_fetch_ms[i] = 0;
+  }
+
+  static bool send_all(int fd, const std::string& data) {
+    size_t off = 0;
+    while (off < data.size()) {
+      ssize_t n = ::send(fd, data.data() + off, data.size() - off, MSG_NOSIGNAL);
+      if (n <= 0) return false;
+      off += (size_t)n;
+    }
+    return true;
+  }
+
+  std::string respond(const std::string& path, std::mt19937_64& rng) {
+    auto reply = [](int code, const char* reason, const char* type, const std::string& body) {
+      std::string r = "HTTP/1.1 " + std::to_string(code) + " " + reason + "\r\nContent-Type: " + type +
+                      "\r\nContent-Length: " + std::to_string(body.size()) + "\r\n";
+      if (code == 429) r += "Retry-After: 5\r\n";
+      r += "\r\n";
+      r += body;
+      return r;
+    };
+
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    const double roll = u(rng);
+    if (roll < cfg.faults.error_429_ratio) {
+      errors_429++;
+      return reply(429, "Too Many Requests", "text/plain", "slow down\n");
+    }
+    if (roll < cfg.faults.error_429_ratio + cfg.faults.error_5xx_ratio) {
+      errors_5xx++;
+      return reply(503, "Service Unavailable", "text/plain", "unavailable\n");
+    }
+
+    const int64_t now = now_ms();
+    int feed = -1;
+    char ext[8] = {0};
+    unsigned long long k = 0, ms = 0;
+    if (std::sscanf(path.c_str(), "/feed/%d.%7s", &feed, ext) == 2) {
+      feed_requests++;
+      if (feed >= 0 && feed < cfg.content.feeds) {
+        int64_t prev = last_feed_fetch_ms[feed].exchange(now);
+        if (prev > 0) { cycle_gap_sum_ms += (uint64_t)(now - prev); cycle_gaps++; }
+      }
+      if (auto body = sim.feed(feed, now)) return reply(200, "OK", "application/rss+xml; charset=utf-8", *body);
+    } else if (std::sscanf(path.c_str(), "/article/%llu-%llu.html", &k, &ms) == 2) {
+      article_requests++;
+      if (auto body = sim.article(k, now)) return reply(200, "OK", "text/html; charset=utf-8", *body);
+    }
+    return reply(404, "Not Found", "text/plain", "not found\n");
+  }
+
+  void serve(int fd, std::mt19937_64& rng) {
+    std::lognormal_distribution<double> latency(std::log(std::max(0.001, cfg.faults.latency_median_ms)),
+                                                std::max(0.0, cfg.faults.latency_sigma));
+    std::string buf;
+    char chunk[4096];
+    while (!stopping) {
+      size_t end;
+      while ((end = buf.find("\r\n\r\n")) == std::string::npos) {
+        ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && !stopping) continue;
+        if (n <= 0) return;
+        buf.append(chunk, (size_t)n);
+        if (buf.size() > 64 * 1024) return;
+      }
+      std::string head = buf.substr(0, end);
+      buf.erase(0, end + 4);
+
+      char method[16] = {0}, path[2048] = {0};
+      if (std::sscanf(head.c_str(), "%15s %2047s", method, path) != 2) return;
+      const bool close_after = head.find("Connection: close") != std::string::npos ||
+                               head.find("HTTP/1.0") != std::string::npos;
+
+      if (cfg.faults.latency_median_ms > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds((int64_t)(latency(rng) * 1000.0)));
+      }
+      std::string resp = respond(path, rng);
+      if (!send_all(fd, resp)) return;
+      bytes_sent += resp.size();
+      if (close_after) return;
+    }
+  }
+
+  void worker_loop(unsigned seed) {
+    std::mt19937_64 rng(seed);
+    while (!stopping) {
+      int fd = ::accept(listen_fd, nullptr, nullptr);
+      if (fd < 0) {
+        if (stopping) break;
+        continue;
+      }
+      int one = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+      timeval tv{1, 0};   // idle keep-alive connections re-check `stopping`
+      setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+      serve(fd, rng);
+      ::close(fd);
+    }
+  }
+};
+
+SimServer::SimServer(const LoadgenConfig& cfg, const FeedSim& sim) : impl_(new Impl(cfg, sim)) {}
+
+SimServer::~SimServer() {
+  stop();
+  delete impl_;
+}
+
+void SimServer::start() {
+  impl_->listen_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (impl_->listen_fd < 0) throw std::runtime_error("socket() failed");
+  int one = 1;
+  setsockopt(impl_->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons((uint16_t)impl_->cfg.server.port);
+  if (inet_pton(AF_INET, impl_->cfg.server.bind.c_str(), &addr.sin_addr) != 1)
+    throw std::runtime_error("bad bind address: " + impl_->cfg.server.bind);
+  if (::bind(impl_->listen_fd, (sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(impl_->listen_fd, 512) != 0)
+    throw std::runtime_error("cannot listen on " + impl_->cfg.server.bind + ":" +
+                             std::to_string(impl_->cfg.server.port) + ": " + std::strerror(errno));
+
+  for (int i = 0; i < std::max(1, impl_->cfg.server.threads); ++i) {
+    impl_->workers.emplace_back([this, i] { impl_->worker_loop(0x9e3779b9u + (unsigned)i); });
+  }
+}
+
+void SimServer::stop() {
+  if (impl_->stopping.exchange(true)) return;
+  if (impl_->listen_fd >= 0) {
+    ::shutdown(impl_->listen_fd, SHUT_RDWR);
+    ::close(impl_->listen_fd);
+  }
+  for (auto& t : impl_->workers) t.join();
+  impl_->workers.clear();
+}
+
+SimServerStats SimServer::stats() const {
+  SimServerStats st;
+  st.feed_requests = impl_->feed_requests.load();
+  st.article_requests = impl_->article_requests.load();
+  st.errors_429 = impl_->errors_429.load();
+  st.errors_5xx = impl_->errors_5xx.load();
+  st.bytes_sent = impl_->bytes_sent.load();
+  const uint64_t gaps = impl_->cycle_gaps.load();
+  if (gaps > 0) st.avg_cycle_secs = impl_->cycle_gap_sum_ms.load() / 1000.0 / gaps;
+  return st;
+}
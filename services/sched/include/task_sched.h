@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct TaskSchedConfig {
+  size_t workers = 0;              // 0 = one per allowed CPU
+  // "none": no affinity; "cores": worker i pinned to one CPU (cpus[i % n]);
+  // "numa": workers spread round-robin over NUMA nodes, each pinned to its node's CPUs
+  std::string pinning = "none";
+  std::vector<int> cpus;           // CPUs for "cores" (empty = the process affinity mask)
+};
+
+// Per task kind: run time and queue wait (submit -> start)
+struct TaskTiming {
+  std::string kind;
+  uint64_t count = 0;
+  double avg_ms = 0;
+  double p99_ms = 0;               // log2-bucket upper bound
+  double max_ms = 0;
+  double avg_wait_ms = 0;
+};
+
+// Work-stealing scheduler for CPU-bound stages (feed/HTML parsing, article extraction).
+// Every worker owns a deque: it runs its own tasks oldest first and, when it runs dry,
+// steals the newest task from another worker's deque. External submits are spread
+// round-robin, so one slow task (a giant page) only holds up the deque it sits on until
+// an idle worker steals the rest. Tasks submitted from a worker stay on that worker.
+// Tasks must not throw.
+class TaskScheduler {
+public:
+  using Task = std::function<void()>;
+
+  explicit TaskScheduler(const TaskSchedConfig& cfg);
+  ~TaskScheduler();   // runs what is queued, then joins
+  TaskScheduler(const TaskScheduler&) = delete;
+  TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+  // `kind` must be a string literal (or otherwise outlive the scheduler); it keys timings()
+  void submit(const char* kind, Task task);
+  // Blocks until every submitted task has finished.
+  void wait_idle();
+
+  size_t workers() const;
+  size_t pending() const;          // queued + running
+  uint64_t steals() const;
+  std::vector<TaskTiming> timings() const;
+
+private:
+  struct Impl;
+  Impl* impl_;
+};
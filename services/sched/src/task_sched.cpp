@@ -0,0 +1,264 @@
+#include "task_sched.h"
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+int64_t now_us() {
+  using namespace std::chrono;
+  return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+struct Job {
+  const char* kind = "";
+  TaskScheduler::Task fn;
+  int64_t submitted_us = 0;
+};
+
+struct Worker {
+  std::mutex mu;
+  std::deque<Job> q;        // owner takes the front, thieves take the back
+  std::vector<int> cpus;    // affinity; empty = unpinned
+  std::thread th;
+};
+
+struct KindStats {
+  uint64_t count = 0;
+  uint64_t run_us = 0;
+  uint64_t wait_us = 0;
+  uint64_t max_us = 0;
+  uint64_t hist[32] = {};   // bucket i: run time < 2^i us
+};
+
+// which scheduler/worker the current thread belongs to (nested submits stay local)
+thread_local const void* tls_sched = nullptr;
+thread_local size_t tls_worker = 0;
+
+std::vector<int> allowed_cpus() {
+  std::vector<int> out;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int c = 0; c < CPU_SETSIZE; ++c) if (CPU_ISSET(c, &set)) out.push_back(c);
+  }
+  return out;
+}
+
+// "0-3,8-11" -> {0,1,2,3,8,9,10,11}
+std::vector<int> parse_cpulist(const std::string& s) {
+  std::vector<int> out;
+  std::stringstream ss(s);
+  std::string part;
+  while (std::getline(ss, part, ',')) {
+    if (part.empty()) continue;
+    const auto dash = part.find('-');
+    try {
+      const int lo = std::stoi(part.substr(0, dash));
+      const int hi = dash == std::string::npos ? lo : std::stoi(part.substr(dash + 1));
+      for (int c = lo; c <= hi; ++c) out.push_back(c);
+    } catch (...) {}
+  }
+  return out;
+}
+
+// CPUs per NUMA node from sysfs, restricted to what the process may run on
+std::vector<std::vector<int>> numa_nodes(const std::vector<int>& allowed) {
+  std::vector<std::vector<int>> nodes;
+  for (int n = 0; n < 1024; ++n) {
+    std::ifstream in("/sys/devices/system/node/node" + std::to_string(n) + "/cpulist");
+    if (!in) break;
+    std::string line;
+    std::getline(in, line);
+    std::vector<int> cpus;
+    for (int c : parse_cpulist(line)) {
+      if (std::find(allowed.begin(), allowed.end(), c) != allowed.end()) cpus.push_back(c);
+    }
+    if (!cpus.empty()) nodes.push_back(std::move(cpus));
+  }
+  return nodes;
+}
+
+void pin_self(const std::vector<int>& cpus) {
+  if (cpus.empty()) return;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int c : cpus) if (c >= 0 && c < CPU_SETSIZE) CPU_SET(c, &set);
+  if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+    std::cerr << "[sched] failed to pin worker to " << cpus.size() << " cpu(s)\n";
+  }
+}
+
+} // namespace
+
+struct TaskScheduler::Impl {
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::atomic<size_t> next{0};
+  std::atomic<size_t> queued{0};
+  std::atomic<size_t> pending{0};   // queued + running
+  std::atomic<uint64_t> steals{0};
+
+  std::mutex idle_mu;
+  std::condition_variable work_cv;  // workers sleep here when every deque is empty
+  std::condition_variable idle_cv;  // wait_idle()
+  bool stop = false;
+
+  mutable std::mutex stats_mu;
+  std::map<std::string, KindStats> stats;
+
+  bool pop_own(size_t i, Job& out) {
+    Worker& w = *workers[i];
+    std::lock_guard<std::mutex> lk(w.mu);
+    if (w.q.empty()) return false;
+    out = std::move(w.q.front());
+    w.q.pop_front();
+    queued--;
+    return true;
+  }
+
+  bool steal(size_t i, Job& out) {
+    const size_t n = workers.size();
+    for (size_t k = 1; k < n; ++k) {
+      Worker& v = *workers[(i + k) % n];
+      std::lock_guard<std::mutex> lk(v.mu);
+      if (v.q.empty()) continue;
+      out = std::move(v.q.back());
+      v.q.pop_back();
+      queued--;
+      steals++;
+      return true;
+    }
+    return false;
+  }
+
+  void run(Job& j) {
+    const int64_t start = now_us();
+    j.fn();
+    const uint64_t run = (uint64_t)std::max<int64_t>(0, now_us() - start);
+    const uint64_t wait = (uint64_t)std::max<int64_t>(0, start - j.submitted_us);
+    int b = 0;
+    while (b < 31 && (1ULL << b) <= run) ++b;
+    {
+      std::lock_guard<std::mutex> lk(stats_mu);
+      KindStats& ks = stats[j.kind];
+      ks.count++;
+      ks.run_us += run;
+      ks.wait_us += wait;
+      ks.max_us = std::max(ks.max_us, run);
+      ks.hist[b]++;
+    }
+    j.fn = nullptr;   // release captures before signalling idle
+    if (--pending == 0) {
+      std::lock_guard<std::mutex> lk(idle_mu);
+      idle_cv.notify_all();
+    }
+  }
+
+  void worker_main(size_t i) {
+    tls_sched = this;
+    tls_worker = i;
+    pin_self(workers[i]->cpus);
+    for (;;) {
+      Job j;
+      if (pop_own(i, j) || steal(i, j)) { run(j); continue; }
+      std::unique_lock<std::mutex> lk(idle_mu);
+      work_cv.wait(lk, [&]{ return stop || queued.load() > 0; });
+      if (stop && queued.load() == 0) return;
+    }
+  }
+};
+
+TaskScheduler::TaskScheduler(const TaskSchedConfig& cfg) : impl_(new Impl()) {
+  const std::vector<int> allowed = allowed_cpus();
+  size_t n = cfg.workers ? cfg.workers : std::max<size_t>(1, allowed.size());
+
+  std::vector<std::vector<int>> placement(n);
+  if (cfg.pinning == "cores") {
+    const std::vector<int>& cpus = cfg.cpus.empty() ? allowed : cfg.cpus;
+    for (size_t i = 0; i < n && !cpus.empty(); ++i) placement[i] = {cpus[i % cpus.size()]};
+  } else if (cfg.pinning == "numa") {
+    const auto nodes = numa_nodes(allowed);
+    for (size_t i = 0; i < n && !nodes.empty(); ++i) placement[i] = nodes[i % nodes.size()];
+    if (nodes.empty()) std::cerr << "[sched] no NUMA topology found; workers left unpinned\n";
+  } else if (cfg.pinning != "none" && !cfg.pinning.empty()) {
+    std::cerr << "[sched] unknown pinning '" << cfg.pinning << "'; workers left unpinned\n";
+  }
+
+  for (size_t i = 0; i < n; ++i) {
+    impl_->workers.push_back(std::make_unique<Worker>());
+    impl_->workers.back()->cpus = std::move(placement[i]);
+  }
+  for (size_t i = 0; i < n; ++i) {
+    impl_->workers[i]->th = std::thread([this, i] { impl_->worker_main(i); });
+  }
+}
+
+TaskScheduler::~TaskScheduler() {
+  if (!impl_) return;
+  {
+    std::lock_guard<std::mutex> lk(impl_->idle_mu);
+    impl_->stop = true;
+  }
+  impl_->work_cv.notify_all();
+  for (auto& w : impl_->workers) w->th.join();
+  delete impl_;
+}
+
+void TaskScheduler::submit(const char* kind, Task task) {
+  const size_t n = impl_->workers.size();
+  const size_t target = (tls_sched == impl_) ? tls_worker : impl_->next++ % n;
+  impl_->pending++;
+  {
+    Worker& w = *impl_->workers[target];
+    std::lock_guard<std::mutex> lk(w.mu);
+    w.q.push_back(Job{kind, std::move(task), now_us()});
+    impl_->queued++;
+  }
+  {
+    std::lock_guard<std::mutex> lk(impl_->idle_mu);   // pairs with the sleeper's predicate check
+  }
+  impl_->work_cv.notify_one();
+}
+
+void TaskScheduler::wait_idle() {
+  std::unique_lock<std::mutex> lk(impl_->idle_mu);
+  impl_->idle_cv.wait(lk, [&]{ return impl_->pending.load() == 0; });
+}
+
+size_t TaskScheduler::workers() const { return impl_->workers.size(); }
+size_t TaskScheduler::pending() const { return impl_->pending.load(); }
+uint64_t TaskScheduler::steals() const { return impl_->steals.load(); }
+
+std::vector<TaskTiming> TaskScheduler::timings() const {
+  std::vector<TaskTiming> out;
+  std::lock_guard<std::mutex> lk(impl_->stats_mu);
+  for (const auto& [kind, ks] : impl_->stats) {
+    TaskTiming t;
+    t.kind = kind;
+    t.count = ks.count;
+    if (ks.count > 0) {
+      t.avg_ms = ks.run_us / 1000.0 / ks.count;
+      t.avg_wait_ms = ks.wait_us / 1000.0 / ks.count;
+      t.max_ms = ks.max_us / 1000.0;
+      const uint64_t rank = ks.count - ks.count / 100;   // p99
+      uint64_t seen = 0;
+      for (int b = 0; b < 32; ++b) {
+        seen += ks.hist[b];
+        if (seen >= rank) { t.p99_ms = (double)(1ULL << b) / 1000.0; break; }
+      }
+    }
+    out.push_back(std::move(t));
+  }
+  return out;
+}
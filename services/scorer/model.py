@@ -1,4 +1,4 @@
-import os, time
+import os, sys, time
 from typing import List, Dict, Tuple
 import numpy as np
 
@@ -11,6 +11,15 @@ import torch
 
 LABELS_FINBERT = ["negative", "neutral", "positive"]
 
+# Compiled topic tagger shared with news_entity/entity (built as finnews_topics by CMake).
+# Falls back to the inline keyword rules in rule_topics() when the extension is not built.
+sys.path.append(os.environ.get("FINNEWS_NATIVE_DIR", "build"))
+try:
+    import finnews_topics
+    TOPIC_TAGGER = finnews_topics.TopicTagger(os.path.join("config", "topics.yml"))
+except Exception:
+    TOPIC_TAGGER = None
+
 def softmax(x: np.ndarray) -> np.ndarray:
     x = x - np.max(x, axis=-1, keepdims=True)
     e = np.exp(x)
@@ -70,6 +79,8 @@ class SentimentModel:
         return score, conf
 
 def rule_topics(texts: List[str]) -> List[List[str]]:
+    if TOPIC_TAGGER is not None:
+        return TOPIC_TAGGER.tag_many([t or "" for t in texts])
     out = []
     for t in texts:
         s = (t or "").lower()
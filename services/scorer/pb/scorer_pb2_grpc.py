@@ -5,7 +5,7 @@ import warnings
 
 import scorer_pb2 as scorer__pb2
 
-GRPC_GENERATED_VERSION = '1.74.0'
+GRPC_GENERATED_VERSION = '1.84.0'
 GRPC_VERSION = grpc.__version__
 _version_not_supported = False
 
@@ -18,14 +18,14 @@ except ImportError:
 if _version_not_supported:
     raise RuntimeError(
         f'The grpc package installed is at version {GRPC_VERSION},'
-        + f' but the generated code in scorer_pb2_grpc.py depends on'
+        + ' but the generated code in scorer_pb2_grpc.py depends on'
         + f' grpcio>={GRPC_GENERATED_VERSION}.'
         + f' Please upgrade your grpc module to grpcio>={GRPC_GENERATED_VERSION}'
         + f' or downgrade your generated code using grpcio-tools<={GRPC_VERSION}.'
     )
 
 
-class ScorerStub(object):
+class ScorerStub:
     """Missing associated documentation comment in .proto file."""
 
     def __init__(self, channel):
@@ -41,7 +41,7 @@ class ScorerStub(object):
                 _registered_method=True)
 
 
-class ScorerServicer(object):
+class ScorerServicer:
     """Missing associated documentation comment in .proto file."""
 
     def BatchScore(self, request, context):
@@ -66,7 +66,7 @@ def add_ScorerServicer_to_server(servicer, server):
 
 
  # This class is part of an EXPERIMENTAL API.
-class Scorer(object):
+class Scorer:
     """Missing associated documentation comment in .proto file."""
 
     @staticmethod
@@ -26,8 +26,12 @@ class ScorerServicer(scorer_pb2_grpc.ScorerServicer):
         self.enable_rule_topics = bool(cfg.get("topics", {}).get("enable_rules", True))
 
     def BatchScore(self, request, context):
-        # Merge title + first ~2000 body chars for sentiment
-        texts = [f"{t or ''}\n{(b or '')[:2000]}" for t,b in zip(request.title, request.body)]
+        # Prefer the client-side excerpt (already bounded); else title + first ~2000 body chars
+        excerpts = list(request.excerpt)   # AttributeError here means pb/ is stale: rerun gen_protos_py.sh
+        if excerpts and len(excerpts) == len(request.title):
+            texts = [f"{t or ''}\n{e or ''}" for t,e in zip(request.title, excerpts)]
+        else:
+            texts = [f"{t or ''}\n{(b or '')[:2000]}" for t,b in zip(request.title, request.body)]
         score, conf = self.sm.sentiment_batch(texts)
 
         if self.enable_rule_topics:
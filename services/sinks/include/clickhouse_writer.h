@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+#include "scored_row.h"
+
+struct ClickHouseWriterCfg {
+  std::string url = "http://localhost:8123";
+  std::string database = "default";
+  std::string table = "news_scored";
+  std::string user;
+  std::string password;
+  int timeout_secs = 30;
+  int max_retries = 5;
+  int retry_backoff_ms = 200;
+};
+
+// Accumulates rows as a RowBinary block for
+//   INSERT INTO <table> (ts, id, source, url, title, tickers, sentiment, topics)
+// and ships it in one HTTP POST. `date` is left to its DEFAULT.
+class ClickHouseWriter {
+public:
+  explicit ClickHouseWriter(const ClickHouseWriterCfg& cfg);
+  ~ClickHouseWriter();
+
+  void add(const ScoredRow& row);
+  size_t rows() const;
+  size_t bytes() const;
+
+  // POSTs the block with insert_deduplication_token=dedup_token, retrying with
+  // exponential backoff. Clears the block on success; keeps it on failure so the
+  // caller can retry with the same token (ClickHouse drops the repeat if the
+  // first attempt actually landed).
+  bool flush(const std::string& dedup_token);
+
+private:
+  struct Impl;
+  Impl* impl_;
+};
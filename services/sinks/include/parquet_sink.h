@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "scored_row.h"
+
+struct ParquetSinkCfg {
+  std::string root_dir = "archive/news";
+  std::string topic;                       // used in file names
+  size_t row_group_rows = 8192;
+  int64_t max_file_bytes = 128LL << 20;
+  int roll_secs = 300;
+  std::string compression = "zstd";
+};
+
+struct ParquetSinkStats {
+  uint64_t rows = 0;
+  uint64_t skipped = 0;      // offsets already on disk from a previous run
+  uint64_t row_groups = 0;
+  uint64_t files = 0;
+};
+
+// Writes rows into <root>/YYYY/MM/DD/HH/<topic>-p<partition>-<first>-<last>.parquet,
+// one open file per Kafka partition, under the (UTC) hour the file was written in;
+// readers filter on the scored_ts column for event time. Rows are buffered in Arrow builders and written
+// one row group at a time; a file is rolled when it crosses max_file_bytes, roll_secs
+// or an hour boundary. Rolling writes to a temp name, fsyncs, renames, fsyncs the
+// directory and only then calls on_durable(partition, last_offset + 1) so the caller
+// can commit. On startup the offset ranges in existing file names are loaded, and
+// rows at or below them are skipped; that covers a crash between rename and commit.
+class ParquetSink {
+public:
+  using DurableFn = std::function<void(int32_t partition, int64_t next_offset)>;
+
+  ParquetSink(const ParquetSinkCfg& cfg, DurableFn on_durable);
+  ~ParquetSink();
+
+  // Returns false if the row was skipped because its offset is already on disk.
+  bool append(int32_t partition, int64_t offset, const ScoredRow& row);
+  // Roll files that have been open longer than roll_secs.
+  void roll_due();
+  // Roll every open file (shutdown).
+  void close_all();
+
+  ParquetSinkStats stats() const;
+
+private:
+  struct Impl;
+  Impl* impl_;
+};
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One row of news.scored (same fields parquet_dump.py archived and news_scored stores)
+struct ScoredRow {
+  std::string id;
+  std::string source;
+  std::string url;
+  std::string title;
+  std::vector<std::string> tickers;
+  float sentiment = 0.0f;
+  std::vector<std::string> topics;
+  uint64_t scored_ts = 0;
+};
+
+// Decodes one Kafka payload. format: "scored_json" (news_score JSON rows),
+// "scored_pb" (finnews.ArticleScored) or "enriched_pb" (finnews.ArticleEnriched,
+// unscored; scored_ts = published_ts). Returns false on malformed input.
+bool parse_scored_row(const std::string& format, const void* payload, size_t len, ScoredRow& row);
@@ -0,0 +1,136 @@
+#include <curl/curl.h>
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+
+#include <string>
+#include <vector>
+
+#include "clickhouse_writer.h"
+
+// news_clickhouse_check: drives ClickHouseWriter against a live ClickHouse and reads the
+// rows back, so the RowBinary encoding and the retry token are checked end to end.
+//
+//   news_clickhouse_check [--url http://localhost:8123] [--database default] --table T
+// T must be an empty copy of news_scored with non-replicated dedup enabled
+// (scripts/clickhouse_dedup_smoke.sh sets one up and runs this against it).
+
+namespace {
+
+size_t write_cb(void* contents, size_t size, size_t nmemb, void* userp) {
+  static_cast<std::string*>(userp)->append((const char*)contents, size * nmemb);
+  return size * nmemb;
+}
+
+// Runs one read query over HTTP; returns false on a transport or HTTP error
+bool query(const std::string& url, const std::string& sql, std::string& out) {
+  CURL* curl = curl_easy_init();
+  if (!curl) return false;
+  out.clear();
+  curl_easy_setopt(curl, CURLOPT_URL, (url + "/").c_str());
+  curl_easy_setopt(curl, CURLOPT_POSTFIELDS, sql.c_str());
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_cb);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &out);
+  curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
+  const CURLcode rc = curl_easy_perform(curl);
+  long status = 0;
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+  curl_easy_cleanup(curl);
+  if (rc != CURLE_OK || status != 200) {
+    fmt::print("[news_clickhouse_check] query failed: {} {}\n",
+               rc != CURLE_OK ? curl_easy_strerror(rc) : "HTTP " + std::to_string(status), out.substr(0, 300));
+    return false;
+  }
+  return true;
+}
+
+// Covers what RowBinary can get wrong: multi-byte UTF-8, empty strings and arrays,
+// long varint lengths, negative and fractional floats.
+std::vector<ScoredRow> sample_rows() {
+  std::vector<ScoredRow> rows(4);
+  rows[0] = {"check-1", "reuters", "https://example.com/1", "Apple beats estimates",
+             {"AAPL"}, 0.5f, {"earnings"}, 1714564800000};
+  rows[1] = {"check-2", "yahoo", "https://example.com/2", "Zürich — Nestlé 📉 warns",
+             {"NESN.SW", "UBSG.SW"}, -0.25f, {}, 1714564801234};
+  rows[2] = {"check-3", "", "https://example.com/3", "", {}, 0.0f, {"macro", "rates", "fed"}, 1714564802999};
+  rows[3] = {"check-4", "wire", "https://example.com/4", std::string(300, 'x'),
+             {"MSFT"}, 0.875f, {"ai"}, 1714564803000};
+  return rows;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  ClickHouseWriterCfg cfg;
+  cfg.table.clear();
+  cfg.max_retries = 0;
+  for (int i = 1; i < argc; ++i) {
+    std::string a = argv[i];
+    if (a == "--url" && i + 1 < argc) cfg.url = argv[++i];
+    else if (a == "--database" && i + 1 < argc) cfg.database = argv[++i];
+    else if (a == "--table" && i + 1 < argc) cfg.table = argv[++i];
+  }
+  if (cfg.table.empty()) {
+    fmt::print("usage: news_clickhouse_check [--url URL] [--database DB] --table SCRATCH_TABLE\n");
+    return 2;
+  }
+  const std::string table = cfg.database + "." + cfg.table;
+  const auto rows = sample_rows();
+
+  int failures = 0;
+  auto check = [&](bool ok, const std::string& what) {
+    fmt::print("{} {}\n", ok ? "ok  " : "FAIL", what);
+    if (!ok) ++failures;
+  };
+  auto count = [&]() -> long {
+    std::string out;
+    if (!query(cfg.url, "SELECT count() FROM " + table, out)) return -1;
+    return std::stol(out);
+  };
+
+  ClickHouseWriter writer(cfg);
+  auto send = [&](const std::string& token) {
+    for (const auto& r : rows) writer.add(r);
+    return writer.flush(token) && writer.rows() == 0;
+  };
+
+  check(send("news.scored:p0=100-103"), "flush");
+  check(count() == (long)rows.size(), fmt::format("{} rows after the first flush", rows.size()));
+  // the block a retry resends after a flush whose reply was lost
+  check(send("news.scored:p0=100-103"), "flush again with the same token");
+  check(count() == (long)rows.size(), "same token is dropped as a duplicate");
+
+  std::string out;
+  check(query(cfg.url,
+              "SELECT toUnixTimestamp64Milli(ts) AS ts_ms, id, source, url, title, tickers, sentiment, topics "
+              "FROM " + table + " ORDER BY id FORMAT JSONEachRow "
+              "SETTINGS output_format_json_quote_64bit_integers = 0",
+              out),
+        "read back");
+  std::vector<nlohmann::json> got;
+  size_t pos = 0;
+  while (pos < out.size()) {
+    size_t nl = out.find('\n', pos);
+    if (nl == std::string::npos) nl = out.size();
+    if (nl > pos) got.push_back(nlohmann::json::parse(out.substr(pos, nl - pos), nullptr, false));
+    pos = nl + 1;
+  }
+  check(got.size() == rows.size(), fmt::format("read back {} rows", got.size()));
+  for (size_t i = 0; i < rows.size() && i < got.size(); ++i) {
+    const ScoredRow& want = rows[i];
+    const nlohmann::json& j = got[i];
+    const bool same = !j.is_discarded() &&
+                      j.value("ts_ms", int64_t(0)) == (int64_t)want.scored_ts &&
+                      j.value("id", "") == want.id && j.value("source", "") == want.source &&
+                      j.value("url", "") == want.url && j.value("title", "") == want.title &&
+                      j.value("tickers", std::vector<std::string>{}) == want.tickers &&
+                      (float)j.value("sentiment", 0.0) == want.sentiment &&
+                      j.value("topics", std::vector<std::string>{}) == want.topics;
+    check(same, "row " + want.id + " matches what was sent");
+    if (!same) fmt::print("     got: {}\n", j.dump());
+  }
+
+  check(send("news.scored:p0=104-107"), "flush the same rows under a new token");
+  check(count() == 2 * (long)rows.size(), "new token is inserted");
+
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,148 @@
+#include <fmt/core.h>
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "clickhouse_writer.h"
+#include "kafka_consumer.h"
+#include "config.h"
+
+// news_sink_clickhouse: replaces the Kafka-engine table + JSONExtract MV
+// (infra/clickhouse/002_news_kafka_mv.sql). Rows are decoded once here and inserted
+// as RowBinary blocks; several instances can share the consumer group.
+// Offsets are committed after ClickHouse acknowledges the block.
+
+static volatile std::sig_atomic_t g_stop = 0;
+static void handle_sigint(int) { g_stop = 1; }
+
+struct OffsetRange {
+  int64_t first = -1;
+  int64_t last = -1;
+};
+
+int main(int argc, char** argv) {
+  std::signal(SIGINT, handle_sigint);
+  std::signal(SIGTERM, handle_sigint);
+
+  std::string cfg_path = "config/sinks.yml";
+  if (argc >= 2) cfg_path = argv[1];
+
+  fmt::print("[news_sink_clickhouse] Loading config: '{}'\n", cfg_path);
+  SinksConfig cfg = load_sinks_config(cfg_path);
+  const SinksClickHouse& ch = cfg.clickhouse;
+
+  const std::string topic = ch.topic.empty() ? cfg.kafka.topic_scored : ch.topic;
+
+  KafkaConsumerCfg ccfg;
+  ccfg.bootstrap_servers = cfg.kafka.bootstrap_servers;
+  ccfg.group_id = ch.group_id;
+  ccfg.topic = topic;
+  ccfg.auto_offset_reset = "earliest";
+  ccfg.enable_auto_commit = false;   // commit after the INSERT succeeds
+  KafkaConsumer consumer(ccfg);
+
+  ClickHouseWriterCfg wcfg;
+  wcfg.url = ch.url;
+  wcfg.database = ch.database;
+  wcfg.table = ch.table;
+  wcfg.user = ch.user;
+  wcfg.password = ch.password;
+  wcfg.timeout_secs = ch.timeout_secs;
+  wcfg.max_retries = ch.max_retries;
+  wcfg.retry_backoff_ms = ch.retry_backoff_ms;
+  ClickHouseWriter writer(wcfg);
+
+  fmt::print("[news_sink_clickhouse] Consuming '{}' ({}) -> {} {}.{} (max_rows={} max_wait={}ms)\n",
+             topic, ch.input_format, ch.url, ch.database, ch.table, ch.max_rows, ch.max_wait_ms);
+
+  // Offsets in the current block, per partition. They also name the block: a retry
+  // after a timeout (or a replay after a crash before commit) reuses the token.
+  std::map<int32_t, OffsetRange> ranges;
+  auto block_token = [&]() {
+    std::string t = topic;
+    for (const auto& [p, r] : ranges) t += fmt::format(":p{}={}-{}", p, r.first, r.last);
+    return t;
+  };
+
+  std::string key;
+  const void* payload = nullptr; size_t len = 0;
+  KafkaMessageMeta meta;
+  uint64_t inserted = 0, blocks = 0, bad = 0, last_report = 0;
+  auto block_start = std::chrono::steady_clock::now();
+
+  auto add_row = [&](const KafkaMessageMeta& m, const ScoredRow& row) {
+    if (writer.rows() == 0) block_start = std::chrono::steady_clock::now();
+    writer.add(row);
+    auto& r = ranges[m.partition];
+    if (r.first < 0) r.first = m.offset;
+    r.last = m.offset;
+  };
+
+  // While ClickHouse is down the assigned partitions are paused and the loop keeps
+  // polling, so the group does not evict this member (max.poll.interval.ms) and hand
+  // the uncommitted block to another one under a different token. Anything polled
+  // anyway (partitions gained in a rebalance before the next pause) waits here.
+  bool paused = false;
+  std::vector<std::pair<KafkaMessageMeta, ScoredRow>> held;
+
+  auto flush_block = [&]() -> bool {
+    if (writer.rows() == 0) return true;
+    const size_t n = writer.rows();
+    if (!writer.flush(block_token())) return false;
+    for (const auto& [p, r] : ranges) consumer.commit(topic, p, r.last + 1);
+    ranges.clear();
+    inserted += n;
+    ++blocks;
+    return true;
+  };
+
+  while (!g_stop) {
+    const auto age_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - block_start).count();
+    if (writer.rows() >= (size_t)std::max(1, ch.max_rows) ||
+        (writer.rows() > 0 && age_ms >= ch.max_wait_ms)) {
+      if (!flush_block()) {
+        // keep the block (same token) and retry in a second; pausing again each time
+        // also covers partitions assigned since the last attempt
+        consumer.set_paused(true);
+        paused = true;
+        const auto retry_at = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (!g_stop && std::chrono::steady_clock::now() < retry_at) {
+          ScoredRow row;
+          if (!consumer.poll(key, payload, len, meta, 100) || !payload || len == 0) continue;
+          if (parse_scored_row(ch.input_format, payload, len, row)) held.emplace_back(meta, std::move(row));
+          else ++bad;
+        }
+        continue;
+      }
+      if (paused) {
+        consumer.set_paused(false);
+        paused = false;
+        for (const auto& [m, row] : held) add_row(m, row);
+        held.clear();
+      }
+    }
+
+    if (consumer.poll(key, payload, len, meta, 100) && payload && len > 0) {
+      ScoredRow row;
+      if (!parse_scored_row(ch.input_format, payload, len, row)) {
+        ++bad;
+        continue;
+      }
+      add_row(meta, row);
+    }
+
+    if (inserted - last_report >= 100000) {
+      last_report = inserted;
+      fmt::print("[news_sink_clickhouse] inserted={} blocks={} bad={}\n", inserted, blocks, bad);
+    }
+  }
+
+  flush_block();
+  fmt::print("[news_sink_clickhouse] Stopping.\n");
+  return 0;
+}
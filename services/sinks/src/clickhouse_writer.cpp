@@ -0,0 +1,138 @@
+#include "clickhouse_writer.h"
+
+#include <curl/curl.h>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+// RowBinary is little-endian; so is every host we build for
+template <typename T>
+void put_le(std::string& out, T v) {
+  char buf[sizeof(T)];
+  std::memcpy(buf, &v, sizeof(T));
+  out.append(buf, sizeof(T));
+}
+
+void put_varint(std::string& out, uint64_t v) {
+  while (v >= 0x80) {
+    out.push_back((char)(v | 0x80));
+    v >>= 7;
+  }
+  out.push_back((char)v);
+}
+
+void put_string(std::string& out, const std::string& s) {
+  put_varint(out, s.size());
+  out.append(s);
+}
+
+void put_string_array(std::string& out, const std::vector<std::string>& v) {
+  put_varint(out, v.size());
+  for (const auto& s : v) put_string(out, s);
+}
+
+size_t write_cb(void* contents, size_t size, size_t nmemb, void* userp) {
+  static_cast<std::string*>(userp)->append((const char*)contents, size * nmemb);
+  return size * nmemb;
+}
+
+long long now_ms() {
+  using namespace std::chrono;
+  return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+struct ClickHouseWriter::Impl {
+  ClickHouseWriterCfg cfg;
+  CURL* curl = nullptr;
+  std::string block;
+  size_t rows = 0;
+  std::string insert_query;   // url-escaped
+};
+
+ClickHouseWriter::ClickHouseWriter(const ClickHouseWriterCfg& cfg) : impl_(new Impl) {
+  impl_->cfg = cfg;
+  curl_global_init(CURL_GLOBAL_DEFAULT);
+  impl_->curl = curl_easy_init();   // reused so the connection stays alive between blocks
+  if (!impl_->curl) {
+    delete impl_;
+    throw std::runtime_error("curl_easy_init failed");
+  }
+  const std::string q = "INSERT INTO " + cfg.database + "." + cfg.table +
+                        " (ts, id, source, url, title, tickers, sentiment, topics) FORMAT RowBinary";
+  char* esc = curl_easy_escape(impl_->curl, q.c_str(), (int)q.size());
+  impl_->insert_query = esc ? esc : "";
+  curl_free(esc);
+}
+
+ClickHouseWriter::~ClickHouseWriter() {
+  if (impl_->curl) curl_easy_cleanup(impl_->curl);
+  delete impl_;
+}
+
+void ClickHouseWriter::add(const ScoredRow& r) {
+  std::string& b = impl_->block;
+  put_le<int64_t>(b, r.scored_ts ? (int64_t)r.scored_ts : now_ms());   // DateTime64(3)
+  put_string(b, r.id);
+  put_string(b, r.source);
+  put_string(b, r.url);
+  put_string(b, r.title);
+  put_string_array(b, r.tickers);
+  put_le<float>(b, r.sentiment);
+  put_string_array(b, r.topics);
+  ++impl_->rows;
+}
+
+size_t ClickHouseWriter::rows() const { return impl_->rows; }
+size_t ClickHouseWriter::bytes() const { return impl_->block.size(); }
+
+bool ClickHouseWriter::flush(const std::string& dedup_token) {
+  if (impl_->rows == 0) return true;
+  CURL* curl = impl_->curl;
+
+  char* tok = curl_easy_escape(curl, dedup_token.c_str(), (int)dedup_token.size());
+  const std::string url = impl_->cfg.url + "/?query=" + impl_->insert_query +
+                          "&insert_deduplication_token=" + (tok ? tok : "");
+  curl_free(tok);
+
+  int backoff = impl_->cfg.retry_backoff_ms;
+  for (int attempt = 0; attempt <= impl_->cfg.max_retries; ++attempt) {
+    if (attempt > 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(backoff));
+      backoff *= 2;
+    }
+    std::string resp;
+    curl_easy_reset(curl);
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_POST, 1L);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, impl_->block.data());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)impl_->block.size());
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, impl_->cfg.timeout_secs);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_cb);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &resp);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    if (!impl_->cfg.user.empty()) {
+      curl_easy_setopt(curl, CURLOPT_USERNAME, impl_->cfg.user.c_str());
+      curl_easy_setopt(curl, CURLOPT_PASSWORD, impl_->cfg.password.c_str());
+    }
+
+    CURLcode rc = curl_easy_perform(curl);
+    long status = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+    if (rc == CURLE_OK && status == 200) {
+      impl_->block.clear();
+      impl_->rows = 0;
+      return true;
+    }
+    std::cerr << "[clickhouse] insert attempt " << (attempt + 1) << " failed: "
+              << (rc != CURLE_OK ? curl_easy_strerror(rc) : ("HTTP " + std::to_string(status)))
+              << " " << resp.substr(0, 300) << "\n";
+  }
+  return false;
+}
@@ -0,0 +1,299 @@
+#include "parquet_sink.h"
+
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <parquet/arrow/writer.h>
+#include <parquet/exception.h>
+#include <parquet/properties.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::shared_ptr<arrow::Schema> scored_schema() {
+  // source is low-cardinality: keep it dictionary-encoded in the Arrow buffers too
+  static const auto schema = arrow::schema({
+    arrow::field("id", arrow::utf8()),
+    arrow::field("source", arrow::dictionary(arrow::int32(), arrow::utf8())),
+    arrow::field("url", arrow::utf8()),
+    arrow::field("title", arrow::utf8()),
+    arrow::field("tickers", arrow::list(arrow::utf8())),
+    arrow::field("sentiment", arrow::float32()),
+    arrow::field("topics", arrow::list(arrow::utf8())),
+    arrow::field("scored_ts", arrow::uint64()),
+  });
+  return schema;
+}
+
+parquet::Compression::type compression_of(const std::string& name) {
+  if (name == "zstd")   return parquet::Compression::ZSTD;
+  if (name == "snappy") return parquet::Compression::SNAPPY;
+  if (name == "lz4")    return parquet::Compression::LZ4;
+  if (name == "gzip")   return parquet::Compression::GZIP;
+  if (name == "none")   return parquet::Compression::UNCOMPRESSED;
+  throw std::runtime_error("unknown parquet compression: " + name);
+}
+
+// Files are bucketed by the hour they are written in, not by the row timestamp:
+// enriched_pb rows carry published_ts, which arrives out of order (and is 0 when
+// unknown), so bucketing by it would roll a file on nearly every row.
+int64_t current_hour() {
+  using namespace std::chrono;
+  return duration_cast<hours>(system_clock::now().time_since_epoch()).count();
+}
+
+fs::path hour_dir(const std::string& root, int64_t hour) {
+  std::time_t t = (std::time_t)(hour * 3600);
+  std::tm tm{};
+  gmtime_r(&t, &tm);
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "%04d/%02d/%02d/%02d", tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour);
+  return fs::path(root) / buf;
+}
+
+std::string file_prefix(const std::string& topic, int32_t partition) {
+  return topic + "-p" + std::to_string(partition) + "-";
+}
+
+// "<prefix><first>-<last>.parquet" -> last
+bool parse_last_offset(const std::string& name, const std::string& prefix, int64_t& last) {
+  static const std::string ext = ".parquet";
+  if (name.size() <= prefix.size() + ext.size() || name.compare(0, prefix.size(), prefix) != 0 ||
+      name.compare(name.size() - ext.size(), ext.size(), ext) != 0)
+    return false;
+  std::string range = name.substr(prefix.size(), name.size() - prefix.size() - ext.size());
+  size_t dash = range.find('-');
+  if (dash == std::string::npos) return false;
+  try {
+    last = std::stoll(range.substr(dash + 1));
+  } catch (...) {
+    return false;
+  }
+  return true;
+}
+
+void fsync_path(const fs::path& p, int flags) {
+  int fd = ::open(p.c_str(), flags);
+  if (fd < 0) throw std::runtime_error("open for fsync failed: " + p.string());
+  int rc = ::fsync(fd);
+  ::close(fd);
+  if (rc != 0) throw std::runtime_error("fsync failed: " + p.string());
+}
+
+struct RowBuilders {
+  arrow::StringBuilder id, url, title;
+  arrow::StringDictionary32Builder source;
+  std::shared_ptr<arrow::StringBuilder> ticker_values = std::make_shared<arrow::StringBuilder>();
+  std::shared_ptr<arrow::StringBuilder> topic_values = std::make_shared<arrow::StringBuilder>();
+  arrow::ListBuilder tickers{arrow::default_memory_pool(), ticker_values};
+  arrow::ListBuilder topics{arrow::default_memory_pool(), topic_values};
+  arrow::FloatBuilder sentiment;
+  arrow::UInt64Builder scored_ts;
+  size_t rows = 0;
+
+  void append(const ScoredRow& r) {
+    PARQUET_THROW_NOT_OK(id.Append(r.id));
+    PARQUET_THROW_NOT_OK(source.Append(r.source));
+    PARQUET_THROW_NOT_OK(url.Append(r.url));
+    PARQUET_THROW_NOT_OK(title.Append(r.title));
+    PARQUET_THROW_NOT_OK(tickers.Append());
+    for (const auto& t : r.tickers) PARQUET_THROW_NOT_OK(ticker_values->Append(t));
+    PARQUET_THROW_NOT_OK(sentiment.Append(r.sentiment));
+    PARQUET_THROW_NOT_OK(topics.Append());
+    for (const auto& t : r.topics) PARQUET_THROW_NOT_OK(topic_values->Append(t));
+    PARQUET_THROW_NOT_OK(scored_ts.Append(r.scored_ts));
+    ++rows;
+  }
+
+  // Finishes (and resets) every builder into one table
+  std::shared_ptr<arrow::Table> finish() {
+    std::vector<std::shared_ptr<arrow::Array>> cols(8);
+    PARQUET_THROW_NOT_OK(id.Finish(&cols[0]));
+    PARQUET_THROW_NOT_OK(source.Finish(&cols[1]));
+    PARQUET_THROW_NOT_OK(url.Finish(&cols[2]));
+    PARQUET_THROW_NOT_OK(title.Finish(&cols[3]));
+    PARQUET_THROW_NOT_OK(tickers.Finish(&cols[4]));
+    PARQUET_THROW_NOT_OK(sentiment.Finish(&cols[5]));
+    PARQUET_THROW_NOT_OK(topics.Finish(&cols[6]));
+    PARQUET_THROW_NOT_OK(scored_ts.Finish(&cols[7]));
+    rows = 0;
+    return arrow::Table::Make(scored_schema(), cols);
+  }
+};
+
+struct OpenFile {
+  int64_t hour = 0;
+  int64_t first_offset = -1;
+  int64_t last_offset = -1;
+  fs::path dir;
+  fs::path tmp_path;
+  std::chrono::steady_clock::time_point opened;
+  std::shared_ptr<arrow::io::FileOutputStream> out;
+  std::unique_ptr<parquet::arrow::FileWriter> writer;
+  RowBuilders builders;
+};
+
+} // namespace
+
+struct ParquetSink::Impl {
+  ParquetSinkCfg cfg;
+  DurableFn on_durable;
+  std::shared_ptr<parquet::WriterProperties> props;
+  std::shared_ptr<parquet::ArrowWriterProperties> arrow_props;
+  std::map<int32_t, std::unique_ptr<OpenFile>> open;
+  std::map<int32_t, int64_t> on_disk;   // partition -> last offset persisted in a final file
+  ParquetSinkStats stats;
+
+  void scan_existing() {
+    if (!fs::exists(cfg.root_dir)) return;
+    const std::string topic_prefix = cfg.topic + "-p";
+    for (const auto& e : fs::recursive_directory_iterator(cfg.root_dir)) {
+      if (!e.is_regular_file()) continue;
+      const std::string name = e.path().filename().string();
+      // leftovers of a crashed run: their offsets were never committed and will be replayed
+      if (name.size() > 4 && name.compare(name.size() - 4, 4, ".tmp") == 0 &&
+          name.compare(0, topic_prefix.size() + 1, "." + topic_prefix) == 0) {
+        std::error_code ec;
+        fs::remove(e.path(), ec);
+        continue;
+      }
+      if (name.compare(0, topic_prefix.size(), topic_prefix) != 0) continue;
+      int32_t partition = 0;
+      try {
+        partition = std::stoi(name.substr(topic_prefix.size()));
+      } catch (...) {
+        continue;
+      }
+      int64_t last = -1;
+      if (!parse_last_offset(name, file_prefix(cfg.topic, partition), last)) continue;
+      auto it = on_disk.find(partition);
+      if (it == on_disk.end() || last > it->second) on_disk[partition] = last;
+    }
+  }
+
+  std::unique_ptr<OpenFile> open_file(int32_t partition, int64_t hour, int64_t first_offset) {
+    auto f = std::make_unique<OpenFile>();
+    f->hour = hour;
+    f->first_offset = first_offset;
+    f->dir = hour_dir(cfg.root_dir, hour);
+    fs::create_directories(f->dir);
+    f->tmp_path = f->dir / ("." + file_prefix(cfg.topic, partition) + std::to_string(first_offset) + ".tmp");
+    f->opened = std::chrono::steady_clock::now();
+    PARQUET_ASSIGN_OR_THROW(f->out, arrow::io::FileOutputStream::Open(f->tmp_path.string()));
+    PARQUET_ASSIGN_OR_THROW(f->writer, parquet::arrow::FileWriter::Open(
+        *scored_schema(), arrow::default_memory_pool(), f->out, props, arrow_props));
+    return f;
+  }
+
+  void write_row_group(OpenFile& f) {
+    if (f.builders.rows == 0) return;
+    const int64_t n = (int64_t)f.builders.rows;
+    auto table = f.builders.finish();
+    PARQUET_THROW_NOT_OK(f.writer->WriteTable(*table, n));
+    ++stats.row_groups;
+  }
+
+  // Flush, close, fsync, rename, fsync dir, then report the partition as durable
+  void roll(int32_t partition) {
+    auto it = open.find(partition);
+    if (it == open.end()) return;
+    std::unique_ptr<OpenFile> f = std::move(it->second);
+    open.erase(it);
+
+    write_row_group(*f);
+    PARQUET_THROW_NOT_OK(f->writer->Close());
+    if (::fsync(f->out->file_descriptor()) != 0)
+      throw std::runtime_error("fsync failed: " + f->tmp_path.string());
+    PARQUET_THROW_NOT_OK(f->out->Close());
+
+    const fs::path final_path = f->dir / (file_prefix(cfg.topic, partition) + std::to_string(f->first_offset) +
+                                          "-" + std::to_string(f->last_offset) + ".parquet");
+    fs::rename(f->tmp_path, final_path);
+    fsync_path(f->dir, O_RDONLY | O_DIRECTORY);
+
+    on_disk[partition] = f->last_offset;
+    ++stats.files;
+    std::cerr << "[parquet] wrote " << final_path.string() << "\n";
+    if (on_durable) on_durable(partition, f->last_offset + 1);
+  }
+};
+
+ParquetSink::ParquetSink(const ParquetSinkCfg& cfg, DurableFn on_durable) : impl_(new Impl) {
+  impl_->cfg = cfg;
+  impl_->on_durable = std::move(on_durable);
+
+  parquet::WriterProperties::Builder pb;
+  pb.compression(compression_of(cfg.compression));
+  pb.enable_dictionary();   // tickers/topics get dictionary pages in the file
+  pb.max_row_group_length((int64_t)cfg.row_group_rows);
+  impl_->props = pb.build();
+  // store the Arrow schema so readers get `source` back as a dictionary column
+  impl_->arrow_props = parquet::ArrowWriterProperties::Builder().store_schema()->build();
+
+  impl_->scan_existing();
+}
+
+ParquetSink::~ParquetSink() {
+  try {
+    close_all();
+  } catch (const std::exception& e) {
+    std::cerr << "[parquet] close failed: " << e.what() << "\n";
+  }
+  delete impl_;
+}
+
+bool ParquetSink::append(int32_t partition, int64_t offset, const ScoredRow& row) {
+  auto done = impl_->on_disk.find(partition);
+  if (done != impl_->on_disk.end() && offset <= done->second) {
+    ++impl_->stats.skipped;
+    return false;
+  }
+
+  const int64_t hour = current_hour();
+  auto it = impl_->open.find(partition);
+  if (it != impl_->open.end() && it->second->hour != hour) {
+    impl_->roll(partition);
+    it = impl_->open.end();
+  }
+  if (it == impl_->open.end()) {
+    it = impl_->open.emplace(partition, impl_->open_file(partition, hour, offset)).first;
+  }
+
+  OpenFile& f = *it->second;
+  f.builders.append(row);
+  f.last_offset = offset;
+  ++impl_->stats.rows;
+
+  if (f.builders.rows >= impl_->cfg.row_group_rows) {
+    impl_->write_row_group(f);
+    auto pos = f.out->Tell();
+    if (pos.ok() && *pos >= impl_->cfg.max_file_bytes) impl_->roll(partition);
+  }
+  return true;
+}
+
+void ParquetSink::roll_due() {
+  const auto now = std::chrono::steady_clock::now();
+  std::vector<int32_t> due;
+  for (const auto& [partition, f] : impl_->open) {
+    if (now - f->opened >= std::chrono::seconds(impl_->cfg.roll_secs)) due.push_back(partition);
+  }
+  for (int32_t p : due) impl_->roll(p);
+}
+
+void ParquetSink::close_all() {
+  while (!impl_->open.empty()) impl_->roll(impl_->open.begin()->first);
+}
+
+ParquetSinkStats ParquetSink::stats() const { return impl_->stats; }
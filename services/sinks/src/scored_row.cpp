@@ -0,0 +1,59 @@
+#include "scored_row.h"
+
+#include <nlohmann/json.hpp>
+
+#include "news.pb.h"
+
+static bool parse_scored_json(const void* payload, size_t len, ScoredRow& row) {
+  auto j = nlohmann::json::parse((const char*)payload, (const char*)payload + len, nullptr, false);
+  if (j.is_discarded() || !j.is_object()) return false;
+  // value() throws when a field has the wrong type, e.g. "sentiment": null (how
+  // nlohmann writes NaN); that is malformed input, not a reason to crash-loop
+  try {
+    row.id = j.value("id", "");
+    row.source = j.value("source", "");
+    row.url = j.value("url", "");
+    row.title = j.value("title", "");
+    row.tickers = j.value("tickers", std::vector<std::string>{});
+    row.sentiment = j.value("sentiment", 0.0f);
+    row.topics = j.value("topics", std::vector<std::string>{});
+    row.scored_ts = j.value("scored_ts", (uint64_t)0);
+  } catch (const nlohmann::json::exception&) {
+    return false;
+  }
+  return true;
+}
+
+static bool parse_scored_pb(const void* payload, size_t len, ScoredRow& row) {
+  finnews::ArticleScored s;
+  if (!s.ParseFromArray(payload, (int)len)) return false;
+  row.id = s.id();
+  row.source = s.source();
+  row.url = s.url();
+  row.title = s.title();
+  row.tickers.assign(s.tickers().begin(), s.tickers().end());
+  row.sentiment = s.sentiment();
+  row.topics.assign(s.topics().begin(), s.topics().end());
+  row.scored_ts = (uint64_t)s.scored_ts();
+  return true;
+}
+
+static bool parse_enriched_pb(const void* payload, size_t len, ScoredRow& row) {
+  finnews::ArticleEnriched e;
+  if (!e.ParseFromArray(payload, (int)len)) return false;
+  row.id = e.id();
+  row.source = e.source();
+  row.url = e.url();
+  row.title = e.title();
+  row.tickers.assign(e.tickers().begin(), e.tickers().end());
+  row.sentiment = 0.0f;   // not scored yet
+  row.topics.assign(e.topics().begin(), e.topics().end());
+  row.scored_ts = (uint64_t)e.published_ts();
+  return true;
+}
+
+bool parse_scored_row(const std::string& format, const void* payload, size_t len, ScoredRow& row) {
+  if (format == "scored_pb") return parse_scored_pb(payload, len, row);
+  if (format == "enriched_pb") return parse_enriched_pb(payload, len, row);
+  return parse_scored_json(payload, len, row);
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Multi-pattern matcher compiled to a dense DFA over byte classes.
+// ASCII case folding is part of the class map, so text is scanned in place
+// (no lowercase copy) and every byte costs one table lookup.
+class AhoCorasick {
+ public:
+  // Adds a pattern (matched case-insensitively for ASCII); returns its id.
+  int add(std::string_view pattern);
+  // Compiles the automaton; call once after all add()s.
+  void build();
+
+  size_t pattern_count() const { return lens_.size(); }
+  size_t pattern_len(int id) const { return lens_[(size_t)id]; }
+  size_t state_count() const { return states_; }
+
+  // Calls on_match(pattern_id, begin, end) for every occurrence, end exclusive.
+  template <class F>
+  void scan(std::string_view text, F&& on_match) const {
+    int32_t s = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+      s = delta_[(size_t)s * classes_ + cls_[(unsigned char)text[i]]];
+      for (int32_t o = s; o > 0; o = dict_[(size_t)o]) {
+        for (uint32_t k = out_begin_[(size_t)o]; k < out_begin_[(size_t)o + 1]; ++k) {
+          int id = out_ids_[k];
+          on_match(id, i + 1 - lens_[(size_t)id], i + 1);
+        }
+      }
+    }
+  }
+
+ private:
+  std::vector<std::string> patterns_;   // folded; cleared after build()
+  std::vector<size_t> lens_;
+  std::array<uint8_t, 256> cls_{};      // byte -> class (0 = byte not in any pattern)
+  size_t classes_ = 1;
+  size_t states_ = 1;
+  std::vector<int32_t> delta_;          // states_ x classes_ transitions
+  std::vector<int32_t> dict_;           // nearest proper suffix state with outputs (0 = none)
+  std::vector<uint32_t> out_begin_;     // CSR offsets into out_ids_, per state
+  std::vector<int32_t> out_ids_;
+};
+
+// True if [begin,end) in text is not glued to other alphanumerics on either side
+inline bool is_word_match(std::string_view text, size_t begin, size_t end) {
+  auto word = [](unsigned char c) { return (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z'); };
+  if (begin > 0 && word((unsigned char)text[begin - 1])) return false;
+  if (end < text.size() && word((unsigned char)text[end])) return false;
+  return true;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include "aho_corasick.h"
+
+struct TopicRule {
+  std::string name;                    // e.g. "earnings"
+  std::vector<std::string> keywords;   // matched case-insensitively
+  bool whole_word = false;             // false: substring semantics (legacy Python rules)
+};
+
+// Loads config/topics.yml
+std::vector<TopicRule> load_topic_rules(const std::string& path);
+
+// Every keyword of every rule compiled into one automaton; tagging is a single
+// pass per text with no lowercase copy, independent of the number of rules.
+// Immutable after construction (safe to share across threads).
+class TopicTagger {
+ public:
+  explicit TopicTagger(const std::vector<TopicRule>& rules);
+
+  // Sorted, unique topic names hit in any of the given texts
+  std::vector<std::string> tag(std::string_view text) const;
+  std::vector<std::string> tag(std::string_view title, std::string_view body) const;
+
+  size_t rule_count() const { return names_.size(); }
+
+ private:
+  void mark(std::string_view text, std::vector<uint8_t>& hit) const;
+
+  std::vector<std::string> names_;
+  std::vector<int> rule_of_;           // pattern id -> rule index
+  std::vector<uint8_t> whole_word_;    // per rule
+  AhoCorasick ac_;
+};
@@ -0,0 +1,83 @@
+#include "aho_corasick.h"
+#include <cctype>
+#include <deque>
+#include <stdexcept>
+
+int AhoCorasick::add(std::string_view pattern) {
+  if (!delta_.empty()) throw std::logic_error("AhoCorasick::add after build");
+  std::string p(pattern);
+  for (auto& c : p) c = (char)std::tolower((unsigned char)c);
+  lens_.push_back(p.size());
+  patterns_.push_back(std::move(p));
+  return (int)lens_.size() - 1;
+}
+
+void AhoCorasick::build() {
+  // 1) byte classes: one per distinct folded byte used by any pattern
+  cls_.fill(0);
+  classes_ = 1;
+  for (const auto& p : patterns_) {
+    for (unsigned char c : p) {
+      if (cls_[c] == 0) {
+        if (classes_ >= 255) throw std::runtime_error("AhoCorasick: too many byte classes");
+        cls_[c] = (uint8_t)classes_++;
+        if (std::isalpha(c)) cls_[(unsigned char)std::toupper(c)] = cls_[c];
+      }
+    }
+  }
+
+  // 2) trie
+  std::vector<int32_t> go(classes_, -1);
+  std::vector<std::vector<int32_t>> own_out(1);
+  states_ = 1;
+  for (size_t id = 0; id < patterns_.size(); ++id) {
+    if (patterns_[id].empty()) continue;
+    int32_t s = 0;
+    for (unsigned char c : patterns_[id]) {
+      size_t slot = (size_t)s * classes_ + cls_[c];
+      if (go[slot] < 0) {
+        go[slot] = (int32_t)states_++;
+        go.resize(states_ * classes_, -1);
+        own_out.emplace_back();
+      }
+      s = go[slot];
+    }
+    own_out[(size_t)s].push_back((int32_t)id);
+  }
+
+  // 3) failure links (BFS) folded into a full transition table
+  std::vector<int32_t> fail(states_, 0);
+  dict_.assign(states_, 0);
+  std::deque<int32_t> q;
+  for (size_t c = 0; c < classes_; ++c) {
+    int32_t& t = go[c];
+    if (t < 0) t = 0;
+    else q.push_back(t);
+  }
+  while (!q.empty()) {
+    int32_t s = q.front(); q.pop_front();
+    const int32_t f = fail[(size_t)s];
+    dict_[(size_t)s] = own_out[(size_t)f].empty() ? dict_[(size_t)f] : f;
+    for (size_t c = 0; c < classes_; ++c) {
+      int32_t& t = go[(size_t)s * classes_ + c];
+      const int32_t via_fail = go[(size_t)f * classes_ + c];
+      if (t < 0) { t = via_fail; continue; }
+      fail[(size_t)t] = via_fail;
+      q.push_back(t);
+    }
+  }
+  delta_ = std::move(go);
+
+  // 4) outputs in CSR form
+  out_begin_.assign(states_ + 1, 0);
+  out_ids_.clear();
+  for (size_t s = 0; s < states_; ++s) {
+    out_begin_[s] = (uint32_t)out_ids_.size();
+    out_ids_.insert(out_ids_.end(), own_out[s].begin(), own_out[s].end());
+  }
+  out_begin_[states_] = (uint32_t)out_ids_.size();
+
+  // only states with their own outputs are reported by scan(); root never has any
+  patterns_.clear();
+  patterns_.shrink_to_fit();
+}
@@ -0,0 +1,31 @@
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include "topic_tagger.h"
+
+namespace py = pybind11;
+
+// finnews_topics: Python binding so services/entity and services/scorer tag topics
+// with the same compiled matcher (and rules file) as news_entity.
+PYBIND11_MODULE(finnews_topics, m) {
+  m.doc() = "Compiled multi-pattern topic tagger (config/topics.yml)";
+
+  py::class_<TopicTagger>(m, "TopicTagger")
+      .def(py::init([](const std::string& path) { return TopicTagger(load_topic_rules(path)); }),
+           py::arg("rules_path"))
+      .def("tag",
+           [](const TopicTagger& t, const std::string& title, const std::string& body) {
+             py::gil_scoped_release nogil;
+             return t.tag(title, body);
+           },
+           py::arg("title"), py::arg("body") = std::string())
+      .def("tag_many",
+           [](const TopicTagger& t, const std::vector<std::string>& texts) {
+             py::gil_scoped_release nogil;
+             std::vector<std::vector<std::string>> out;
+             out.reserve(texts.size());
+             for (const auto& s : texts) out.push_back(t.tag(s));
+             return out;
+           },
+           py::arg("texts"))
+      .def_property_readonly("rule_count", &TopicTagger::rule_count);
+}
@@ -0,0 +1,54 @@
+#include "topic_tagger.h"
+#include <yaml-cpp/yaml.h>
+#include <algorithm>
+#include <stdexcept>
+
+std::vector<TopicRule> load_topic_rules(const std::string& path) {
+  YAML::Node root = YAML::LoadFile(path);
+  std::vector<TopicRule> rules;
+  for (const auto& t : root["topics"]) {
+    TopicRule r;
+    r.name = t["name"].as<std::string>();
+    r.keywords = t["keywords"].as<std::vector<std::string>>();
+    if (t["whole_word"]) r.whole_word = t["whole_word"].as<bool>();
+    if (r.name.empty()) throw std::runtime_error("topic rule without a name in " + path);
+    rules.push_back(std::move(r));
+  }
+  return rules;
+}
+
+TopicTagger::TopicTagger(const std::vector<TopicRule>& rules) {
+  for (size_t i = 0; i < rules.size(); ++i) {
+    names_.push_back(rules[i].name);
+    whole_word_.push_back(rules[i].whole_word ? 1 : 0);
+    for (const auto& kw : rules[i].keywords) {
+      if (kw.empty()) continue;
+      ac_.add(kw);
+      rule_of_.push_back((int)i);
+    }
+  }
+  ac_.build();
+}
+
+void TopicTagger::mark(std::string_view text, std::vector<uint8_t>& hit) const {
+  ac_.scan(text, [&](int id, size_t b, size_t e) {
+    const int rule = rule_of_[(size_t)id];
+    if (whole_word_[(size_t)rule] && !is_word_match(text, b, e)) return;
+    hit[(size_t)rule] = 1;
+  });
+}
+
+std::vector<std::string> TopicTagger::tag(std::string_view text) const {
+  return tag(text, std::string_view());
+}
+
+std::vector<std::string> TopicTagger::tag(std::string_view title, std::string_view body) const {
+  std::vector<uint8_t> hit(names_.size(), 0);
+  mark(title, hit);
+  mark(body, hit);
+  std::vector<std::string> out;
+  for (size_t i = 0; i < names_.size(); ++i) if (hit[i]) out.push_back(names_[i]);
+  std::sort(out.begin(), out.end());
+  out.erase(std::unique(out.begin(), out.end()), out.end());
+  return out;
+}